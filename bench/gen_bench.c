@@ -0,0 +1,215 @@
+/*
+ * Générateur de programmes .algo synthétiques pour mesurer le temps de
+ * compilation d'arc (voir run_bench.sh et la cible bench du makefile).
+ *
+ * Utilisation: gen_bench type n dir
+ * Écrit le programme dir/type_n.algo (et les fichiers qu'il inclut), avec
+ * type parmi:
+ * fonctions: n fonctions, chacune appelant la précédente
+ * imbrication: n structures de contrôle imbriquées (SI, TQ, POUR)
+ * expressions: une expression de n opérations
+ * tableaux: un tableau initialisé avec n valeurs
+ * inclusions: n fichiers inclus via $ INCLURE
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <linux/limits.h>
+
+
+static FILE *open_file(const char *dir, const char *type, int n,
+                       const char *suffix)
+{
+    char path[PATH_MAX];
+    snprintf(path, PATH_MAX, "%s/%s_%d%s.algo", dir, type, n, suffix);
+
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL)
+    {
+        perror(path);
+        exit(1);
+    }
+
+    return fp;
+}
+
+
+
+/**
+ * @brief Écrit la fonction f<i>, qui appelle f<i - 1> (sauf pour i = 0).
+ *
+ * @param fp
+ * @param i
+ */
+static void gen_function(FILE *fp, int i)
+{
+    fprintf(fp, "ALGO f%d(a, b)\n", i);
+    fprintf(fp, "VAR i, s <- 0\n");
+    fprintf(fp, "DEBUT\n");
+    fprintf(fp, "    POUR i DANS 0...a FAIRE\n");
+    fprintf(fp, "        s <- s + i * b - %d\n", i);
+    fprintf(fp, "    FPOUR\n");
+    if (i > 0) fprintf(fp, "    s <- s + f%d(b, s %% 7)\n", i - 1);
+    fprintf(fp, "    RETOURNER s\n");
+    fprintf(fp, "FIN\n\n");
+}
+
+
+
+static void gen_functions(FILE *fp, int n)
+{
+    int i;
+    for (i = 0; i < n; i++) gen_function(fp, i);
+
+    fprintf(fp, "PROGRAMME()\n");
+    fprintf(fp, "DEBUT\n");
+    fprintf(fp, "    ECRIRE(f%d(3, 2))\n", n - 1);
+    fprintf(fp, "FIN\n");
+}
+
+
+
+static void indent(FILE *fp, int depth)
+{
+    fprintf(fp, "%*s", 4 * (depth + 1), "");
+}
+
+
+static void gen_nesting(FILE *fp, int n)
+{
+    static const char *end[3] = {"FSI", "FTQ", "FPOUR"};
+    int i;
+
+    fprintf(fp, "PROGRAMME()\n");
+    fprintf(fp, "VAR x <- 0");
+    for (i = 0; i < n; i++)
+    {
+        /* Compteurs des boucles TQ et POUR */
+        if (i % 3 != 0) fprintf(fp, ", i%d <- 0", i);
+    }
+    fprintf(fp, "\nDEBUT\n");
+
+    for (i = 0; i < n; i++)
+    {
+        indent(fp, i);
+        switch (i % 3)
+        {
+        case 0:
+            fprintf(fp, "SI x < %d ALORS\n", i + 1);
+            break;
+        case 1:
+            fprintf(fp, "TQ i%d < 2 FAIRE\n", i);
+            indent(fp, i + 1);
+            fprintf(fp, "i%d <- i%d + 1\n", i, i);
+            break;
+        default:
+            fprintf(fp, "POUR i%d DANS 0...2 FAIRE\n", i);
+            break;
+        }
+        indent(fp, i + 1);
+        fprintf(fp, "x <- x + %d\n", i);
+    }
+
+    for (i = n - 1; i >= 0; i--)
+    {
+        indent(fp, i);
+        fprintf(fp, "%s\n", end[i % 3]);
+    }
+
+    fprintf(fp, "    ECRIRE(x)\n");
+    fprintf(fp, "FIN\n");
+}
+
+
+
+static void gen_expression(FILE *fp, int n)
+{
+    static const char ops[4] = {'+', '-', '*', '%'};
+    int i;
+
+    fprintf(fp, "PROGRAMME()\n");
+    fprintf(fp, "VAR a <- 1, b <- 2, c <- 3, x\n");
+    fprintf(fp, "DEBUT\n");
+    fprintf(fp, "    x <- a");
+    for (i = 0; i < n; i++)
+    {
+        /* Les variables et constantes alternent (pas de division par 0) */
+        if (i % 2 == 0) fprintf(fp, " %c %c", ops[i % 4], "bc"[i % 4 / 2]);
+        else fprintf(fp, " %c %d", ops[i % 4], i % 9 + 1);
+    }
+    fprintf(fp, "\n    ECRIRE(x)\n");
+    fprintf(fp, "FIN\n");
+}
+
+
+
+static void gen_array(FILE *fp, int n)
+{
+    int i;
+
+    fprintf(fp, "PROGRAMME()\n");
+    fprintf(fp, "VAR s <- 0, i, t[%d] <- [", n);
+    for (i = 0; i < n; i++) fprintf(fp, "%s%d", i == 0 ? "" : ", ", i % 100);
+    fprintf(fp, "]\n");
+    fprintf(fp, "DEBUT\n");
+    fprintf(fp, "    POUR i DANS 0...%d FAIRE\n", n);
+    fprintf(fp, "        s <- s + t[i]\n");
+    fprintf(fp, "    FPOUR\n");
+    fprintf(fp, "    ECRIRE(s)\n");
+    fprintf(fp, "FIN\n");
+}
+
+
+
+static void gen_includes(FILE *fp, const char *dir, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        char suffix[32];
+        sprintf(suffix, "_%d", i);
+
+        FILE *inc = open_file(dir, "inclusions", n, suffix);
+        gen_function(inc, i);
+        fclose(inc);
+
+        fprintf(fp, "$ INCLURE inclusions_%d_%d.algo\n", n, i);
+    }
+
+    fprintf(fp, "\nPROGRAMME()\n");
+    fprintf(fp, "DEBUT\n");
+    fprintf(fp, "    ECRIRE(f%d(3, 2))\n", n - 1);
+    fprintf(fp, "FIN\n");
+}
+
+
+
+int main(int argc, char **argv)
+{
+    if (argc != 4 || atoi(argv[2]) <= 0)
+    {
+        fprintf(stderr, "Utilisation: %s fonctions|imbrication|expressions|"\
+                "tableaux|inclusions n dir\n", argv[0]);
+        return 1;
+    }
+
+    const char *type = argv[1];
+    int n = atoi(argv[2]);
+    FILE *fp = open_file(argv[3], type, n, "");
+
+    if (strcmp(type, "fonctions") == 0) gen_functions(fp, n);
+    else if (strcmp(type, "imbrication") == 0) gen_nesting(fp, n);
+    else if (strcmp(type, "expressions") == 0) gen_expression(fp, n);
+    else if (strcmp(type, "tableaux") == 0) gen_array(fp, n);
+    else if (strcmp(type, "inclusions") == 0) gen_includes(fp, argv[3], n);
+    else
+    {
+        fprintf(stderr, "type de programme inconnu: %s\n", type);
+        return 1;
+    }
+
+    fclose(fp);
+    return 0;
+}
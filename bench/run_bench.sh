@@ -0,0 +1,113 @@
+#!/bin/bash
+#
+# Mesure le temps de compilation d'arc sur des programmes synthétiques (voir
+# gen_bench.c) et écrit les résultats au format CSV.
+#
+# Utilisation: run_bench.sh arc gen_bench resultats.csv [reference.csv]
+#
+# Pour chaque programme, arc est lancé BENCH_RUNS fois (3 par défaut) et le
+# meilleur temps est gardé. Les tailles des programmes sont données par
+# BENCH_SIZES (par défaut "100 500 1000"). Un programme qui ne compile pas (par
+# exemple si la pile de l'analyseur syntaxique est pleine) est signalé dans le
+# CSV par "erreur", et le script échoue.
+#
+# Si un fichier de référence (résultats d'une exécution précédente) est donné,
+# les programmes dont le temps total, le temps de l'analyse sémantique ou de
+# la génération de code a augmenté de plus de BENCH_TOLERANCE % (20 par
+# défaut, et d'au moins 1 ms) sont affichés et le script échoue.
+
+ARC=$1
+GEN=$2
+OUT=$3
+REF=$4
+
+RUNS=${BENCH_RUNS:-3}
+SIZES=${BENCH_SIZES:-"100 500 1000"}
+TOLERANCE=${BENCH_TOLERANCE:-20}
+KINDS="fonctions imbrication expressions tableaux inclusions"
+
+if [ -z "$ARC" ] || [ -z "$GEN" ] || [ -z "$OUT" ]; then
+    echo "Utilisation: $0 arc gen_bench resultats.csv [reference.csv]" >&2
+    exit 1
+fi
+
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+
+# Temps d'une phase (en ms) dans la sortie de --stats=json
+phase_time() {
+    sed -n "s/.*\"name\": \"$1\", \"time_ms\": \([0-9.]*\).*/\1/p" "$2"
+}
+
+json_field() {
+    sed -n "s/^    \"$1\": \([0-9]*\).*/\1/p" "$2"
+}
+
+echo "type,taille,lignes,instructions,total_ms,preprocessor_ms,yyparse_ms,"\
+"optimize_ms,semantic_ms,second_turn_semantic_ms,codegen_ms,allocations,"\
+"rss_ko" > "$OUT"
+
+for kind in $KINDS; do
+    for n in $SIZES; do
+        "$GEN" "$kind" "$n" "$DIR" || exit 1
+        src="$DIR/${kind}_$n.algo"
+        lines=$(cat "$DIR/${kind}_$n"*.algo | wc -l)
+
+        best=""
+        for ((r = 0; r < RUNS; r++)); do
+            start=$(date +%s%N)
+            "$ARC" -I "$DIR" --stats=json -o "$DIR/out.ram" "$src" \
+                2> "$DIR/stats.json" > /dev/null || break
+            end=$(date +%s%N)
+
+            time=$(( (end - start) / 1000 ))
+            if [ -z "$best" ] || [ "$time" -lt "$best" ]; then
+                best=$time
+                cp "$DIR/stats.json" "$DIR/best.json"
+            fi
+        done
+
+        if [ -z "$best" ]; then
+            echo "$kind $n: erreur de compilation" >&2
+            grep -o "erreur fatale.*" "$DIR/stats.json" >&2
+            echo "$kind,$n,$lines,erreur" >> "$OUT"
+            failed=1
+            continue
+        fi
+
+        row="$kind,$n,$lines,$(json_field instructions "$DIR/best.json")"
+        row="$row,$(awk "BEGIN {printf \"%.3f\", $best / 1000}")"
+        for phase in preprocessor yyparse optimize semantic \
+                     second_turn_semantic codegen; do
+            row="$row,$(phase_time $phase "$DIR/best.json")"
+        done
+        row="$row,$(json_field allocs "$DIR/best.json")"
+        row="$row,$(json_field peak_rss_kb "$DIR/best.json")"
+
+        echo "$row" >> "$OUT"
+        echo "$row"
+    done
+done
+
+[ -n "$failed" ] && exit 1
+[ -z "$REF" ] && exit 0
+
+# Comparaison avec la référence (colonnes total, semantic et codegen)
+awk -F, -v tol="$TOLERANCE" '
+    FNR == 1 { next }
+    NR == FNR { ref[$1 "," $2] = $0; next }
+    ($1 "," $2) in ref {
+        split(ref[$1 "," $2], old, ",")
+        split("5 9 10 11", cols, " ")
+        split("total semantic second_turn_semantic codegen", names, " ")
+        for (i = 1; i <= 4; i++) {
+            c = cols[i]
+            if ($c > old[c] * (1 + tol / 100) && $c - old[c] >= 1) {
+                printf "régression %s %s (%s): %s ms -> %s ms\n",
+                       $1, $2, names[i], old[c], $c
+                bad = 1
+            }
+        }
+    }
+    END { exit bad }
+' "$REF" "$OUT"
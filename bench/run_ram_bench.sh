@@ -0,0 +1,128 @@
+#!/bin/bash
+#
+# Mesure la qualité du code généré par arc: chaque programme de bench/ram est
+# compilé puis exécuté par le simulateur (voir sim/ramsim.c) sur une bande
+# d'entrée générée, et les résultats sont écrits au format CSV.
+#
+# Utilisation: run_ram_bench.sh arc ramsim resultats.csv [reference.csv]
+#
+# Pour chaque programme, le CSV contient le nombre d'instructions RAM
+# exécutées, le nombre de cases mémoire utilisées, la taille du code et une
+# somme de contrôle de la bande de sortie. Les options de compilation sont
+# données par BENCH_ARC_FLAGS (aucune par défaut).
+#
+# Si un fichier de référence est donné (bench/ram/reference.csv pour make
+# bench-run), les programmes dont le nombre d'instructions exécutées, la
+# mémoire ou la taille du code a augmenté sont affichés et le script échoue,
+# de même si la bande de sortie a changé. Les améliorations sont signalées,
+# pour mettre à jour la référence (make bench-baseline).
+
+ARC=$1
+SIM=$2
+OUT=$3
+REF=$4
+
+DIR_RAM=$(dirname "$0")/ram
+
+# Programme, type de bande d'entrée et taille:
+# aleatoire: n puis n entiers pseudo-aléatoires
+# matrices: n puis deux matrices n * n
+# entier: n seul
+PROGRAMS="
+tri_rapide aleatoire 2000
+tri_tas aleatoire 2000
+tri_insertion aleatoire 300
+puissance_pgcd entier 40
+recursion entier 16
+boucles_courtes entier 100
+crible entier 20000
+matrices matrices 16
+"
+
+if [ -z "$ARC" ] || [ -z "$SIM" ] || [ -z "$OUT" ]; then
+    echo "Utilisation: $0 arc ramsim resultats.csv [reference.csv]" >&2
+    exit 1
+fi
+
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+
+# Bande d'entrée (générateur congruentiel, pour être reproductible)
+gen_tape() {
+    awk -v type="$1" -v n="$2" 'BEGIN {
+        x = 42
+        print n
+        nb = type == "aleatoire" ? n : type == "matrices" ? 2 * n * n : 0
+        for (i = 0; i < nb; i++) {
+            x = (x * 16807) % 2147483647
+            print (type == "matrices" ? x % 100 : x % 10000)
+        }
+    }'
+}
+
+echo "programme,taille,instructions_executees,memoire,taille_code,sortie" \
+    > "$OUT"
+
+while read -r prog type n; do
+    [ -z "$prog" ] && continue
+
+    gen_tape "$type" "$n" > "$DIR/bande.txt"
+    if ! "$ARC" $BENCH_ARC_FLAGS -o "$DIR/$prog.ram" "$DIR_RAM/$prog.algo" \
+            > /dev/null 2> "$DIR/arc.txt"; then
+        echo "$prog: erreur de compilation" >&2
+        cat "$DIR/arc.txt" >&2
+        echo "$prog,$n,erreur" >> "$OUT"
+        failed=1
+        continue
+    fi
+
+    if ! "$SIM" -s "$DIR/$prog.ram" "$DIR/bande.txt" > "$DIR/sortie.txt" \
+            2> "$DIR/stats.txt"; then
+        echo "$prog: erreur à l'exécution" >&2
+        cat "$DIR/stats.txt" >&2
+        echo "$prog,$n,erreur" >> "$OUT"
+        failed=1
+        continue
+    fi
+
+    steps=$(sed -n 's/^Instructions exécutées: \([0-9]*\)/\1/p' \
+            "$DIR/stats.txt")
+    memory=$(sed -n 's/^Mémoire utilisée: \([0-9]*\).*/\1/p' "$DIR/stats.txt")
+    code=$(grep -c ';' "$DIR/$prog.ram")
+    output=$(cksum < "$DIR/sortie.txt" | cut -d' ' -f1)
+
+    row="$prog,$n,$steps,$memory,$code,$output"
+    echo "$row" >> "$OUT"
+    echo "$row"
+done <<< "$PROGRAMS"
+
+[ -n "$failed" ] && exit 1
+[ -z "$REF" ] && exit 0
+
+# Comparaison avec la référence (même programme et même taille)
+awk -F, '
+    FNR == 1 { next }
+    NR == FNR { ref[$1 "," $2] = $0; next }
+    !(($1 "," $2) in ref) { next }
+    {
+        split(ref[$1 "," $2], old, ",")
+        if ($6 != old[6]) {
+            printf "%s: la bande de sortie a changé\n", $1
+            bad = 1
+        }
+        split("3 4 5", cols, " ")
+        split("instructions exécutées,mémoire,taille du code", names, ",")
+        for (i = 1; i <= 3; i++) {
+            c = cols[i]
+            if ($c > old[c]) {
+                printf "régression %s (%s): %s -> %s\n", $1, names[i],
+                       old[c], $c
+                bad = 1
+            } else if ($c < old[c]) {
+                printf "amélioration %s (%s): %s -> %s\n", $1, names[i],
+                       old[c], $c
+            }
+        }
+    }
+    END { exit bad }
+' "$REF" "$OUT"
@@ -0,0 +1,41 @@
+#ifndef _ARC_CACHE_HEADER
+#define _ARC_CACHE_HEADER
+
+
+#include "ast.h"
+#include "codegen.h"
+
+
+/*
+ * Cache du code généré pour chaque fonction (option --cache).
+ * Le code d'une fonction est identifié par une empreinte de son sous-arbre
+ * (après les optimisations) et des symboles qu'elle utilise. Il est enregistré
+ * dans le répertoire du cache avec ses relocations, pour pouvoir être réutilisé
+ * à une autre adresse lors d'une compilation suivante:
+ * RELOC_NONE: l'adresse est une constante ou une adresse mémoire
+ * RELOC_CODE: adresse d'une instruction de la fonction (relative à son début)
+ * RELOC_FUNC: adresse d'une autre fonction (appel), retrouvée par son nom
+ * RELOC_OS: adresse d'une routine de ramOS (JUMP inchangé, voir ram_os.h)
+ */
+
+
+/* Répertoire du cache par défaut */
+#define CACHE_DEFAULT_DIR ".arc_cache"
+
+
+typedef enum {RELOC_NONE, RELOC_CODE, RELOC_FUNC, RELOC_OS} reloc_type;
+
+
+extern char *cache_dir;
+
+
+int cache_load(ast *t, const char *ctx, int start);
+void cache_tag(reloc_type type, const char *func);
+void cache_record(instr_ram instr, char t_adr, int adr);
+void cache_save();
+void reset_cache();
+
+int cache_nb_hits();
+int cache_nb_misses();
+
+#endif
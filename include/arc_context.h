@@ -0,0 +1,42 @@
+#ifndef _ARC_CONTEXT_HEADER
+#define _ARC_CONTEXT_HEADER
+
+
+#include "arc_diag.h"
+
+
+/*
+ * État de la compilation d'un fichier.
+ * Tout ce qui dépend du fichier compilé est dans ce contexte (ou dans les
+ * variables propres à chaque module, remises à zéro par reset_context), ce
+ * qui permet de compiler plusieurs fichiers dans le même processus.
+ *
+ * src: le fichier source (.algo)
+ * exename: le fichier produit
+ * tree: l'ASA
+ * table: la table des symboles
+ * line_offset: nombre de lignes insérées par le préprocesseur
+ * uses_free: le programme contient un LIBERER (voir l'allocateur de ramOS)
+ * uses_alloc: le programme contient un ALLOUER (mis à jour par l'analyse
+ * sémantique, voir init_mem_layout)
+ * diags: les diagnostics de la compilation (voir arc_diag.h)
+ */
+typedef struct {
+    char *src;
+    char *exename;
+    struct ast *tree;
+    struct _context *table;
+    int line_offset;
+    int uses_free;
+    int uses_alloc;
+    diag_engine diags;
+} arc_context;
+
+
+extern arc_context arc_ctx;
+
+
+void init_context(const char *src, const char *exename);
+void reset_context();
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef _ARC_DIAG_HEADER
+#define _ARC_DIAG_HEADER
+
+
+#include "parser.h"
+#include <stdarg.h>
+#include <stddef.h>
+
+
+/*
+ * Diagnostics (erreurs et warnings) d'une compilation.
+ * Les diagnostics sont conservés dans le contexte de la compilation puis
+ * affichés triés par position dans le fichier source (voir diag_flush).
+ * Le fichier source n'est lu qu'une fois, à l'affichage du premier
+ * diagnostic ayant une position: l'index des débuts de lignes permet ensuite
+ * d'obtenir n'importe quelle ligne en temps constant.
+ */
+
+
+typedef enum {DIAG_WARNING, DIAG_ERROR} diag_kind;
+
+
+/*
+ * kind: erreur ou warning
+ * has_loc: 1 si loc est la position du diagnostic dans le fichier source
+ * msg: le message (séquences d'échappement ANSI déjà appliquées)
+ * order: numéro d'ajout (pour garder l'ordre des diagnostics à la même
+ * position)
+ */
+typedef struct {
+    diag_kind kind;
+    int has_loc;
+    YYLTYPE loc;
+    char *msg;
+    int order;
+} diagnostic;
+
+
+/*
+ * src: le fichier source (NULL avant init_context)
+ * buffer, size: le contenu du fichier source (NULL s'il n'a pas été lu)
+ * lines: indices dans buffer des débuts de lignes (nb_lines + 1 valeurs)
+ * list, nb, capacity: les diagnostics pas encore affichés
+ * has_info, loc: la position donnée par set_error_info
+ */
+typedef struct {
+    const char *src;
+    char *buffer;
+    size_t size;
+    size_t *lines;
+    int nb_lines;
+
+    diagnostic *list;
+    int nb;
+    int capacity;
+    int nb_added;
+
+    int has_info;
+    YYLTYPE loc;
+} diag_engine;
+
+
+void diag_init(diag_engine *d, const char *src);
+void diag_add(diag_engine *d, diag_kind kind, const char *fmt, va_list args);
+void diag_flush(diag_engine *d);
+void diag_free(diag_engine *d);
+
+YYLTYPE diag_src_loc(YYLTYPE pp_loc);
+
+#endif
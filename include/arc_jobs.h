@@ -0,0 +1,15 @@
+#ifndef _ARC_JOBS_HEADER
+#define _ARC_JOBS_HEADER
+
+
+/*
+ * Compilation de plusieurs fichiers en parallèle (option -j).
+ * L'état du compilateur étant global au processus (analyseurs générés par
+ * flex et bison, table des symboles, etc.), chaque fichier est compilé par un
+ * processus fils.
+ */
+
+
+int run_jobs(int nb_files, int nb_jobs, void (*job)(int));
+
+#endif
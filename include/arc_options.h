@@ -3,5 +3,6 @@
 
 
 void handle_options(int argc, char **argv);
+char *get_output_name(const char *src);
 
 #endif
\ No newline at end of file
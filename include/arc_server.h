@@ -0,0 +1,17 @@
+#ifndef _ARC_SERVER_HEADER
+#define _ARC_SERVER_HEADER
+
+
+/*
+ * Mode serveur (arc --server socket) et client (arc --client socket ...).
+ * Le serveur reste lancé et garde en mémoire la librairie standard. Le client
+ * lui envoie sa ligne de commande et son répertoire courant, le serveur
+ * compile dans un processus fils (comme arc lancé avec ces arguments) et
+ * renvoie au client les sorties et le code de retour de la compilation.
+ */
+
+
+int run_server(const char *socket_path, int (*request)(int, char **));
+int run_client(const char *socket_path, int argc, char **argv);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef _ARC_STATS_HEADER
+#define _ARC_STATS_HEADER
+
+
+#include "ast.h"
+#include "symbol_table.h"
+
+
+/* Statistiques sur la compilation (option --stats) */
+
+
+/* Format d'affichage des statistiques */
+#define STATS_NONE 0
+#define STATS_TEXT 1
+#define STATS_JSON 2
+
+
+/* Phases du compilateur dont on mesure la durée et les allocations */
+typedef enum {
+    PHASE_PREPROCESSOR, PHASE_PARSER, PHASE_OPTIMIZE, PHASE_SEMANTIC,
+    PHASE_SECOND_SEMANTIC, PHASE_CODEGEN, NB_PHASES
+} compiler_phase;
+
+
+extern int stats_format;
+
+
+void phase_start(compiler_phase p);
+void phase_end(compiler_phase p);
+
+void print_stats(ast *tree, symb_table table, int nb_instr);
+
+#endif
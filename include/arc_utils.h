@@ -39,14 +39,7 @@
 #define NE_OP 261
 
 
-/* Structure contenant les informations de l'erreur (un peu comme un errno) */
-struct error_info {
-    int has_info;
-    YYLTYPE loc;
-};
-
-
-extern char *src;
+extern unsigned long nb_alloc;
 
 
 
@@ -64,4 +57,7 @@ void unset_error_info();
 void check_alloc(void *ptr);
 void op_to_str(char *dest, int op);
 
+double get_time_ms();
+void report_pass_time(const char *name, double start);
+
 #endif
\ No newline at end of file
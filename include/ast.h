@@ -16,10 +16,6 @@
 /* 32 caractères max pour un identifiant */
 #define ID_MAX_SIZE 32
 
-
-extern char *src;
-extern int line_offset;
-
 /* Besoin pour les noeuds */
 typedef struct ast ast;
 
@@ -29,9 +25,13 @@ typedef enum {
     decla_type, var_decla_type, prog_type, func_decla_type, while_type,
     if_type, io_type, func_call_type, exp_list_type, do_while_type,
     return_type, for_type, array_access_type, array_decla_type,
-    alloc_type, proto_type
+    alloc_type, proto_type, inc_type, free_type, switch_type, case_type,
+    block_type
 } node_type;
 
+/* Nombre de types de noeuds (block_type est le dernier) */
+#define NB_NODE_TYPES (block_type + 1)
+
 
 typedef enum {integer, pointer, array, func} type_symb;
 
@@ -118,6 +118,11 @@ typedef struct {
  * params: la liste des paramètres
  * list_decl: la liste des déclarations
  * list_instr: la liste des instructions
+ * heap_mark: l'adresse relative dans la pile de la sauvegarde de HEAP_REG si
+ * la fonction utilise ALLOUER_LOCAL, 0 sinon (calculée par l'analyse
+ * sémantique).
+ * temps: le nombre maximal de valeurs temporaires empilées par la fonction
+ * (calculé par l'analyse sémantique, pour --guard).
  */
 typedef struct {
     ast *id;
@@ -126,6 +131,8 @@ typedef struct {
     ast *list_instr;
     size_t nb_params;
     size_t nb_decla;
+    int heap_mark;
+    int temps;
 } func_decla_node;
 
 
@@ -160,12 +167,16 @@ typedef struct {
 
 
 /*
- * mode: 'r' pour LIRE et 'w' pour ECRIRE
- * expr: l'expression à écrire
+ * mode: 'r' pour LIRE, 'w' pour ECRIRE, 'R' pour LIRE_TABLEAU et 'W' pour
+ * ECRIRE_TABLEAU
+ * expr: l'expression à écrire (le nombre de cases pour LIRE_TABLEAU et
+ * ECRIRE_TABLEAU)
+ * id: le tableau (ou pointeur) lu ou écrit par LIRE_TABLEAU et ECRIRE_TABLEAU
  */
 typedef struct {
     ast *expr;
     char mode;
+    ast *id;
 } io_node;
 
 
@@ -199,28 +210,52 @@ typedef struct {
 } for_node;
 
 
+/*
+ * Bornes de l'indice d'un accès prouvées par les optimisations (voir
+ * optim_bounds): la vérification correspondante n'est pas générée avec
+ * --bounds-check.
+ */
+#define BOUNDS_LOW 1        /* indice >= 0 */
+#define BOUNDS_HIGH 2       /* indice < taille du tableau */
+#define BOUNDS_OK (BOUNDS_LOW | BOUNDS_HIGH)
+
+
 /*
  * ind_expr est l'exression contenue entre les crochets. 
  * affect_expr est l'éventuelle initialisation du tableau.
+ * col_expr est le 2ème indice de T[i][j] (NULL si un seul indice). Il est
+ * supprimé par flatten_arr_access, qui remplace l'indice par i * m + j.
+ * in_bounds contient les bornes prouvées (BOUNDS_LOW, BOUNDS_HIGH).
  */
 typedef struct {
     ast *id;
     ast *ind_expr;
     ast *affect_expr;
+    ast *col_expr;
+    int in_bounds;
 } array_access_node;
 
 
 
+/*
+ * nb_cols: le nombre de colonnes de T[n][m] (0 pour un tableau à une
+ * dimension). size vaut alors n * m: les lignes sont rangées à la suite.
+ */
 typedef struct {
     ast *id;
     int size;
     ast *list_expr;
+    int nb_cols;
 } array_decla_node;
 
 
+/*
+ * is_local: 1 pour ALLOUER_LOCAL (le bloc est libéré au retour de la fonction)
+ */
 typedef struct {
     ast *id;
     ast *expr;
+    int is_local;
 } alloc_node;
 
 
@@ -231,6 +266,60 @@ typedef struct {
 } proto_node;
 
 
+/*
+ * Incrémente de 1 la variable id (instruction INC).
+ * N'existe pas dans le langage: ce noeud est uniquement créé par les
+ * optimisations (voir optim.c).
+ */
+typedef struct {
+    ast *id;
+} inc_node;
+
+
+/* Libère le bloc pointé par id (LIBERER) */
+typedef struct {
+    ast *id;
+} free_node;
+
+
+/*
+ * SELON expr
+ * cases: la liste des CAS (noeuds case_type), dans l'ordre du programme
+ * default_instr: les instructions exécutées si aucun CAS ne correspond
+ * (=SINON). Peut-être NULL.
+ */
+typedef struct {
+    ast *expr;
+    ast *cases;
+    ast *default_instr;
+} switch_node;
+
+
+/*
+ * CAS val: list_instr
+ * next: le CAS suivant du SELON (NULL pour le dernier)
+ */
+typedef struct {
+    int val;
+    ast *list_instr;
+    ast *next;
+} case_node;
+
+
+/*
+ * COPIER(dst, src, size) (op = 'c') ou REMPLIR(dst, src, size) (op = 'f').
+ * dst: le tableau ou pointeur de destination
+ * src: le tableau ou pointeur source pour COPIER, la valeur écrite pour REMPLIR
+ * size: le nombre de cases
+ */
+typedef struct {
+    char op;
+    ast *dst;
+    ast *src;
+    ast *size;
+} block_node;
+
+
 
 
 typedef struct ast {
@@ -261,20 +350,34 @@ typedef struct ast {
         array_decla_node arr_decla;
         alloc_node alloc;
         proto_node proto;
+        inc_node inc;
+        free_node free_n;
+        switch_node switch_n;
+        case_node case_n;
+        block_node block;
     };
 } ast;
 
 
 void free_ast(ast *t);
+void count_nodes(ast *t, int *count);
 ast *init_ast(node_type type);
+ast *copy_ast(ast *t);
 
 ast *create_nb_leaf(int value);
 ast *create_return_node(ast *expr);
 ast *create_id_leaf(const char *id);
+ast *create_inc_node(const char *id);
+ast *create_free_node(const char *id);
 ast *create_u_op_node(int op, ast *c);
 ast *create_io_node(ast *expr, char m);
+ast *create_io_tab_node(char *id, ast *size, char m);
 ast *create_instr_node(ast *instr, ast *l);
 ast *create_alloc_node(char *id, ast *expr);
+ast *create_switch_node(ast *expr, ast *cases, ast *l_instr);
+ast *create_case_node(int val, ast *l_instr, ast *l);
+ast *create_block_node(char op, char *dst, ast *src, ast *size);
+ast *create_local_alloc_node(char *id, ast *expr);
 ast *create_proto_node(char *id, ast *params);
 ast *create_b_op_node(int op, ast *m1, ast *m2);
 ast *create_exp_list_node(ast *expr, ast *next);
@@ -284,9 +387,13 @@ ast *create_do_while_node(ast *l_instr, ast *expr);
 ast *create_prog_root(ast *list_decl, ast *m_prog);
 ast *create_affect_node(char *id, ast *expr, int deref);
 ast *create_arr_decla_node(char *id, int size, ast *l_exp);
+ast *create_md_arr_decla_node(char *id, int rows, int cols, ast *l_exp);
 ast *create_function_call_node(const char *id, ast *params);
 ast *create_if_node(ast *expr, ast *l_instr1, ast *l_instr2);
 ast *create_arr_access_node(char *id, ast *ind_expr, ast *aff_expr);
+ast *create_md_arr_access_node(char *id, ast *row_expr, ast *col_expr,
+                               ast *aff_expr);
+void flatten_arr_access(ast *t, int nb_cols);
 ast *create_function_node(char *id, ast *params, ast *l_decl, ast *l_i);
 ast *create_var_decla_node(ast *var, ast *expr, ast *next, type_symb type);
 ast *create_for_node(char *id, ast *start_exp, ast *end_exp, ast *l_instr);
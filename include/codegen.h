@@ -34,7 +34,31 @@ typedef enum {
 extern FILE *fp_out;
 
 
+/*
+ * Un SELON utilise une table de sauts s'il a au moins SWITCH_TABLE_MIN_CASES
+ * CAS et si l'écart entre le plus petit et le plus grand est au plus
+ * SWITCH_TABLE_DENSITY fois leur nombre (voir codegen_switch).
+ */
+#define SWITCH_TABLE_MIN_CASES 4
+#define SWITCH_TABLE_DENSITY 2
+
+
+/*
+ * COPIER et REMPLIR sont déroulés si leur taille est une constante d'au plus
+ * BLOCK_UNROLL_MAX cases (voir codegen_block).
+ */
+#define BLOCK_UNROLL_MAX 8
+
+
+void init_mem_layout();
+void print_mem_layout();
 void init_ram_os();
+int ram_os_size();
+void reset_codegen();
+int codegen_nb_instr();
+int is_repeated_constant(ast *prev, ast *exp);
+int switch_dispatch_len(ast *t);
+int bounds_to_check(ast *t);
 
 void codegen(ast *t);
 void codegen_nb(ast *t);
@@ -48,12 +72,17 @@ void codegen_eq(ast *t);
 void codegen_ne(ast *t);
 void codegen_io(ast *t);
 void codegen_if(ast *t);
+void codegen_switch(ast *t);
+void codegen_inc(ast *t);
 void codegen_and(ast *t);
 void codegen_not(ast *t);
 void codegen_for(ast *t);
 void codegen_b_op(ast *t);
 void codegen_u_op(ast *t);
 void codegen_alloc(ast *t);
+void codegen_free(ast *t);
+void codegen_block(ast *t);
+void codegen_io_tab(ast *t);
 void codegen_instr(ast *t);
 void codegen_while(ast *t);
 void codegen_affect(ast *t);
@@ -0,0 +1,60 @@
+#ifndef _OPTIM_HEADER
+#define _OPTIM_HEADER
+
+
+#include "ast.h"
+
+
+/*
+ * Optimisations réalisées sur l'arbre syntaxique abstrait, après l'analyse
+ * syntaxique et avant l'analyse sémantique.
+ * Comme la taille du code (codelen) est calculée pendant l'analyse sémantique,
+ * les transformations de l'arbre n'ont pas besoin de la mettre à jour.
+ */
+
+
+/* Passes activables via les options (voir arc_options.c) */
+#define OPTIM_LICM 1
+#define OPTIM_SR   2
+#define OPTIM_UNROLL 4
+#define OPTIM_CSE  8
+#define OPTIM_DCE  16
+#define OPTIM_BOUNDS 32
+
+
+/*
+ * Nombre maximal d'instructions générées par le déroulage d'une boucle
+ * (copies du corps de la boucle).
+ */
+#define OPTIM_UNROLL_BUDGET 256
+
+
+/* Nombre maximal de passes dans un pipeline donné par --passes */
+#define OPTIM_PIPELINE_MAX 32
+
+
+/*
+ * Préfixe des variables temporaires créées par les optimisations.
+ * Le caractère `$` ne peut pas faire partie d'un identificateur (voir
+ * lexer.lex), il n'y a donc pas de conflit possible avec les variables du
+ * programme.
+ */
+#define OPTIM_TMP_PREFIX "$t"
+
+
+extern int optim_flags;
+extern int optim_unroll;
+
+
+void optimize(ast *t);
+int optim_set_level(const char *level);
+int optim_set_passes(const char *list);
+
+void optim_bounds(ast *t);
+void optim_licm(ast *t);
+void optim_strength_reduction(ast *t);
+void optim_unroll_loops(ast *t);
+void optim_cse(ast *t);
+void optim_dce(ast *t);
+
+#endif
@@ -5,5 +5,7 @@
 
 FILE *cpy_file(FILE *src, const char *dest_name);
 FILE *preprocessor(char *src, int *nb_inserted);
+void preload_includes();
+void free_include_cache();
 
 #endif
\ No newline at end of file
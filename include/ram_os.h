@@ -44,7 +44,10 @@
  * │        pile       │
  * │                   │
  * │                   │
- * └───────────────────┘ <── Début pile
+ * ├───────────────────┤ <── Début pile
+ * │ listes des blocs  │
+ * │      libres       │     (seulement si le programme utilise LIBERER)
+ * └───────────────────┘
  */
 
 
@@ -67,6 +70,15 @@
 #define REG_RETURN_VALUE 5
 #define REG_RETURN_ADR 6
 
+/*
+ * Registres de COPIER et REMPLIR (voir codegen_block): adresse de destination,
+ * adresse source (valeur à écrire pour REMPLIR) et nombre de cases restantes.
+ * Ils sont initialisés après l'évaluation de toutes les expressions.
+ */
+#define BLOCK_REG_DST 7
+#define BLOCK_REG_SRC 8
+#define BLOCK_REG_CNT 9
+
 /*
  * Gestion de la pile.
  * Entiers sur 16 bits: les adresses traitées sont donc au + USHRT_MAX
@@ -85,4 +97,76 @@
 #define STATIC_START 20
 
 
+/*
+ * --mem-size=auto: la mémoire est la plus petite contenant la mémoire
+ * statique, le tas (de taille --heap-size si le programme utilise ALLOUER) et
+ * la pile, dont la taille maximale est estimée d'après le graphe des appels
+ * (voir max_stack_size, --recursion-depth pour un programme récursif).
+ * Une case reste libre entre le tas et la pile.
+ */
+#define MEM_SIZE_AUTO -1
+
+
+/* Nombre d'instructions de l'initialisation de ramOS (voir init_ram_os) */
+#define RAM_OS_INIT_SIZE 7
+
+
+/*
+ * Allocateur de ramOS, ajouté après l'initialisation si le programme contient
+ * un LIBERER (sinon ALLOUER ne fait qu'augmenter HEAP_REG).
+ *
+ * Chaque bloc alloué est précédé d'une case contenant sa taille. Un bloc
+ * libéré est ajouté en tête de la liste de sa classe de taille: la liste i
+ * (0 < i < NB_SIZE_CLASSES) contient les blocs de taille i et la liste 0 ceux
+ * de taille >= NB_SIZE_CLASSES. La 1ère case d'un bloc libre contient
+ * l'adresse du bloc suivant de sa liste (0 pour le dernier).
+ * Les têtes des listes occupent les NB_SIZE_CLASSES dernières cases de la
+ * mémoire, la pile commence juste en dessous.
+ *
+ * ALLOUER réutilise le 1er bloc de la liste de sa taille (le 1er bloc de la
+ * même taille pour la liste 0, l'en-tête reste ainsi la taille du tableau pour
+ * --bounds-check), sinon il augmente HEAP_REG.
+ *
+ * Les routines sont appelées avec l'adresse de retour dans ALLOC_REG_RET:
+ * ALLOC_ADR: alloue ALLOC_REG_SIZE cases, l'adresse du bloc est dans l'ACC et
+ *            dans ALLOC_REG_BLOCK au retour
+ * FREE_ADR:  libère le bloc ALLOC_REG_BLOCK (rien si c'est 0)
+ */
+#define NB_SIZE_CLASSES 16
+
+#define ALLOC_REG_SIZE 13
+#define ALLOC_REG_BLOCK 14
+#define ALLOC_REG_RET 15
+#define ALLOC_REG_PREV 16
+#define ALLOC_REG_TMP 17
+
+/* Taille du code des routines (voir init_allocator) */
+#define ALLOC_ROUTINE_SIZE 36
+#define FREE_ROUTINE_SIZE 17
+
+/* Adresses des routines: après la mise à 0 des listes et un JUMP */
+#define ALLOC_ADR (RAM_OS_INIT_SIZE + NB_SIZE_CLASSES + 1)
+#define FREE_ADR (ALLOC_ADR + ALLOC_ROUTINE_SIZE)
+#define RAM_OS_ALLOC_SIZE (FREE_ADR + FREE_ROUTINE_SIZE - RAM_OS_INIT_SIZE)
+
+
+/*
+ * Mode protégé (--guard): chaque appel de fonction vérifie que la pile de la
+ * fonction appelée (voir frame_size dans symbol_table.h) ne débordera pas sur
+ * le tas, et chaque ALLOUER que le tas ne débordera pas sur la pile.
+ * En cas d'échec, on saute dans une routine de ramOS (placée à la fin de ramOS,
+ * après un JUMP qui la saute à l'initialisation) qui écrit le code d'erreur
+ * sur la bande de sortie et arrête le programme:
+ * TRAP_STACK_OVERFLOW: débordement de la pile (appel de fonction)
+ * TRAP_HEAP_OVERFLOW:  débordement du tas (ALLOUER)
+ * Les routines sont à ram_os_size() - RAM_OS_TRAP_SIZE + TRAP_xxx_OFFSET.
+ */
+#define TRAP_STACK_OVERFLOW -1
+#define TRAP_HEAP_OVERFLOW -2
+
+#define TRAP_STACK_OFFSET 1
+#define TRAP_HEAP_OFFSET 4
+#define RAM_OS_TRAP_SIZE 7
+
+
 #endif
\ No newline at end of file
@@ -11,16 +11,26 @@
 #define POP_COST 2
 #define PEEK_COST 1
 
+/*
+ * Coût des vérifications de --guard (voir codegen_guard_stack/heap), +1 pour
+ * le tas si la fonction empile des valeurs temporaires
+ */
+#define GUARD_STACK_COST 4
+#define GUARD_HEAP_COST 3
 
-extern symb_table table;
 
+void reset_semantic();
 void semantic(ast *t);
 void second_turn_semantic(ast *t, ast *parent);
+void collect_uses(ast *t);
+void mark_src_uses();
 
 void semantic_nb(ast *t);
 void semantic_id(ast *t);
 void semantic_io(ast *t);
 void semantic_if(ast *t);
+void semantic_switch(ast *t);
+void semantic_inc(ast *t);
 void semantic_for(ast *t);
 void semantic_u_op(ast *t);
 void semantic_b_op(ast *t);
@@ -29,6 +39,9 @@ void semantic_decla(ast *t);
 void semantic_instr(ast *t);
 void semantic_while(ast *t);
 void semantic_alloc(ast *t);
+void semantic_free(ast *t);
+void semantic_block(ast *t);
+void semantic_io_tab(ast *t);
 void semantic_proto(ast *t);
 void semantic_affect(ast *t);
 void semantic_return(ast *t);
@@ -39,4 +52,6 @@ void semantic_var_decla(ast *t);
 void semantic_arr_access(ast *t);
 void semantic_func_decla(ast *t);
 
+int max_stack_size(ast *t, int rec_depth);
+
 #endif
\ No newline at end of file
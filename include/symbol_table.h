@@ -12,7 +12,10 @@
  * id: l'identificateur
  * type: le type de la donnée stockée (entier, pointeur, fonction, etc.)
  * size: la taille en mémoire (entier=1, pointeur=1, tableau=n, etc.)
+ * nb_cols: le nombre de colonnes d'un tableau à 2 dimensions (0 sinon)
  * adr: l'adresse de la donnée stockée
+ * frame_size: pour une fonction, le nombre de cases de la pile utilisées par
+ * un appel (--guard, voir semantic_func_decla)
  * mem_zone: 'h' si stocké dans le tas, 's' si dans la pile.
  * next: le symbole suivant dans le contexte
  * is_used: 1 si le symbole est utilisé, 0 sinon (pour warnings)
@@ -24,7 +27,9 @@ typedef struct _symbol {
     char id[ID_MAX_SIZE];
     type_symb type;
     int size;
+    int nb_cols;
     int adr;
+    int frame_size;
     char mem_zone;
     struct _symbol *next;
     int is_used;
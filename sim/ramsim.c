@@ -0,0 +1,354 @@
+/*
+ * Simulateur de la machine RAM, pour exécuter les programmes produits par arc.
+ *
+ * Utilisation: ramsim [-s] [-m taille] [-l limite] programme.ram [entrée]
+ *
+ * La bande d'entrée contient des entiers séparés par des blancs, lus dans le
+ * fichier entrée (l'entrée standard par défaut). Chaque WRITE écrit
+ * l'accumulateur sur une ligne de la sortie standard.
+ *
+ * -s: affiche (sur la sortie d'erreur) le nombre d'instructions exécutées et
+ *     le nombre de cases mémoire utilisées (écrites au moins une fois)
+ * -m: nombre de cases mémoire (65536 par défaut, voir STACK_START dans
+ *     ram_os.h et l'option --mem-size d'arc)
+ * -l: nombre maximal d'instructions exécutées (pour les boucles infinies)
+ *
+ * Les calculs se font sur des entiers de 64 bits (modulo 2^64 en cas de
+ * dépassement).
+ *
+ * Codes de retour: 0 si le programme s'arrête sur STOP, 1 si les arguments ou
+ * le programme sont invalides, 2 en cas d'erreur à l'exécution.
+ *
+ * Instructions (ACC est la case 0, n une constante, adr une adresse):
+ * READ, WRITE, STOP, NOP
+ * LOAD, STORE, INC, DEC, ADD, SUB, MUL, DIV, MOD: opérande #n, adr ou @adr
+ * JUMP, JUMZ, JUML, JUMG: saut à adr (JUMP @adr: à l'adresse contenue dans
+ * la case adr)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <getopt.h>
+
+
+#define DEFAULT_MEM_SIZE 65536
+#define DEFAULT_LIMIT 10000000000L
+
+
+typedef enum {
+    READ, WRITE, LOAD, STORE, DEC, INC, ADD, SUB, MUL, DIV, MOD, JUMP, JUMZ,
+    JUML, JUMG, STOP, NOP, NB_INSTR
+} instr_ram;
+
+
+static const char *instr_names[NB_INSTR] = {
+    "READ", "WRITE", "LOAD", "STORE", "DEC", "INC", "ADD", "SUB", "MUL", "DIV",
+    "MOD", "JUMP", "JUMZ", "JUML", "JUMG", "STOP", "NOP"
+};
+
+
+/*
+ * instr: l'instruction
+ * mode: '#' pour une constante, '@' pour l'adressage indirect, ' ' sinon
+ * val: la constante ou l'adresse
+ */
+typedef struct {
+    instr_ram instr;
+    char mode;
+    long val;
+} ram_instr;
+
+
+static ram_instr *prog = NULL;
+static long prog_len = 0;
+
+static long *mem = NULL;
+static unsigned char *is_used = NULL;
+static long mem_size = DEFAULT_MEM_SIZE;
+static long nb_used = 0;
+
+static long pc = 0;
+static long nb_steps = 0;
+
+
+
+static void runtime_error(const char *msg, long val)
+{
+    fprintf(stderr, "ramsim: erreur à l'instruction %ld: %s (%ld)\n", pc, msg,
+            val);
+    fprintf(stderr, "ramsim: %ld instructions exécutées\n", nb_steps);
+    exit(2);
+}
+
+
+
+/**
+ * @brief Lit le programme RAM du fichier fp (une instruction par ligne,
+ * terminée par un ';', les lignes vides sont ignorées).
+ *
+ * @param fp
+ * @param name Le nom du fichier (pour les erreurs)
+ */
+static void load_program(FILE *fp, const char *name)
+{
+    char line[256], op[16];
+    long capacity = 1024, line_nb = 0;
+    int i;
+
+    prog = (ram_instr *) malloc(sizeof(ram_instr) * capacity);
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        line_nb++;
+
+        char *s = line;
+        while (isspace(*s)) s++;
+        if (*s == '\0') continue;
+
+        if (sscanf(s, "%15[A-Z]", op) != 1) goto syntax_error;
+        for (i = 0; i < NB_INSTR && strcmp(op, instr_names[i]) != 0; i++);
+        if (i == NB_INSTR) goto syntax_error;
+
+        if (prog_len == capacity)
+        {
+            capacity *= 2;
+            prog = (ram_instr *) realloc(prog, sizeof(ram_instr) * capacity);
+        }
+        if (prog == NULL)
+        {
+            perror("ramsim");
+            exit(1);
+        }
+
+        ram_instr *r = &prog[prog_len++];
+        r->instr = i;
+        r->mode = ' ';
+        r->val = 0;
+
+        s += strlen(op);
+        while (*s == ' ' || *s == '\t') s++;
+        if (*s == '#' || *s == '@') r->mode = *s++;
+
+        /* Opérande obligatoire sauf pour READ, WRITE, STOP et NOP */
+        if (i != READ && i != WRITE && i != STOP && i != NOP)
+        {
+            char *end;
+            r->val = strtol(s, &end, 10);
+            if (end == s) goto syntax_error;
+            s = end;
+        }
+
+        while (*s == ' ' || *s == '\t') s++;
+        if (*s != ';') goto syntax_error;
+    }
+
+    return;
+
+syntax_error:
+    fprintf(stderr, "ramsim: %s:%ld: instruction invalide: %s", name, line_nb,
+            line);
+    exit(1);
+}
+
+
+
+static long check_adr(long adr)
+{
+    if (adr < 0 || adr >= mem_size) runtime_error("adresse invalide", adr);
+    return adr;
+}
+
+
+static void write_mem(long adr, long val)
+{
+    mem[check_adr(adr)] = val;
+    if (!is_used[adr])
+    {
+        is_used[adr] = 1;
+        if (adr != 0) nb_used++;
+    }
+}
+
+
+
+/**
+ * @brief Renvoie la valeur de l'opérande de r (et son adresse dans adr s'il
+ * désigne une case mémoire).
+ *
+ * @param r
+ * @param adr
+ * @return long
+ */
+static long operand(ram_instr *r, long *adr)
+{
+    if (r->mode == '#') return r->val;
+
+    *adr = r->mode == '@' ? mem[check_adr(r->val)] : r->val;
+    return mem[check_adr(*adr)];
+}
+
+
+
+/**
+ * @brief Exécute le programme jusqu'à l'instruction STOP.
+ *
+ * @param input La bande d'entrée
+ * @param limit Le nombre maximal d'instructions exécutées
+ */
+static void run(FILE *input, long limit)
+{
+    long adr = -1, val;
+
+    while (1)
+    {
+        if (pc < 0 || pc >= prog_len) runtime_error("sortie du programme", pc);
+        if (nb_steps == limit) runtime_error("limite d'instructions", limit);
+
+        ram_instr *r = &prog[pc];
+        nb_steps++;
+
+        if (r->instr >= LOAD && r->instr <= MOD)
+        {
+            if ((r->instr == STORE || r->instr == INC || r->instr == DEC)
+                && r->mode == '#') runtime_error("opérande invalide", r->val);
+            val = operand(r, &adr);
+        }
+
+        switch (r->instr)
+        {
+        case READ:
+            if (fscanf(input, "%ld", &val) != 1)
+            {
+                runtime_error("bande d'entrée vide", 0);
+            }
+            write_mem(0, val);
+            break;
+        case WRITE:
+            printf("%ld\n", mem[0]);
+            break;
+        case LOAD:
+            write_mem(0, val);
+            break;
+        case STORE:
+            write_mem(adr, mem[0]);
+            break;
+        case INC:
+            write_mem(adr, (unsigned long) val + 1);
+            break;
+        case DEC:
+            write_mem(adr, (unsigned long) val - 1);
+            break;
+        case ADD:
+            write_mem(0, (unsigned long) mem[0] + val);
+            break;
+        case SUB:
+            write_mem(0, (unsigned long) mem[0] - val);
+            break;
+        case MUL:
+            write_mem(0, (unsigned long) mem[0] * val);
+            break;
+        case DIV:
+        case MOD:
+            if (val == 0) runtime_error("division par zéro", mem[0]);
+            if (val == -1) val = mem[0] == LONG_MIN ? 1 : -1;
+            write_mem(0, r->instr == DIV ? mem[0] / val : mem[0] % val);
+            break;
+        case JUMP:
+            pc = r->mode == '@' ? mem[check_adr(r->val)] : r->val;
+            continue;
+        case JUMZ:
+        case JUML:
+        case JUMG:
+            if ((r->instr == JUMZ && mem[0] == 0)
+                || (r->instr == JUML && mem[0] < 0)
+                || (r->instr == JUMG && mem[0] > 0))
+            {
+                pc = r->val;
+                continue;
+            }
+            break;
+        case STOP:
+            return;
+        default:
+            break;
+        }
+
+        pc++;
+    }
+}
+
+
+
+int main(int argc, char **argv)
+{
+    int opt, print_stats = 0;
+    long limit = DEFAULT_LIMIT;
+
+    while ((opt = getopt(argc, argv, "sm:l:")) != -1)
+    {
+        switch (opt)
+        {
+        case 's':
+            print_stats = 1;
+            break;
+        case 'm':
+            mem_size = atol(optarg);
+            break;
+        case 'l':
+            limit = atol(optarg);
+            break;
+        default:
+            optind = argc + 1;
+            break;
+        }
+    }
+
+    if (optind >= argc || argc - optind > 2 || mem_size <= 0 || limit <= 0)
+    {
+        fprintf(stderr, "Utilisation: ramsim [-s] [-m taille] [-l limite] "\
+                "programme.ram [entrée]\n");
+        return 1;
+    }
+
+    FILE *fp = fopen(argv[optind], "r");
+    if (fp == NULL)
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+    load_program(fp, argv[optind]);
+    fclose(fp);
+
+    FILE *input = stdin;
+    if (argc - optind == 2 && (input = fopen(argv[optind + 1], "r")) == NULL)
+    {
+        perror(argv[optind + 1]);
+        return 1;
+    }
+
+    mem = (long *) calloc(mem_size, sizeof(long));
+    is_used = (unsigned char *) calloc(mem_size, sizeof(unsigned char));
+    if (mem == NULL || is_used == NULL)
+    {
+        perror("ramsim");
+        return 1;
+    }
+
+    run(input, limit);
+
+    if (print_stats)
+    {
+        fprintf(stderr, "Instructions exécutées: %ld\n", nb_steps);
+        fprintf(stderr, "Mémoire utilisée: %ld cases\n", nb_used);
+    }
+
+    if (input != stdin) fclose(input);
+    free(prog);
+    free(mem);
+    free(is_used);
+
+    return 0;
+}
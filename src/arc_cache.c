@@ -0,0 +1,506 @@
+#include "arc_cache.h"
+#include "arc_utils.h"
+#include "arc_context.h"
+#include "symbol_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <linux/limits.h>
+
+
+/* Constantes de l'empreinte FNV-1a (64 bits) */
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+
+/*
+ * Instruction enregistrée dans le cache.
+ * adr: l'adresse, relative au début de la fonction si reloc vaut RELOC_CODE
+ * func: la fonction appelée si reloc vaut RELOC_FUNC
+ */
+typedef struct {
+    instr_ram instr;
+    char t_adr;
+    int adr;
+    reloc_type reloc;
+    char func[ID_MAX_SIZE];
+} cached_instr;
+
+
+/* Fonction en cours de génération (pas encore dans le cache) */
+static int is_recording = 0;
+static unsigned long long key;
+static int start_adr;
+static cached_instr *code = NULL;
+static int code_len = 0;
+static int code_capacity = 0;
+
+/* Relocation de la prochaine instruction (voir cache_tag) */
+static reloc_type next_reloc = RELOC_NONE;
+static char next_func[ID_MAX_SIZE];
+
+static int nb_hits = 0;
+static int nb_misses = 0;
+
+/* Vérification des indices des tableaux (voir codegen_arr_access) */
+extern int bounds_check;
+
+/* Vérification des débordements de la pile et du tas (voir ram_os.h) */
+extern int guard_mode;
+
+
+
+static unsigned long long hash_bytes(unsigned long long h, const void *data,
+                                     size_t n)
+{
+    const unsigned char *p = (const unsigned char *) data;
+    for (size_t i = 0; i < n; i++)
+    {
+        h ^= p[i];
+        h *= FNV_PRIME;
+    }
+
+    return h;
+}
+
+
+static unsigned long long hash_int(unsigned long long h, long n)
+{
+    return hash_bytes(h, &n, sizeof(long));
+}
+
+
+static unsigned long long hash_str(unsigned long long h, const char *s)
+{
+    return hash_bytes(h, s, strlen(s) + 1);
+}
+
+
+
+/**
+ * @brief Ajoute à l'empreinte h l'identificateur t et son symbole (la
+ * génération de code dépend de son adresse, de sa zone mémoire, de son
+ * type et, avec --bounds-check, de sa taille).
+ *
+ * @param h
+ * @param t
+ * @param ctx Le contexte de la fonction
+ * @return unsigned long long
+ */
+static unsigned long long hash_id(unsigned long long h, ast *t, const char *ctx)
+{
+    h = hash_str(h, t->id.name);
+
+    symbol *s = search_symbol(arc_ctx.table, ctx, t->id.name);
+    if (s == NULL) s = search_symbol(arc_ctx.table, "global", t->id.name);
+    if (s == NULL) return h;
+
+    h = hash_int(h, s->adr);
+    h = hash_int(h, s->mem_zone);
+    h = hash_int(h, s->size);
+    return hash_int(h, s->type);
+}
+
+
+
+/**
+ * @brief Ajoute à l'empreinte h le sous-arbre t (même parcours que
+ * count_nodes). La taille du code de chaque noeud en fait partie.
+ * Les noms des fonctions appelées sont pris en compte mais pas leur adresse,
+ * qui est retrouvée lors de la réutilisation du code (RELOC_FUNC).
+ *
+ * @param h
+ * @param t
+ * @param ctx Le contexte de la fonction
+ * @return unsigned long long
+ */
+static unsigned long long hash_ast(unsigned long long h, ast *t,
+                                   const char *ctx)
+{
+    if (t == NULL) return hash_int(h, -1);
+
+    h = hash_int(h, t->type);
+    h = hash_int(h, t->codelen);
+
+    switch (t->type)
+    {
+    case nb_type:
+        h = hash_int(h, t->nb.val);
+        break;
+    case id_type:
+        h = hash_id(h, t, ctx);
+        break;
+    case b_op_type:
+        h = hash_int(h, t->b_op.ope);
+        h = hash_ast(h, t->b_op.l_memb, ctx);
+        h = hash_ast(h, t->b_op.r_memb, ctx);
+        break;
+    case u_op_type:
+        h = hash_int(h, t->u_op.ope);
+        h = hash_ast(h, t->u_op.child, ctx);
+        break;
+    case instr_type:
+        h = hash_ast(h, t->list_instr.instr, ctx);
+        h = hash_ast(h, t->list_instr.next, ctx);
+        break;
+    case affect_type:
+        h = hash_int(h, t->affect.is_deref);
+        h = hash_ast(h, t->affect.id, ctx);
+        h = hash_ast(h, t->affect.expr, ctx);
+        break;
+    case decla_type:
+        h = hash_ast(h, t->decla_list.decla, ctx);
+        h = hash_ast(h, t->decla_list.next, ctx);
+        break;
+    case var_decla_type:
+        h = hash_int(h, t->var_decla.type);
+        h = hash_ast(h, t->var_decla.expr, ctx);
+        h = hash_ast(h, t->var_decla.var, ctx);
+        h = hash_ast(h, t->var_decla.next, ctx);
+        break;
+    case func_decla_type:
+        h = hash_str(h, t->func_decla.id->id.name);
+        h = hash_ast(h, t->func_decla.params, ctx);
+        h = hash_ast(h, t->func_decla.list_decl, ctx);
+        h = hash_ast(h, t->func_decla.list_instr, ctx);
+        h = hash_int(h, t->func_decla.heap_mark);
+        break;
+    case while_type:
+        h = hash_ast(h, t->while_n.expr, ctx);
+        h = hash_ast(h, t->while_n.list_instr, ctx);
+        break;
+    case if_type:
+        h = hash_ast(h, t->if_n.expr, ctx);
+        h = hash_ast(h, t->if_n.list_instr1, ctx);
+        h = hash_ast(h, t->if_n.list_instr2, ctx);
+        break;
+    case switch_type:
+        h = hash_ast(h, t->switch_n.expr, ctx);
+        h = hash_ast(h, t->switch_n.cases, ctx);
+        h = hash_ast(h, t->switch_n.default_instr, ctx);
+        break;
+    case case_type:
+        h = hash_int(h, t->case_n.val);
+        h = hash_ast(h, t->case_n.list_instr, ctx);
+        h = hash_ast(h, t->case_n.next, ctx);
+        break;
+    case block_type:
+        h = hash_int(h, t->block.op);
+        h = hash_ast(h, t->block.dst, ctx);
+        h = hash_ast(h, t->block.src, ctx);
+        h = hash_ast(h, t->block.size, ctx);
+        break;
+    case do_while_type:
+        h = hash_ast(h, t->do_while.expr, ctx);
+        h = hash_ast(h, t->do_while.list_instr, ctx);
+        break;
+    case exp_list_type:
+        h = hash_ast(h, t->exp_list.exp, ctx);
+        h = hash_ast(h, t->exp_list.next, ctx);
+        break;
+    case func_call_type:
+        h = hash_str(h, t->func_call.func_id->id.name);
+        h = hash_ast(h, t->func_call.params, ctx);
+
+        /* --guard: la taille de la pile de la fonction appelée est vérifiée */
+        if (guard_mode)
+        {
+            symbol *f = search_symbol(arc_ctx.table, "global",
+                                      t->func_call.func_id->id.name);
+            if (f != NULL) h = hash_int(h, f->frame_size);
+        }
+        break;
+    case return_type:
+        h = hash_ast(h, t->return_n.expr, ctx);
+        break;
+    case for_type:
+        h = hash_ast(h, t->for_n.id, ctx);
+        h = hash_ast(h, t->for_n.affect_init, ctx);
+        h = hash_ast(h, t->for_n.list_instr, ctx);
+        h = hash_ast(h, t->for_n.end_exp, ctx);
+        break;
+    case io_type:
+        h = hash_int(h, t->io.mode);
+        h = hash_ast(h, t->io.expr, ctx);
+        h = hash_ast(h, t->io.id, ctx);
+        break;
+    case array_access_type:
+        h = hash_ast(h, t->arr_access.id, ctx);
+        h = hash_ast(h, t->arr_access.ind_expr, ctx);
+        h = hash_ast(h, t->arr_access.affect_expr, ctx);
+        h = hash_ast(h, t->arr_access.col_expr, ctx);
+        h = hash_int(h, t->arr_access.in_bounds);
+        break;
+    case array_decla_type:
+        h = hash_int(h, t->arr_decla.size);
+        h = hash_int(h, t->arr_decla.nb_cols);
+        h = hash_ast(h, t->arr_decla.id, ctx);
+        h = hash_ast(h, t->arr_decla.list_expr, ctx);
+        break;
+    case alloc_type:
+        /* Le code d'ALLOUER change si le programme utilise LIBERER */
+        h = hash_int(h, t->alloc.is_local);
+        h = hash_int(h, arc_ctx.uses_free);
+        h = hash_ast(h, t->alloc.id, ctx);
+        h = hash_ast(h, t->alloc.expr, ctx);
+        break;
+    case inc_type:
+        h = hash_ast(h, t->inc.id, ctx);
+        break;
+    case free_type:
+        h = hash_ast(h, t->free_n.id, ctx);
+        break;
+    default:
+        break;
+    }
+
+    return h;
+}
+
+
+
+/**
+ * @brief Renvoie l'empreinte de l'exécutable d'arc: le code mis en cache par
+ * une autre version du compilateur n'est pas réutilisé.
+ *
+ * @return unsigned long long
+ */
+static unsigned long long hash_compiler()
+{
+    static unsigned long long h = 0;
+    struct stat st;
+
+    if (h != 0) return h;
+
+    h = FNV_OFFSET;
+    if (stat("/proc/self/exe", &st) == 0)
+    {
+        h = hash_int(h, st.st_size);
+        h = hash_int(h, st.st_mtime);
+    }
+
+    return h;
+}
+
+
+
+static void cache_path(char *dest, unsigned long long k)
+{
+    snprintf(dest, PATH_MAX, "%s/%016llx.ramc", cache_dir, k);
+}
+
+
+
+/**
+ * @brief Lit le code enregistré dans le fichier fp (format écrit par
+ * cache_save).
+ *
+ * @param fp
+ * @return int 1 si le fichier est valide, 0 sinon
+ */
+static int read_code(FILE *fp)
+{
+    int n, i, instr, t_adr, reloc;
+    char func[ID_MAX_SIZE + 1];
+
+    if (fscanf(fp, "arc-cache %d\n", &n) != 1 || n < 0) return 0;
+
+    code_len = 0;
+    for (i = 0; i < n; i++)
+    {
+        if (code_len == code_capacity)
+        {
+            code_capacity = code_capacity == 0 ? 64 : code_capacity * 2;
+            code = (cached_instr *) realloc(code,
+                                            sizeof(cached_instr) * code_capacity);
+            check_alloc(code);
+        }
+
+        cached_instr *c = &code[code_len++];
+        if (fscanf(fp, "%d %d %d %d %32s\n", &instr, &t_adr, &c->adr, &reloc,
+                   func) != 5 || instr < READ || instr > NOP
+            || reloc < RELOC_NONE || reloc > RELOC_OS) return 0;
+
+        c->instr = instr;
+        c->t_adr = t_adr;
+        c->reloc = reloc;
+        strcpy(c->func, func);
+    }
+
+    return 1;
+}
+
+
+
+/**
+ * @brief Génère le code de la fonction t (qui commence à l'adresse start) à
+ * partir du cache s'il y est. Sinon, le code qui va être généré est
+ * enregistré (voir cache_record), puis mis dans le cache par cache_save.
+ *
+ * @param t Le noeud de déclaration de la fonction
+ * @param ctx Le contexte de la fonction
+ * @param start L'adresse de la 1ère instruction de la fonction
+ * @return int 1 si le code a été généré à partir du cache, 0 sinon
+ */
+int cache_load(ast *t, const char *ctx, int start)
+{
+    char path[PATH_MAX];
+    int i, adr;
+
+    /*
+     * Les déclarations et ALLOUER changent avec --bounds-check. Avec --guard,
+     * l'adresse des routines d'erreur dépend de la taille de ramOS.
+     */
+    key = hash_int(hash_compiler(), bounds_check);
+    key = hash_ast(hash_int(key, guard_mode ? ram_os_size() : 0), t, ctx);
+    start_adr = start;
+    cache_path(path, key);
+
+    FILE *fp = fopen(path, "r");
+    if (fp != NULL)
+    {
+        int is_valid = read_code(fp) && code_len == (int) t->codelen;
+        fclose(fp);
+
+        if (is_valid)
+        {
+            for (i = 0; i < code_len; i++)
+            {
+                adr = code[i].adr;
+                if (code[i].reloc == RELOC_CODE) adr += start;
+                else if (code[i].reloc == RELOC_FUNC)
+                {
+                    adr = get_symbol(arc_ctx.table, ctx, code[i].func)->adr;
+                }
+                add_instr(code[i].instr, code[i].t_adr, adr);
+            }
+
+            nb_hits++;
+            return 1;
+        }
+    }
+
+    nb_misses++;
+    is_recording = 1;
+    code_len = 0;
+    return 0;
+}
+
+
+
+/**
+ * @brief Indique le type de relocation de la prochaine instruction générée.
+ * Les sauts directs (JUMP, JUMZ, etc.) sont considérés par défaut comme des
+ * sauts dans la fonction.
+ *
+ * @param type
+ * @param func La fonction appelée (pour RELOC_FUNC)
+ */
+void cache_tag(reloc_type type, const char *func)
+{
+    next_reloc = type;
+    if (func != NULL) strcpy(next_func, func);
+}
+
+
+
+/**
+ * @brief Enregistre l'instruction générée si le code de la fonction courante
+ * doit être mis dans le cache (appelée par add_instr).
+ *
+ * @param instr
+ * @param t_adr
+ * @param adr
+ */
+void cache_record(instr_ram instr, char t_adr, int adr)
+{
+    reloc_type reloc = next_reloc;
+    next_reloc = RELOC_NONE;
+
+    if (!is_recording) return;
+
+    if (reloc == RELOC_NONE && t_adr == ' ' && instr >= JUMP && instr <= JUMG)
+    {
+        reloc = RELOC_CODE;
+    }
+
+    if (code_len == code_capacity)
+    {
+        code_capacity = code_capacity == 0 ? 64 : code_capacity * 2;
+        code = (cached_instr *) realloc(code,
+                                        sizeof(cached_instr) * code_capacity);
+        check_alloc(code);
+    }
+
+    cached_instr *c = &code[code_len++];
+    c->instr = instr;
+    c->t_adr = t_adr;
+    c->adr = reloc == RELOC_CODE ? adr - start_adr : adr;
+    c->reloc = reloc;
+    strcpy(c->func, reloc == RELOC_FUNC ? next_func : "-");
+}
+
+
+
+/**
+ * @brief Écrit dans le cache le code enregistré de la fonction courante.
+ * Le fichier est écrit sous un nom temporaire puis renommé, pour que des
+ * compilations simultanées (-j) ne lisent jamais un fichier incomplet.
+ *
+ */
+void cache_save()
+{
+    char path[PATH_MAX], tmp_path[PATH_MAX + 16];
+    int i;
+
+    if (!is_recording) return;
+    is_recording = 0;
+
+    mkdir(cache_dir, 0755);
+    cache_path(path, key);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%d", path, getpid());
+
+    FILE *fp = fopen(tmp_path, "w");
+    if (fp == NULL) return;     /* Pas de cache, mais le code est correct */
+
+    fprintf(fp, "arc-cache %d\n", code_len);
+    for (i = 0; i < code_len; i++)
+    {
+        fprintf(fp, "%d %d %d %d %s\n", code[i].instr, code[i].t_adr,
+                code[i].adr, code[i].reloc, code[i].func);
+    }
+
+    if (fclose(fp) == 0) rename(tmp_path, path);
+    else remove(tmp_path);
+}
+
+
+
+/**
+ * @brief Remet à zéro l'état du cache avant la compilation d'un autre
+ * fichier.
+ *
+ */
+void reset_cache()
+{
+    free(code);
+    code = NULL;
+    code_len = code_capacity = 0;
+    is_recording = 0;
+    next_reloc = RELOC_NONE;
+    nb_hits = nb_misses = 0;
+}
+
+
+int cache_nb_hits()
+{
+    return nb_hits;
+}
+
+
+int cache_nb_misses()
+{
+    return nb_misses;
+}
@@ -0,0 +1,74 @@
+#include "arc_context.h"
+#include "arc_utils.h"
+#include "ast.h"
+#include "symbol_table.h"
+#include "semantic.h"
+#include "codegen.h"
+#include "arc_cache.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+extern void reset_lexer();
+
+
+arc_context arc_ctx = {NULL, NULL, NULL, NULL, 0, 0, 0, {0}};
+
+
+
+/**
+ * @brief Prépare le contexte pour la compilation du fichier `src` vers le
+ * fichier `exename`.
+ * 
+ * @param src 
+ * @param exename 
+ */
+void init_context(const char *src, const char *exename)
+{
+    arc_ctx.src = (char *) malloc(sizeof(char) * (strlen(src) + 1));
+    check_alloc(arc_ctx.src);
+    strcpy(arc_ctx.src, src);
+
+    arc_ctx.exename = (char *) malloc(sizeof(char) * (strlen(exename) + 1));
+    check_alloc(arc_ctx.exename);
+    strcpy(arc_ctx.exename, exename);
+
+    arc_ctx.tree = NULL;
+    arc_ctx.table = init_symb_table("global");
+    arc_ctx.line_offset = 0;
+    arc_ctx.uses_free = 0;
+    arc_ctx.uses_alloc = 0;
+    diag_init(&arc_ctx.diags, arc_ctx.src);
+}
+
+
+
+/**
+ * @brief Libère le contexte de la compilation d'un fichier et remet à zéro
+ * l'état des différents modules (analyse lexicale, sémantique, génération de
+ * code), pour que rien ne soit conservé d'un fichier à l'autre.
+ * 
+ */
+void reset_context()
+{
+    /* Affiche les diagnostics restants (utilise encore src) */
+    diag_free(&arc_ctx.diags);
+
+    free(arc_ctx.src);
+    free(arc_ctx.exename);
+    free_ast(arc_ctx.tree);
+    free_table(arc_ctx.table);
+
+    arc_ctx.src = NULL;
+    arc_ctx.exename = NULL;
+    arc_ctx.tree = NULL;
+    arc_ctx.table = NULL;
+    arc_ctx.line_offset = 0;
+    arc_ctx.uses_free = 0;
+    arc_ctx.uses_alloc = 0;
+
+    reset_lexer();
+    reset_semantic();
+    reset_codegen();
+    reset_cache();
+}
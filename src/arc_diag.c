@@ -0,0 +1,310 @@
+#include "arc_diag.h"
+#include "arc_utils.h"
+#include "arc_context.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/* Taille maximale d'un format une fois les séquences ANSI appliquées */
+#define DIAG_FMT_SIZE 1024
+
+
+
+/**
+ * @brief Écrit dans dest le format fmt en remplaçant les formats suivants par
+ * les séquences d'échappement ANSI correspondantes:
+ * ~r pour afficher en rouge (~g, ~b, ~y, etc. pour les autres couleurs)
+ * ~B et ~U pour afficher en gras et souligné.
+ * ~E pour stopper la séquence.
+ * Le résultat est tronqué s'il ne tient pas dans dest.
+ *
+ * @param dest
+ * @param size La taille de dest
+ * @param fmt
+ */
+static void ansi_fmt(char *dest, size_t size, const char *fmt)
+{
+    char buff[16];
+    size_t i = 0, c_size = 0, len;
+
+    while (fmt[i] != '\0')
+    {
+        buff[0] = fmt[i];
+        buff[1] = '\0';
+
+        /* Gestion des formats gérant les séquences d'échappement */
+        if (fmt[i] == '~' && fmt[i + 1] != '\0')
+        {
+            i++;
+            switch (fmt[i])
+            {
+            case 'r': sprintf(buff, "\033[%dm", RED); break;
+            case 'g': sprintf(buff, "\033[%dm", GREEN); break;
+            case 'y': sprintf(buff, "\033[%dm", YELLOW); break;
+            case 'b': sprintf(buff, "\033[%dm", BLUE); break;
+            case 'm': sprintf(buff, "\033[%dm", MAGENTA); break;
+            case 'c': sprintf(buff, "\033[%dm", CYAN); break;
+            case 'B': sprintf(buff, "\033[1m"); break;
+            case 'U': sprintf(buff, "\033[4m"); break;
+            case 'E': sprintf(buff, "\033[0m"); break;
+            default: buff[0] = fmt[i]; break;
+            }
+        }
+
+        len = strlen(buff);
+        if (c_size + len >= size) break;
+
+        memcpy(dest + c_size, buff, len);
+        c_size += len;
+        i++;
+    }
+
+    dest[c_size] = '\0';
+}
+
+
+
+/**
+ * @brief Prépare le moteur de diagnostics pour la compilation du fichier src.
+ * Le fichier n'est lu qu'au premier diagnostic qui en affiche une ligne.
+ *
+ * @param d
+ * @param src
+ */
+void diag_init(diag_engine *d, const char *src)
+{
+    memset(d, 0, sizeof(diag_engine));
+    d->src = src;
+}
+
+
+
+/**
+ * @brief Lit le fichier source et construit l'index des débuts de lignes.
+ * En cas d'échec, le fichier est considéré vide (les diagnostics sont
+ * affichés sans extrait du code).
+ *
+ * @param d
+ */
+static void load_source(diag_engine *d)
+{
+    size_t i;
+    int n = 0;
+
+    d->buffer = (char *) malloc(sizeof(char));
+    check_alloc(d->buffer);
+    d->size = 0;
+
+    FILE *fp = d->src == NULL ? NULL : fopen(d->src, "r");
+    if (fp != NULL)
+    {
+        fseek(fp, 0, SEEK_END);
+        long size = ftell(fp);
+        rewind(fp);
+
+        if (size > 0)
+        {
+            d->buffer = (char *) realloc(d->buffer, sizeof(char) * size);
+            check_alloc(d->buffer);
+            d->size = fread(d->buffer, sizeof(char), size, fp);
+        }
+        fclose(fp);
+    }
+
+    /* Une ligne commence au début du fichier et après chaque '\n' */
+    d->nb_lines = 0;
+    for (i = 0; i < d->size; i++)
+    {
+        if (d->buffer[i] == '\n') d->nb_lines++;
+    }
+    if (d->size > 0 && d->buffer[d->size - 1] != '\n') d->nb_lines++;
+
+    d->lines = (size_t *) malloc(sizeof(size_t) * (d->nb_lines + 1));
+    check_alloc(d->lines);
+
+    d->lines[n++] = 0;
+    for (i = 0; i < d->size && n < d->nb_lines; i++)
+    {
+        if (d->buffer[i] == '\n') d->lines[n++] = i + 1;
+    }
+    d->lines[d->nb_lines] = d->size;
+}
+
+
+
+/**
+ * @brief Ajoute un diagnostic, à la position donnée par set_error_info s'il y
+ * en a une (la position est ensuite oubliée).
+ *
+ * @param d
+ * @param kind
+ * @param fmt Le format (voir ansi_fmt pour les formats supplémentaires)
+ * @param args
+ */
+void diag_add(diag_engine *d, diag_kind kind, const char *fmt, va_list args)
+{
+    if (d->nb == d->capacity)
+    {
+        d->capacity = d->capacity == 0 ? 16 : d->capacity * 2;
+        d->list = (diagnostic *) realloc(d->list,
+                                         sizeof(diagnostic) * d->capacity);
+        check_alloc(d->list);
+    }
+
+    diagnostic *diag = &d->list[d->nb++];
+    diag->kind = kind;
+    diag->has_loc = d->has_info && d->src != NULL;
+    diag->loc = d->loc;
+    diag->order = d->nb_added++;
+    d->has_info = 0;
+
+    char buff[DIAG_FMT_SIZE];
+    ansi_fmt(buff, DIAG_FMT_SIZE, fmt);
+
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(NULL, 0, buff, copy);
+    va_end(copy);
+
+    diag->msg = (char *) malloc(sizeof(char) * (len + 1));
+    check_alloc(diag->msg);
+    vsnprintf(diag->msg, len + 1, buff, args);
+}
+
+
+
+/**
+ * @brief Ordre d'affichage des diagnostics: ceux sans position d'abord, puis
+ * par ligne et colonne, puis dans l'ordre d'ajout.
+ *
+ * @param a
+ * @param b
+ * @return int
+ */
+static int cmp_diag(const void *a, const void *b)
+{
+    const diagnostic *d1 = (const diagnostic *) a;
+    const diagnostic *d2 = (const diagnostic *) b;
+
+    if (d1->has_loc != d2->has_loc) return d1->has_loc - d2->has_loc;
+    if (d1->has_loc && d1->loc.first_line != d2->loc.first_line)
+    {
+        return d1->loc.first_line - d2->loc.first_line;
+    }
+    if (d1->has_loc && d1->loc.first_column != d2->loc.first_column)
+    {
+        return d1->loc.first_column - d2->loc.first_column;
+    }
+
+    return d1->order - d2->order;
+}
+
+
+
+/**
+ * @brief Affiche un diagnostic et, s'il a une position, la ligne concernée du
+ * fichier source.
+ *
+ * @param d
+ * @param diag
+ */
+static void print_diag(diag_engine *d, diagnostic *diag)
+{
+    int clr = diag->kind == DIAG_ERROR ? RED : MAGENTA;
+
+    if (diag->has_loc)
+    {
+        fprintf(stderr, "\033[1m%s:%d:%d:\033[0m ", d->src,
+                diag->loc.first_line, diag->loc.first_column);
+    }
+
+    if (diag->kind == DIAG_ERROR)
+    {
+        fprintf(stderr, "\033[%d;1merreur fatale:\033[0m ", clr);
+    }
+    else fprintf(stderr, "\033[%d;1mwarning:\033[0m ", clr);
+
+    fprintf(stderr, "%s\n", diag->msg);
+
+    if (!diag->has_loc) return;
+
+    if (d->buffer == NULL) load_source(d);
+
+    /* Ligne hors du fichier source (par exemple dans un fichier inclus) */
+    int n = diag->loc.first_line;
+    if (n < 1 || n > d->nb_lines) return;
+
+    char *line = d->buffer + d->lines[n - 1];
+    int len = d->lines[n] - d->lines[n - 1];
+    if (len > 0 && line[len - 1] == '\n') len--;
+
+    char line_info[128];
+    sprintf(line_info, " %d |", n);
+    fprintf(stderr, "%s %.*s\n", line_info, len, line);
+
+    for (size_t i = 0; i < strlen(line_info) - 1; i++) fprintf(stderr, " ");
+    fprintf(stderr, "|");
+
+    int i;
+    for (i = 0; i < diag->loc.first_column; i++) fprintf(stderr, " ");
+    fprintf(stderr, "\033[%dm^", clr);
+    for (i = i + 1; i < diag->loc.last_column; i++) fprintf(stderr, "~");
+    fprintf(stderr, "\033[0m\n");
+}
+
+
+
+/**
+ * @brief Affiche (dans stderr) les diagnostics en attente, triés par position
+ * dans le fichier source.
+ *
+ * @param d
+ */
+void diag_flush(diag_engine *d)
+{
+    qsort(d->list, d->nb, sizeof(diagnostic), cmp_diag);
+
+    for (int i = 0; i < d->nb; i++)
+    {
+        print_diag(d, &d->list[i]);
+        free(d->list[i].msg);
+    }
+
+    d->nb = 0;
+}
+
+
+
+/**
+ * @brief Affiche les diagnostics en attente puis libère le moteur.
+ *
+ * @param d
+ */
+void diag_free(diag_engine *d)
+{
+    diag_flush(d);
+
+    free(d->list);
+    free(d->buffer);
+    free(d->lines);
+    diag_init(d, NULL);
+}
+
+
+
+/**
+ * @brief Convertit une position dans le fichier produit par le préprocesseur
+ * (celle de yylloc) en position dans le fichier source.
+ *
+ * @param pp_loc
+ * @return YYLTYPE
+ */
+YYLTYPE diag_src_loc(YYLTYPE pp_loc)
+{
+    pp_loc.first_line -= arc_ctx.line_offset;
+    pp_loc.last_line -= arc_ctx.line_offset;
+
+    return pp_loc;
+}
@@ -0,0 +1,144 @@
+#include "arc_jobs.h"
+#include "arc_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+
+/*
+ * Travail (compilation d'un fichier) lancé dans un processus fils.
+ * pid: le processus qui l'exécute (0 s'il n'est pas encore lancé)
+ * out, err: fichiers temporaires recevant les sorties du processus
+ * status: le code de retour du processus (-1 tant qu'il n'est pas terminé)
+ */
+typedef struct {
+    pid_t pid;
+    FILE *out;
+    FILE *err;
+    int status;
+} job_info;
+
+
+
+/**
+ * @brief Lance le travail `i` dans un processus fils, dont les sorties sont
+ * redirigées vers des fichiers temporaires.
+ * 
+ * @param j 
+ * @param i 
+ * @param job 
+ */
+static void start_job(job_info *j, int i, void (*job)(int))
+{
+    j->out = tmpfile();
+    check_alloc(j->out);
+    j->err = tmpfile();
+    check_alloc(j->err);
+
+    /* Sinon le contenu des tampons serait écrit par le fils aussi */
+    fflush(stdout);
+    fflush(stderr);
+
+    j->pid = fork();
+    if (j->pid == -1)
+    {
+        perror("fork");
+        exit(1);
+    }
+
+    if (j->pid == 0)
+    {
+        dup2(fileno(j->out), STDOUT_FILENO);
+        dup2(fileno(j->err), STDERR_FILENO);
+
+        job(i);
+        exit(0);
+    }
+}
+
+
+
+/**
+ * @brief Recopie le contenu du fichier temporaire `src` dans `dest` et ferme
+ * `src`.
+ * 
+ * @param src 
+ * @param dest 
+ */
+static void replay(FILE *src, FILE *dest)
+{
+    char buff[4096];
+    size_t n;
+
+    /* Le fils a écrit dans le fichier: la position est partagée */
+    rewind(src);
+    while ((n = fread(buff, sizeof(char), sizeof(buff), src)) > 0)
+    {
+        fwrite(buff, sizeof(char), n, dest);
+    }
+    fclose(src);
+}
+
+
+
+/**
+ * @brief Exécute les travaux 0 à nb_files - 1 (`job(i)`) dans au plus
+ * `nb_jobs` processus en même temps.
+ * Les sorties de chaque travail sont affichées en entier, dans l'ordre des
+ * travaux (et non dans l'ordre où ils se terminent).
+ * 
+ * @param nb_files 
+ * @param nb_jobs 
+ * @param job 
+ * @return int Le code de retour du 1er travail qui a échoué, 0 sinon
+ */
+int run_jobs(int nb_files, int nb_jobs, void (*job)(int))
+{
+    job_info *jobs = (job_info *) calloc(nb_files, sizeof(job_info));
+    check_alloc(jobs);
+
+    int next = 0, running = 0, printed = 0, result = 0;
+    int i, status;
+    pid_t pid;
+
+    for (i = 0; i < nb_files; i++) jobs[i].status = -1;
+
+    while (printed < nb_files)
+    {
+        while (running < nb_jobs && next < nb_files)
+        {
+            start_job(&jobs[next], next, job);
+            next++;
+            running++;
+        }
+
+        /* Attente de la fin d'un des travaux en cours */
+        pid = wait(&status);
+        if (pid == -1)
+        {
+            perror("wait");
+            exit(1);
+        }
+
+        for (i = 0; i < next && jobs[i].pid != pid; i++);
+        if (i == next) continue;
+
+        jobs[i].status = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+        running--;
+
+        /* Affichage des sorties des travaux terminés, dans l'ordre */
+        while (printed < next && jobs[printed].status != -1)
+        {
+            replay(jobs[printed].out, stdout);
+            replay(jobs[printed].err, stderr);
+            fflush(stdout);
+
+            if (result == 0) result = jobs[printed].status;
+            printed++;
+        }
+    }
+
+    free(jobs);
+    return result;
+}
@@ -2,23 +2,44 @@
 #include <string.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <getopt.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "arc_utils.h"
 #include "preprocessor.h"
+#include "optim.h"
+#include "arc_stats.h"
+#include "arc_cache.h"
 
 
 extern char *include_path;
-extern char *exename;
+extern char *output;
+extern char **input_files;
+extern int nb_input_files;
+extern int nb_jobs;
 extern int is_dbg_mode;
 extern int print_tree;
 extern int print_table;
 extern int mem_size;
+extern int heap_size;
+extern int recursion_depth;
+extern int bounds_check;
+extern int guard_mode;
+extern int optim_flags;
+extern int optim_unroll;
+extern int time_passes;
 
 
 static void print_help()
 {
-    fprintf(stderr, "Utilisation: arc [-o outfile] [-d | --debug] "\
-            "[--print-tree] [--print-table] [-I dir] infile\n");
+    fprintf(stderr, "Utilisation: arc [-o outfile | -o outdir/] [-j N] "\
+            "[-d | --debug] [--print-tree] [--print-table] [-I dir] [--licm] "\
+            "[--strength-reduction] [--unroll=N] [--cse] [--dce] "\
+            "[-O0 | -O1 | -O2 | -Os] [--passes=p1,p2,...] [--time-passes] "\
+            "[--stats[=text|json]] [--cache[=dir]] [--bounds-check] "\
+            "[--guard] [--mem-size=size|auto] [--heap-size=N] "\
+            "[--recursion-depth=N] infile...\n");
     fprintf(stderr, "Consultez le man pour plus d'informations\n");
 }
 
@@ -26,15 +47,30 @@ static void print_help()
 void handle_options(int argc, char **argv)
 {
     int opt;
+    long factor;
+    char *end;
     const struct option options[] = {
         {"draw-tree", no_argument, NULL, 1},
         {"draw-table", optional_argument, NULL, 2},
         {"debug", no_argument, NULL, 'd'},
         {"mem-size", required_argument, NULL, 3},
+        {"licm", no_argument, NULL, 4},
+        {"strength-reduction", no_argument, NULL, 5},
+        {"unroll", required_argument, NULL, 6},
+        {"cse", no_argument, NULL, 7},
+        {"dce", no_argument, NULL, 8},
+        {"passes", required_argument, NULL, 9},
+        {"time-passes", no_argument, NULL, 10},
+        {"stats", optional_argument, NULL, 11},
+        {"cache", optional_argument, NULL, 12},
+        {"bounds-check", no_argument, NULL, 13},
+        {"guard", no_argument, NULL, 14},
+        {"heap-size", required_argument, NULL, 15},
+        {"recursion-depth", required_argument, NULL, 16},
         {NULL, 0, NULL, '\0'}
     };
 
-    while((opt = getopt_long(argc, argv, "I:o:d", options, NULL)) != -1)
+    while((opt = getopt_long(argc, argv, "I:o:dO::j:", options, NULL)) != -1)
     {
         switch (opt)
         {
@@ -45,13 +81,18 @@ void handle_options(int argc, char **argv)
             if (optarg[strlen(optarg) - 1] != '/') strcat(include_path, "/");
             break;
         case 'o':
-            exename = (char *) malloc(sizeof(char) * (strlen(optarg) + 1));
-            check_alloc(exename);
-            strcpy(exename, optarg);
+            output = (char *) malloc(sizeof(char) * (strlen(optarg) + 1));
+            check_alloc(output);
+            strcpy(output, optarg);
             break;
         case 'd':
             is_dbg_mode = 1;
             break;
+        case 'j':
+            /* -j 0: autant de processus que de processeurs */
+            nb_jobs = atoi(optarg);
+            if (nb_jobs <= 0) nb_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+            break;
         case 1:
             print_tree = 1;
             break;
@@ -59,7 +100,83 @@ void handle_options(int argc, char **argv)
             print_table = 1;
             break;
         case 3:
-            mem_size = atoi(optarg);
+            /* auto: calculée d'après le programme (voir init_mem_layout) */
+            if (strcmp(optarg, "auto") == 0) mem_size = MEM_SIZE_AUTO;
+            else mem_size = atoi(optarg);
+            break;
+        case 4:
+            optim_flags |= OPTIM_LICM;
+            break;
+        case 5:
+            optim_flags |= OPTIM_SR;
+            break;
+        case 6:
+            factor = strtol(optarg, &end, 10);
+            if (*optarg == '\0' || *end != '\0' || factor < 1
+                || factor > INT_MAX)
+            {
+                fatal_error("facteur de déroulage invalide: ~B--unroll=%s~E "\
+                            "(entier >= 1 attendu)", optarg);
+                exit(1);
+            }
+            optim_unroll = (int) factor;
+            optim_flags |= OPTIM_UNROLL;
+            break;
+        case 7:
+            optim_flags |= OPTIM_CSE;
+            break;
+        case 8:
+            optim_flags |= OPTIM_DCE;
+            break;
+        case 'O':
+            /* -O seul équivaut à -O1 */
+            if (!optim_set_level(optarg == NULL ? "1" : optarg))
+            {
+                fatal_error("niveau d'optimisation inconnu: ~B-O%s~E", optarg);
+                exit(1);
+            }
+            break;
+        case 9:
+            if (!optim_set_passes(optarg))
+            {
+                fatal_error("liste de passes invalide: ~B%s~E (passes "\
+                            "disponibles: bounds, licm, strength-reduction, "\
+                            "unroll, cse, dce)", optarg);
+                exit(1);
+            }
+            break;
+        case 10:
+            time_passes = 1;
+            break;
+        case 11:
+            if (optarg == NULL || strcmp(optarg, "text") == 0)
+            {
+                stats_format = STATS_TEXT;
+            }
+            else if (strcmp(optarg, "json") == 0) stats_format = STATS_JSON;
+            else
+            {
+                fatal_error("format de statistiques inconnu: ~B%s~E", optarg);
+                exit(1);
+            }
+            break;
+        case 12:
+            if (optarg == NULL) optarg = CACHE_DEFAULT_DIR;
+            cache_dir = (char *) malloc(sizeof(char) * (strlen(optarg) + 1));
+            check_alloc(cache_dir);
+            strcpy(cache_dir, optarg);
+            break;
+        case 13:
+            bounds_check = 1;
+            break;
+        case 14:
+            guard_mode = 1;
+            break;
+        case 15:
+            heap_size = atoi(optarg);
+            break;
+        case 16:
+            recursion_depth = atoi(optarg);
             break;
         default:
             print_help();
@@ -68,22 +185,83 @@ void handle_options(int argc, char **argv)
         }
     }
 
-    /* Le seul argument sans option doit être le fichier.algo */
+    /* Les arguments sans option sont les fichiers .algo à compiler */
     if (optind >= argc)
     {
         fatal_error("pas de fichier en entrée");
         exit(F_INPUT_ERROR);
     }
 
-    src = (char *) malloc(sizeof(char) * (strlen(argv[optind]) + 1));
-    check_alloc(src);
-    strcpy(src, argv[optind]);
+    input_files = argv + optind;
+    nb_input_files = argc - optind;
+}
+
+
+
+/**
+ * @brief Renvoie 1 si l'option -o désigne un répertoire: c'est un répertoire
+ * existant, ou elle se termine par un '/', ou plusieurs fichiers sont à
+ * compiler (le répertoire est alors créé s'il n'existe pas).
+ * 
+ * @return int 
+ */
+static int is_output_dir()
+{
+    struct stat st;
+
+    if (output == NULL) return 0;
+    if (stat(output, &st) == 0) return S_ISDIR(st.st_mode);
+    if (output[strlen(output) - 1] != '/' && nb_input_files == 1) return 0;
+
+    if (mkdir(output, 0755) != 0)
+    {
+        fatal_error("impossible de créer le répertoire ~U%s~E", output);
+        exit(F_INPUT_ERROR);
+    }
+
+    return 1;
+}
+
+
 
-    if (exename == NULL)
+/**
+ * @brief Renvoie le nom du fichier produit pour le fichier source `src` (à
+ * libérer).
+ * Avec un seul fichier en entrée, c'est le fichier donné par -o (a.out par
+ * défaut). Avec plusieurs fichiers, ou si -o désigne un répertoire, le fichier
+ * produit est placé dans ce répertoire (le répertoire courant par défaut) et
+ * porte le nom du fichier source avec l'extension .ram au lieu de .algo.
+ * 
+ * @param src 
+ * @return char* 
+ */
+char *get_output_name(const char *src)
+{
+    char *result;
+    int is_dir = is_output_dir();
+
+    if (nb_input_files == 1 && !is_dir)
     {
-        exename = (char *) malloc(sizeof(char) * (strlen("a.out") + 1));
-        check_alloc(exename);
-        strcpy(exename, "a.out");
+        const char *name = output == NULL ? "a.out" : output;
+        result = (char *) malloc(sizeof(char) * (strlen(name) + 1));
+        check_alloc(result);
+        strcpy(result, name);
+
+        return result;
     }
 
+    const char *dir = output == NULL ? "." : output;
+    const char *base = strrchr(src, '/') == NULL ? src : strrchr(src, '/') + 1;
+
+    /* Nom du fichier sans l'extension .algo */
+    int len = strlen(base);
+    if (len > 5 && strcmp(base + len - 5, ".algo") == 0) len -= 5;
+
+    result = (char *) malloc(sizeof(char) * (strlen(dir) + len + 6));
+    check_alloc(result);
+
+    const char *sep = dir[strlen(dir) - 1] == '/' ? "" : "/";
+    sprintf(result, "%s%s%.*s.ram", dir, sep, len, base);
+
+    return result;
 }
\ No newline at end of file
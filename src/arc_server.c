@@ -0,0 +1,384 @@
+#include "arc_server.h"
+#include "arc_utils.h"
+#include "preprocessor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <linux/limits.h>
+
+
+/*
+ * Protocole (les entiers sont des int, client et serveur étant sur la même
+ * machine):
+ * requête: répertoire courant, argc, puis les argc arguments (chaque chaîne
+ * est précédée de sa longueur)
+ * réponse: code de retour, puis la sortie standard et la sortie d'erreur
+ * (chacune précédée de sa longueur)
+ */
+
+
+/* Chemin du socket, supprimé à l'arrêt du serveur */
+static const char *server_path = NULL;
+
+
+
+/**
+ * @brief Écrit les n octets de buff dans fd.
+ *
+ * @param fd
+ * @param buff
+ * @param n
+ * @return int 0 si la connexion est coupée, 1 sinon
+ */
+static int write_all(int fd, const void *buff, size_t n)
+{
+    const char *p = (const char *) buff;
+    ssize_t w;
+
+    while (n > 0)
+    {
+        if ((w = write(fd, p, n)) <= 0) return 0;
+        p += w;
+        n -= w;
+    }
+
+    return 1;
+}
+
+
+
+/**
+ * @brief Lit exactement n octets de fd dans buff.
+ *
+ * @param fd
+ * @param buff
+ * @param n
+ * @return int 0 si la connexion est coupée, 1 sinon
+ */
+static int read_all(int fd, void *buff, size_t n)
+{
+    char *p = (char *) buff;
+    ssize_t r;
+
+    while (n > 0)
+    {
+        if ((r = read(fd, p, n)) <= 0) return 0;
+        p += r;
+        n -= r;
+    }
+
+    return 1;
+}
+
+
+
+static int send_int(int fd, int n)
+{
+    return write_all(fd, &n, sizeof(int));
+}
+
+
+
+static int send_str(int fd, const char *s)
+{
+    int len = strlen(s);
+    return send_int(fd, len) && write_all(fd, s, len);
+}
+
+
+
+/**
+ * @brief Lit une chaîne envoyée par send_str (à libérer).
+ *
+ * @param fd
+ * @return char* NULL si la connexion est coupée
+ */
+static char *recv_str(int fd)
+{
+    int len;
+    if (!read_all(fd, &len, sizeof(int)) || len < 0) return NULL;
+
+    char *s = (char *) malloc(sizeof(char) * (len + 1));
+    check_alloc(s);
+
+    if (!read_all(fd, s, len))
+    {
+        free(s);
+        return NULL;
+    }
+    s[len] = '\0';
+
+    return s;
+}
+
+
+
+/**
+ * @brief Envoie le contenu du fichier temporaire fp (précédé de sa taille),
+ * puis le ferme.
+ *
+ * @param fd
+ * @param fp
+ * @return int 0 si la connexion est coupée, 1 sinon
+ */
+static int send_file(int fd, FILE *fp)
+{
+    char buff[4096];
+    size_t n;
+    int ok;
+
+    fseek(fp, 0, SEEK_END);
+    ok = send_int(fd, ftell(fp));
+    rewind(fp);
+
+    while (ok && (n = fread(buff, sizeof(char), sizeof(buff), fp)) > 0)
+    {
+        ok = write_all(fd, buff, n);
+    }
+    fclose(fp);
+
+    return ok;
+}
+
+
+
+/**
+ * @brief Recopie dans dest les données envoyées par send_file.
+ *
+ * @param fd
+ * @param dest
+ * @return int 0 si la connexion est coupée, 1 sinon
+ */
+static int recv_file(int fd, FILE *dest)
+{
+    char buff[4096];
+    int len, n;
+
+    if (!read_all(fd, &len, sizeof(int))) return 0;
+
+    while (len > 0)
+    {
+        n = len < (int) sizeof(buff) ? len : (int) sizeof(buff);
+        if (!read_all(fd, buff, n)) return 0;
+        fwrite(buff, sizeof(char), n, dest);
+        len -= n;
+    }
+
+    return 1;
+}
+
+
+
+/**
+ * @brief Crée le socket de nom path (connecté au serveur si is_client vaut 1,
+ * en attente de connexions sinon).
+ *
+ * @param path
+ * @param is_client
+ * @return int Le descripteur du socket, -1 en cas d'erreur
+ */
+static int open_socket(const char *path, int is_client)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) return -1;
+
+    if (is_client)
+    {
+        if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) == 0)
+        {
+            return fd;
+        }
+    }
+    else
+    {
+        /* Socket laissé par un serveur précédent */
+        unlink(path);
+        if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) == 0
+            && listen(fd, 16) == 0) return fd;
+    }
+
+    close(fd);
+    return -1;
+}
+
+
+
+/**
+ * @brief Traite la requête reçue sur fd: la compilation a lieu dans un
+ * processus fils, dont les sorties sont renvoyées au client.
+ *
+ * @param fd
+ * @param request
+ */
+static void handle_request(int fd, int (*request)(int, char **))
+{
+    char *cwd = recv_str(fd);
+    int i, argc;
+
+    if (cwd == NULL || !read_all(fd, &argc, sizeof(int)) || argc < 0) exit(1);
+
+    /* argv[0] pour getopt, et NULL à la fin comme pour main */
+    char **argv = (char **) malloc(sizeof(char *) * (argc + 2));
+    check_alloc(argv);
+    argv[0] = "arc";
+    for (i = 1; i <= argc; i++)
+    {
+        if ((argv[i] = recv_str(fd)) == NULL) exit(1);
+    }
+    argv[argc + 1] = NULL;
+
+    FILE *out = tmpfile();
+    check_alloc(out);
+    FILE *err = tmpfile();
+    check_alloc(err);
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        perror("fork");
+        exit(1);
+    }
+
+    if (pid == 0)
+    {
+        dup2(fileno(out), STDOUT_FILENO);
+        dup2(fileno(err), STDERR_FILENO);
+
+        if (chdir(cwd) != 0)
+        {
+            fatal_error("impossible d'accéder au répertoire ~U%s~E", cwd);
+            exit(1);
+        }
+
+        exit(request(argc + 1, argv));
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+
+    send_int(fd, WIFEXITED(status) ? WEXITSTATUS(status) : 1);
+    send_file(fd, out);
+    send_file(fd, err);
+}
+
+
+
+static void stop_server(int sig)
+{
+    (void) sig;
+
+    unlink(server_path);
+    exit(0);
+}
+
+
+
+/**
+ * @brief Lance le serveur sur le socket socket_path. Chaque requête est
+ * traitée dans un processus fils, qui hérite de la librairie standard déjà
+ * lue (voir preload_includes).
+ *
+ * @param socket_path
+ * @param request La fonction compilant comme arc lancé avec (argc, argv)
+ * @return int
+ */
+int run_server(const char *socket_path, int (*request)(int, char **))
+{
+    int fd = open_socket(socket_path, 0);
+    if (fd == -1)
+    {
+        fatal_error("impossible de créer le socket ~U%s~E", socket_path);
+        perror("");
+        return 1;
+    }
+
+    server_path = socket_path;
+    signal(SIGINT, stop_server);
+    signal(SIGTERM, stop_server);
+
+    /* Un client qui se déconnecte ne doit pas arrêter le serveur */
+    signal(SIGPIPE, SIG_IGN);
+
+    /* Les processus des requêtes terminées sont supprimés automatiquement */
+    signal(SIGCHLD, SIG_IGN);
+
+    preload_includes();
+
+    int client;
+    while (1)
+    {
+        if ((client = accept(fd, NULL, NULL)) == -1) continue;
+
+        fflush(stdout);
+        fflush(stderr);
+
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(fd);
+            signal(SIGINT, SIG_DFL);
+            signal(SIGTERM, SIG_DFL);
+            signal(SIGCHLD, SIG_DFL);
+            handle_request(client, request);
+            close(client);
+            exit(0);
+        }
+
+        if (pid == -1) perror("fork");
+        close(client);
+    }
+
+    return 0;
+}
+
+
+
+/**
+ * @brief Envoie la ligne de commande (sans --client socket) au serveur et
+ * affiche le résultat de la compilation.
+ *
+ * @param socket_path
+ * @param argc
+ * @param argv
+ * @return int Le code de retour de la compilation
+ */
+int run_client(const char *socket_path, int argc, char **argv)
+{
+    int fd = open_socket(socket_path, 1);
+    if (fd == -1)
+    {
+        fatal_error("impossible de se connecter au serveur ~U%s~E",
+                    socket_path);
+        return 1;
+    }
+
+    char cwd[PATH_MAX];
+    if (getcwd(cwd, PATH_MAX) == NULL) strcpy(cwd, ".");
+
+    int i, status = 1, ok = send_str(fd, cwd) && send_int(fd, argc);
+    for (i = 0; ok && i < argc; i++) ok = send_str(fd, argv[i]);
+
+    ok = ok && read_all(fd, &status, sizeof(int)) && recv_file(fd, stdout)
+         && recv_file(fd, stderr);
+    close(fd);
+
+    if (!ok)
+    {
+        fatal_error("connexion au serveur ~U%s~E interrompue", socket_path);
+        return 1;
+    }
+
+    return status;
+}
@@ -0,0 +1,200 @@
+#include "arc_stats.h"
+#include "arc_utils.h"
+#include "arc_context.h"
+#include "arc_cache.h"
+#include <stdio.h>
+#include <sys/resource.h>
+
+
+/* Noms des phases (dans l'ordre de compiler_phase) */
+static const char *phase_names[NB_PHASES] = {
+    "preprocessor", "yyparse", "optimize", "semantic", "second_turn_semantic",
+    "codegen"
+};
+
+
+/* Noms des types de noeuds (dans l'ordre de node_type) */
+static const char *node_names[NB_NODE_TYPES] = {
+    "nb_type", "b_op_type", "u_op_type", "id_type", "affect_type",
+    "instr_type", "decla_type", "var_decla_type", "prog_type",
+    "func_decla_type", "while_type", "if_type", "io_type", "func_call_type",
+    "exp_list_type", "do_while_type", "return_type", "for_type",
+    "array_access_type", "array_decla_type", "alloc_type", "proto_type",
+    "inc_type", "free_type", "switch_type", "case_type",
+    "block_type"
+};
+
+
+static double phase_begin[NB_PHASES];
+static double phase_time[NB_PHASES];
+static unsigned long phase_alloc_begin[NB_PHASES];
+static unsigned long phase_alloc[NB_PHASES];
+
+
+
+/**
+ * @brief Début de la phase `p` de la compilation.
+ * 
+ * @param p 
+ */
+void phase_start(compiler_phase p)
+{
+    phase_begin[p] = get_time_ms();
+    phase_alloc_begin[p] = nb_alloc;
+}
+
+
+
+/**
+ * @brief Fin de la phase `p`: enregistre sa durée et le nombre d'allocations
+ * faites pendant la phase (et affiche la durée si --time-passes est donné).
+ * 
+ * @param p 
+ */
+void phase_end(compiler_phase p)
+{
+    phase_time[p] = get_time_ms() - phase_begin[p];
+    phase_alloc[p] = nb_alloc - phase_alloc_begin[p];
+
+    report_pass_time(phase_names[p], phase_begin[p]);
+}
+
+
+
+/**
+ * @brief Renvoie le pic de mémoire utilisée par le processus (en Ko).
+ * 
+ * @return long 
+ */
+static long peak_rss()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+
+    return usage.ru_maxrss;
+}
+
+
+/**
+ * @brief Renvoie le nombre d'allocations faites pendant la compilation du
+ * fichier (le compteur nb_alloc n'est pas remis à zéro d'un fichier à
+ * l'autre).
+ * 
+ * @return unsigned long 
+ */
+static unsigned long total_alloc()
+{
+    unsigned long total = 0;
+    int i;
+    for (i = 0; i < NB_PHASES; i++) total += phase_alloc[i];
+
+    return total;
+}
+
+
+static int nb_symbols(context *c)
+{
+    int n = 0;
+    symbol *s;
+    for (s = c->symb_list; s != NULL; s = s->next) n++;
+
+    return n;
+}
+
+
+static void print_stats_text(int *nodes, symb_table table, int nb_instr)
+{
+    int i, total = 0;
+    context *c;
+
+    fprintf(stderr, "%-24s %12s %12s\n", "Phase", "Temps (ms)", "Allocations");
+    for (i = 0; i < NB_PHASES; i++)
+    {
+        fprintf(stderr, "%-24s %12.3f %12lu\n", phase_names[i], phase_time[i],
+                phase_alloc[i]);
+    }
+    fprintf(stderr, "%-24s %12s %12lu\n", "total", "", total_alloc());
+
+    fprintf(stderr, "\nPic de mémoire (RSS): %ld Ko\n", peak_rss());
+
+    for (i = 0; i < NB_NODE_TYPES; i++) total += nodes[i];
+    fprintf(stderr, "\nNoeuds de l'ASA: %d\n", total);
+    for (i = 0; i < NB_NODE_TYPES; i++)
+    {
+        if (nodes[i] != 0)
+        {
+            fprintf(stderr, "    %-20s %8d\n", node_names[i], nodes[i]);
+        }
+    }
+
+    fprintf(stderr, "\nSymboles par contexte:\n");
+    for (c = table; c != NULL; c = c->next)
+    {
+        fprintf(stderr, "    %-20s %8d\n", c->name, nb_symbols(c));
+    }
+
+    fprintf(stderr, "\nInstructions RAM produites: %d\n", nb_instr);
+
+    if (cache_dir != NULL)
+    {
+        int hits = cache_nb_hits(), total = hits + cache_nb_misses();
+        fprintf(stderr, "\nCache des fonctions: %d/%d réutilisées (%.1f %%)\n",
+                hits, total, total == 0 ? 0.0 : 100.0 * hits / total);
+    }
+}
+
+
+static void print_stats_json(int *nodes, symb_table table, int nb_instr)
+{
+    int i;
+    context *c;
+
+    fprintf(stderr, "{\n    \"file\": \"%s\",\n    \"phases\": [\n", arc_ctx.src);
+    for (i = 0; i < NB_PHASES; i++)
+    {
+        fprintf(stderr, "        {\"name\": \"%s\", \"time_ms\": %.3f, "\
+                "\"allocs\": %lu}%s\n", phase_names[i], phase_time[i],
+                phase_alloc[i], i == NB_PHASES - 1 ? "" : ",");
+    }
+    fprintf(stderr, "    ],\n    \"allocs\": %lu,\n", total_alloc());
+    fprintf(stderr, "    \"peak_rss_kb\": %ld,\n", peak_rss());
+
+    fprintf(stderr, "    \"ast_nodes\": {\n");
+    for (i = 0; i < NB_NODE_TYPES; i++)
+    {
+        fprintf(stderr, "        \"%s\": %d%s\n", node_names[i], nodes[i],
+                i == NB_NODE_TYPES - 1 ? "" : ",");
+    }
+
+    fprintf(stderr, "    },\n    \"symbols\": {\n");
+    for (c = table; c != NULL; c = c->next)
+    {
+        fprintf(stderr, "        \"%s\": %d%s\n", c->name, nb_symbols(c),
+                c->next == NULL ? "" : ",");
+    }
+
+    fprintf(stderr, "    },\n    \"instructions\": %d,\n", nb_instr);
+    fprintf(stderr, "    \"cache\": {\"hits\": %d, \"misses\": %d}\n}\n",
+            cache_nb_hits(), cache_nb_misses());
+}
+
+
+
+/**
+ * @brief Affiche (sur la sortie d'erreur) les statistiques de la compilation:
+ * durée et nombre d'allocations de chaque phase, pic de mémoire, nombre de
+ * noeuds de l'ASA par type, nombre de symboles par contexte et nombre
+ * d'instructions RAM produites.
+ * 
+ * @param tree L'ASA
+ * @param table La table des symboles
+ * @param nb_instr Le nombre d'instructions produites
+ */
+void print_stats(ast *tree, symb_table table, int nb_instr)
+{
+    int nodes[NB_NODE_TYPES] = {0};
+    count_nodes(tree, nodes);
+
+    if (stats_format == STATS_JSON) print_stats_json(nodes, table, nb_instr);
+    else print_stats_text(nodes, table, nb_instr);
+}
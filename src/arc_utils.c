@@ -1,270 +1,63 @@
 #include "arc_utils.h"
+#include "arc_context.h"
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 
 
-struct error_info INFOS;
-extern FILE *yyin;
+/* Nombre d'allocations réussies (comptées par check_alloc, voir --stats) */
+unsigned long nb_alloc = 0;
+extern int time_passes;
 
 
 /**
- * @brief Retourne un string qui contiendra les séquences d'échappement ANSI
- * correspondant aux formats spécifiés:
- * ~r pour afficher en rouge (~g, ~b, ~y, etc. pour les autres couleurs)
- * ~B et ~U pour afficher en gras et souligné.
- * ~E pour stopper la séquence.
- * 
- * @param fmt 
- * @return char* 
- */
-static char *ansi_fmt(const char *fmt)
-{
-    size_t size = 1024;
-    char *result = (char *) calloc((size + 1), sizeof(char));
-    check_alloc(result);
-
-    char buff[16] = "";
-    size_t i = 0, c_size = 0;
-    while (fmt[i] != '\0')
-    {
-        /* Gestion des formats gérant les séquences d'échappement */
-        if (fmt[i] == '~' && fmt[i + 1] != '\0')
-        {
-            /* "\033[...m" -> 3 char et au + 2 char (0m ou 31, 32, 33, etc.) */
-            if (c_size + 3 + 2 >= size)
-            {
-                size = size << 1;
-                result = (char *) realloc(result, sizeof(char) * (size + 1));
-                check_alloc(result);
-            }
-
-            c_size += 3;
-            i++;
-            switch (fmt[i])
-            {
-            case 'r':
-                c_size += 2;
-                sprintf(buff, "\033[%dm", RED);
-                break;
-            case 'g':
-                c_size += 2;
-                sprintf(buff, "\033[%dm", GREEN);
-                break;
-            case 'y':
-                c_size += 2;
-                sprintf(buff, "\033[%dm", YELLOW);
-                break;
-            case 'b':
-                c_size += 2;
-                sprintf(buff, "\033[%dm", BLUE);
-                break;
-            case 'm':
-                c_size += 2;
-                sprintf(buff, "\033[%dm", MAGENTA);
-                break;
-            case 'c':
-                c_size += 2;
-                sprintf(buff, "\033[%dm", CYAN);
-                break;
-            case 'B':
-                c_size++;
-                sprintf(buff, "\033[1m");
-                break;
-            case 'U':
-                c_size++;
-                sprintf(buff, "\033[4m");
-                break;
-            case 'E':
-                c_size++;
-                sprintf(buff, "\033[0m");
-                break;
-            default:
-                c_size++;
-                buff[0] = fmt[i];
-                buff[1] = '\0';
-                break;
-            }
-            strcat(result, buff);
-        }
-        else
-        {
-            if (c_size + 1 >= size)
-            {
-                size = size << 1;
-                result = (char *) realloc(result, sizeof(char) * (size + 1));
-                check_alloc(result);
-            }
-
-            result[c_size] = fmt[i];
-            c_size++;
-        }
-        i++;
-    }
-
-    return result;
-}
-
-
-/**
- * @brief Retourne la nième ligne du fichier passé en paramètre
- * 
- * @param fp 
- * @param n 
- * @return char* 
- */
-static char *get_nth_line(FILE *fp, int n)
-{
-    long old_cur = ftell(fp);
-    rewind(fp);
-
-    int i = 0;
-    char *res = (char *) calloc(4096, sizeof(char));
-    check_alloc(res);
-
-    while (i < n)
-    {
-        fgets(res, 4095, fp);
-        i++;
-    }
-
-    fseek(fp, old_cur, SEEK_SET);
-    return res;
-}
-
-
-
-/**
- * @brief Affiche une erreur formatée, préfixée du message "erreur fatale" en
- * rouge et en gras.
- * Si set_error_infos a été utilisée, affiche la position de l'erreur (BUG)
+ * @brief Affiche une erreur formatée, précédée des diagnostics en attente et
+ * préfixée du message "erreur fatale" en rouge et en gras.
+ * Si set_error_infos a été utilisée, affiche la position de l'erreur.
+ * Les formats ~r, ~B, ~E, etc. sont décrits dans arc_diag.c (ansi_fmt).
  * 
  * @param fmt 
  * @param ... 
  */
 void fatal_error(char *fmt, ...)
 {
-    if (INFOS.has_info)
-    {
-        // printf("first column: %d, last: %d\n", INFOS.loc.first_column, INFOS.loc.last_column);
-        fprintf(stderr, "\033[1m%s:%d:%d:\033[0m ", src, INFOS.loc.first_line,
-                INFOS.loc.first_column);
-        
-        fprintf(stderr, "\033[31;1merreur fatale:\033[0m ");
-    
-        /* On se le permet car fmt n'est pas réutilisé après */
-        fmt = ansi_fmt(fmt);
-
-        va_list arglist;
-        va_start(arglist, fmt);
-        vfprintf(stderr, fmt, arglist);
-        va_end(arglist);
-
-        fprintf(stderr, "\n");
-        free(fmt);
-
-        char *buff = get_nth_line(yyin, INFOS.loc.first_line);
-
-        char line_info[128];
-        sprintf(line_info, " %d |", INFOS.loc.first_line);
-
-        fprintf(stderr, "%s %s", line_info, buff);
-        for (size_t i = 0; i < strlen(line_info) - 1; i++) fprintf(stderr, " ");
-        fprintf(stderr, "|");
-
-        int i;
-        for (i = 0; i < INFOS.loc.first_column; i++) fprintf(stderr, " ");
-        fprintf(stderr, "\033[31m^");
-        for (i = i + 1; i < INFOS.loc.last_column; i++) fprintf(stderr, "~");
-        fprintf(stderr, "\033[0m\n");
-        
-        free(buff);
-        unset_error_info();
-        return;
-    }
-
-    fprintf(stderr, "\033[31;1merreur fatale:\033[0m ");
-    
-    /* On se le permet car fmt n'est pas réutilisé après */
-    fmt = ansi_fmt(fmt);
-
     va_list arglist;
     va_start(arglist, fmt);
-    vfprintf(stderr, fmt, arglist);
+    diag_add(&arc_ctx.diags, DIAG_ERROR, fmt, arglist);
     va_end(arglist);
 
-    fprintf(stderr, "\n");
-    free(fmt);
+    diag_flush(&arc_ctx.diags);
 }
 
 
+/**
+ * @brief Ajoute un warning, affiché avec les autres diagnostics de la
+ * compilation (voir diag_flush).
+ * 
+ * @param fmt 
+ * @param ... 
+ */
 void warning(char *fmt, ...)
 {
-    if (INFOS.has_info)
-    {
-        // printf("first column: %d, last: %d\n", INFOS.loc.first_column, INFOS.loc.last_column);
-        fprintf(stderr, "\033[1m%s:%d:%d:\033[0m ", src, INFOS.loc.first_line,
-                INFOS.loc.first_column);
-        
-        fprintf(stderr, "\033[35;1mwarning:\033[0m ");
-    
-        /* On se le permet car fmt n'est pas réutilisé après */
-        fmt = ansi_fmt(fmt);
-
-        va_list arglist;
-        va_start(arglist, fmt);
-        vfprintf(stderr, fmt, arglist);
-        va_end(arglist);
-
-        fprintf(stderr, "\n");
-        free(fmt);
-
-        char *buff = get_nth_line(yyin, INFOS.loc.first_line);
-
-        char line_info[128];
-        sprintf(line_info, " %d |", INFOS.loc.first_line);
-
-        fprintf(stderr, "%s %s", line_info, buff);
-        for (size_t i = 0; i < strlen(line_info) - 1; i++) fprintf(stderr, " ");
-        fprintf(stderr, "|");
-
-        int i;
-        for (i = 0; i < INFOS.loc.first_column; i++) fprintf(stderr, " ");
-        fprintf(stderr, "\033[35m^");
-        for (i = i + 1; i < INFOS.loc.last_column; i++) fprintf(stderr, "~");
-        fprintf(stderr, "\033[0m\n");
-        
-        free(buff);
-        unset_error_info();
-        return;
-    }
-
-    fprintf(stderr, "\033[35;1mwarning:\033[0m ");
-
-    /* On se le permet car fmt n'est pas réutilisé après */
-    fmt = ansi_fmt(fmt);
-
     va_list arglist;
     va_start(arglist, fmt);
-    vfprintf(stderr, fmt, arglist);
+    diag_add(&arc_ctx.diags, DIAG_WARNING, fmt, arglist);
     va_end(arglist);
-
-    fprintf(stderr, "\n");
-    free(fmt);
 }
 
 
 void set_error_info(YYLTYPE infos)
 {
-    INFOS.loc = infos;
-    INFOS.has_info = 1;
+    arc_ctx.diags.loc = infos;
+    arc_ctx.diags.has_info = 1;
 }
 
 void unset_error_info()
 {
-    INFOS.has_info = 0;
+    arc_ctx.diags.has_info = 0;
 }
 
 
@@ -341,7 +134,7 @@ void colored_error(int esc_seq, int exit_code, char *fmt, ...)
 
 /**
  * @brief À appeler à la suite d'un malloc/calloc/realloc.
- * Quitte le programme si le pointeur est NULL.
+ * Quitte le programme si le pointeur est NULL, sinon compte l'allocation.
  * 
  * @param ptr 
  */
@@ -353,6 +146,8 @@ inline void check_alloc(void *ptr)
         perror("");     /* Pour afficher + d'infos */
         exit(ALLOC_FAILED);
     }
+
+    nb_alloc++;
 }
 
 
@@ -391,4 +186,34 @@ void op_to_str(char *dest, int op)
         dest[1] = '\0';
         break;
     }
-}
\ No newline at end of file
+}
+
+
+/**
+ * @brief Renvoie le temps écoulé (en millisecondes) depuis un instant
+ * arbitraire. Sert à mesurer la durée des passes du compilateur.
+ * 
+ * @return double 
+ */
+double get_time_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+
+
+/**
+ * @brief Affiche la durée d'une passe si l'option --time-passes est donnée.
+ * 
+ * @param name Le nom de la passe
+ * @param start Le temps au début de la passe (voir get_time_ms)
+ */
+void report_pass_time(const char *name, double start)
+{
+    if (!time_passes) return;
+
+    fprintf(stderr, "%-24s %10.3f ms\n", name, get_time_ms() - start);
+}
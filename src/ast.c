@@ -1,6 +1,7 @@
 #include "ast.h"
 #include "arc_utils.h"
 #include "parser.h"         /* Pour yyloc */
+#include "arc_context.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -23,10 +24,7 @@ ast *init_ast(node_type type)
     t->mem_adr = -1;
     t->codelen = 0;
 
-    t->pos_infos.first_line = yylloc.first_line - line_offset;
-    t->pos_infos.last_line = yylloc.last_line - line_offset;
-    t->pos_infos.first_column = yylloc.first_column;
-    t->pos_infos.last_column = yylloc.last_column;
+    t->pos_infos = diag_src_loc(yylloc);
 
 
     return t;
@@ -289,6 +287,63 @@ ast *create_if_node(ast *expr, ast *l_instr1, ast *l_instr2)
 }
 
 
+ast *create_switch_node(ast *expr, ast *cases, ast *l_instr)
+{
+    ast *t = init_ast(switch_type);
+    t->switch_n.expr = expr;
+    t->switch_n.cases = cases;
+    t->switch_n.default_instr = l_instr;
+
+    return t;
+}
+
+
+/**
+ * @brief Crée le noeud du CAS val et l'ajoute à la fin de la liste de CAS l.
+ * 
+ * @param val 
+ * @param l_instr 
+ * @param l 
+ * @return ast* La liste de CAS
+ */
+ast *create_case_node(int val, ast *l_instr, ast *l)
+{
+    ast *t = init_ast(case_type);
+    t->case_n.val = val;
+    t->case_n.list_instr = l_instr;
+
+    if (l == NULL) return t;
+
+    ast *aux = l;
+    while (aux->case_n.next != NULL) aux = aux->case_n.next;
+    aux->case_n.next = t;
+
+    return l;
+}
+
+
+/**
+ * @brief Crée le noeud de COPIER (op = 'c', src est l'identifiant du tableau
+ * source) ou de REMPLIR (op = 'f', src est la valeur écrite).
+ * 
+ * @param op 
+ * @param dst 
+ * @param src 
+ * @param size 
+ * @return ast* 
+ */
+ast *create_block_node(char op, char *dst, ast *src, ast *size)
+{
+    ast *t = init_ast(block_type);
+    t->block.op = op;
+    t->block.dst = create_id_leaf(dst);
+    t->block.src = src;
+    t->block.size = size;
+
+    return t;
+}
+
+
 ast *create_for_node(char *id, ast *start_exp, ast *end_exp, ast *l_instr)
 {
     ast *t = init_ast(for_type);
@@ -320,6 +375,24 @@ ast *create_io_node(ast *expr, char m)
 }
 
 
+/**
+ * @brief Crée le noeud de LIRE_TABLEAU (m = 'R') ou d'ECRIRE_TABLEAU
+ * (m = 'W'): les `size` premières cases du tableau `id` sont lues ou écrites.
+ * 
+ * @param id 
+ * @param size 
+ * @param m 
+ * @return ast* 
+ */
+ast *create_io_tab_node(char *id, ast *size, char m)
+{
+    ast *t = create_io_node(size, m);
+    t->io.id = create_id_leaf(id);
+
+    return t;
+}
+
+
 ast *create_exp_list_node(ast *expr, ast *next)
 {
     ast *t = init_ast(exp_list_type);
@@ -380,6 +453,52 @@ ast *create_arr_access_node(char *id, ast *ind_expr, ast *aff_expr)
 }
 
 
+/**
+ * @brief Créé le noeud de l'accès T[row_expr][col_expr] à un tableau à 2
+ * dimensions (voir flatten_arr_access).
+ * 
+ * @param id 
+ * @param row_expr 
+ * @param col_expr 
+ * @param aff_expr 
+ * @return ast* 
+ */
+ast *create_md_arr_access_node(char *id, ast *row_expr, ast *col_expr,
+                               ast *aff_expr)
+{
+    ast *t = create_arr_access_node(id, row_expr, aff_expr);
+    t->arr_access.col_expr = col_expr;
+
+    return t;
+}
+
+
+/**
+ * @brief Remplace l'accès T[i][j] au tableau `t` de `nb_cols` colonnes par
+ * l'accès T[i * nb_cols + j].
+ * L'adresse de la ligne (i * nb_cols) est alors sortie des boucles sur j par
+ * les optimisations (voir optim_licm et optim_strength_reduction).
+ * 
+ * @param t 
+ * @param nb_cols 
+ */
+void flatten_arr_access(ast *t, int nb_cols)
+{
+    array_access_node *node = &t->arr_access;
+    if (node->col_expr == NULL) return;
+
+    ast *cols = create_nb_leaf(nb_cols);
+    cols->pos_infos = node->col_expr->pos_infos;
+
+    ast *row = create_b_op_node('*', node->ind_expr, cols);
+    row->pos_infos = node->ind_expr->pos_infos;
+
+    node->ind_expr = create_b_op_node('+', row, node->col_expr);
+    node->ind_expr->pos_infos = row->pos_infos;
+    node->col_expr = NULL;
+}
+
+
 /**
  * @brief Créé le noeud représentant une déclaration de tableau.
  * Soit: @tab (taille indéfinie)
@@ -403,6 +522,26 @@ ast *create_arr_decla_node(char *id, int size, ast *l_exp)
 }
 
 
+/**
+ * @brief Créé le noeud de la déclaration du tableau tab[rows][cols], rangé
+ * comme un tableau de rows * cols cases (ligne après ligne). L'éventuelle
+ * initialisation donne ces rows * cols cases dans le même ordre.
+ * 
+ * @param id 
+ * @param rows 
+ * @param cols 
+ * @param l_exp 
+ * @return ast* 
+ */
+ast *create_md_arr_decla_node(char *id, int rows, int cols, ast *l_exp)
+{
+    ast *t = create_arr_decla_node(id, rows * cols, l_exp);
+    t->arr_decla.nb_cols = cols;
+
+    return t;
+}
+
+
 
 ast *create_alloc_node(char *id, ast *expr)
 {
@@ -416,6 +555,24 @@ ast *create_alloc_node(char *id, ast *expr)
 
 
 
+/**
+ * @brief Crée un noeud ALLOUER_LOCAL: le bloc alloué (et tout ce qui est
+ * alloué après lui) est rendu au tas au retour de la fonction.
+ * 
+ * @param id 
+ * @param expr 
+ * @return ast* 
+ */
+ast *create_local_alloc_node(char *id, ast *expr)
+{
+    ast *t = create_alloc_node(id, expr);
+    t->alloc.is_local = 1;
+
+    return t;
+}
+
+
+
 ast *create_proto_node(char *id, ast *params)
 {
     ast *t = init_ast(proto_type);
@@ -437,6 +594,39 @@ ast *create_proto_node(char *id, ast *params)
 
 
 
+/**
+ * @brief Créé le noeud incrémentant de 1 la variable `id`.
+ * Utilisé uniquement par les optimisations.
+ * 
+ * @param id 
+ * @return ast* 
+ */
+ast *create_inc_node(const char *id)
+{
+    ast *t = init_ast(inc_type);
+    t->inc.id = create_id_leaf(id);
+
+    return t;
+}
+
+
+
+/**
+ * @brief Créé le noeud libérant le bloc pointé par `id` (LIBERER).
+ * 
+ * @param id 
+ * @return ast* 
+ */
+ast *create_free_node(const char *id)
+{
+    ast *t = init_ast(free_type);
+    t->free_n.id = create_id_leaf(id);
+
+    return t;
+}
+
+
+
 
 /**
  * @brief Libère la mémoire utilisée par l'ASA.
@@ -492,6 +682,20 @@ void free_ast(ast *t)
         free_ast(t->if_n.list_instr1);
         free_ast(t->if_n.list_instr2);
         break;
+    case switch_type:
+        free_ast(t->switch_n.expr);
+        free_ast(t->switch_n.cases);
+        free_ast(t->switch_n.default_instr);
+        break;
+    case case_type:
+        free_ast(t->case_n.list_instr);
+        free_ast(t->case_n.next);
+        break;
+    case block_type:
+        free_ast(t->block.dst);
+        free_ast(t->block.src);
+        free_ast(t->block.size);
+        break;
     case do_while_type:
         free_ast(t->do_while.expr);
         free_ast(t->do_while.list_instr);
@@ -514,11 +718,13 @@ void free_ast(ast *t)
         break;
     case io_type:
         free_ast(t->io.expr);
+        free_ast(t->io.id);
         break;
     case array_access_type:
         free_ast(t->arr_access.id);
         free_ast(t->arr_access.ind_expr);
         free_ast(t->arr_access.affect_expr);
+        free_ast(t->arr_access.col_expr);
         break;
     case array_decla_type:
         free_ast(t->arr_decla.id);
@@ -532,6 +738,12 @@ void free_ast(ast *t)
         free_ast(t->proto.id);
         free_ast(t->proto.params);
         break;
+    case inc_type:
+        free_ast(t->inc.id);
+        break;
+    case free_type:
+        free_ast(t->free_n.id);
+        break;
     default:
         break;
     }
@@ -541,6 +753,268 @@ void free_ast(ast *t)
 
 
 
+/**
+ * @brief Compte les noeuds de l'ASA par type de noeud.
+ * La variable d'un POUR est partagée avec sa condition (voir create_for_node),
+ * elle n'est comptée qu'une fois.
+ * 
+ * @param t 
+ * @param count Tableau de NB_NODE_TYPES entiers, incrémentés par la fonction
+ */
+void count_nodes(ast *t, int *count)
+{
+    if (t == NULL) return;
+
+    count[t->type]++;
+
+    switch (t->type)
+    {
+    case b_op_type:
+        count_nodes(t->b_op.l_memb, count);
+        count_nodes(t->b_op.r_memb, count);
+        break;
+    case u_op_type:
+        count_nodes(t->u_op.child, count);
+        break;
+    case instr_type:
+        count_nodes(t->list_instr.instr, count);
+        count_nodes(t->list_instr.next, count);
+        break;
+    case affect_type:
+        count_nodes(t->affect.id, count);
+        count_nodes(t->affect.expr, count);
+        break;
+    case decla_type:
+        count_nodes(t->decla_list.decla, count);
+        count_nodes(t->decla_list.next, count);
+        break;
+    case var_decla_type:
+        count_nodes(t->var_decla.expr, count);
+        count_nodes(t->var_decla.var, count);
+        count_nodes(t->var_decla.next, count);
+        break;
+    case prog_type:
+        count_nodes(t->root.list_decl, count);
+        count_nodes(t->root.main_prog, count);
+        break;
+    case func_decla_type:
+        count_nodes(t->func_decla.id, count);
+        count_nodes(t->func_decla.list_decl, count);
+        count_nodes(t->func_decla.list_instr, count);
+        count_nodes(t->func_decla.params, count);
+        break;
+    case while_type:
+        count_nodes(t->while_n.expr, count);
+        count_nodes(t->while_n.list_instr, count);
+        break;
+    case if_type:
+        count_nodes(t->if_n.expr, count);
+        count_nodes(t->if_n.list_instr1, count);
+        count_nodes(t->if_n.list_instr2, count);
+        break;
+    case switch_type:
+        count_nodes(t->switch_n.expr, count);
+        count_nodes(t->switch_n.cases, count);
+        count_nodes(t->switch_n.default_instr, count);
+        break;
+    case case_type:
+        count_nodes(t->case_n.list_instr, count);
+        count_nodes(t->case_n.next, count);
+        break;
+    case block_type:
+        count_nodes(t->block.dst, count);
+        count_nodes(t->block.src, count);
+        count_nodes(t->block.size, count);
+        break;
+    case do_while_type:
+        count_nodes(t->do_while.expr, count);
+        count_nodes(t->do_while.list_instr, count);
+        break;
+    case exp_list_type:
+        count_nodes(t->exp_list.exp, count);
+        count_nodes(t->exp_list.next, count);
+        break;
+    case func_call_type:
+        count_nodes(t->func_call.func_id, count);
+        count_nodes(t->func_call.params, count);
+        break;
+    case return_type:
+        count_nodes(t->return_n.expr, count);
+        break;
+    case for_type:
+        count_nodes(t->for_n.affect_init, count);
+        count_nodes(t->for_n.list_instr, count);
+        count_nodes(t->for_n.end_exp, count);
+        break;
+    case io_type:
+        count_nodes(t->io.expr, count);
+        count_nodes(t->io.id, count);
+        break;
+    case array_access_type:
+        count_nodes(t->arr_access.id, count);
+        count_nodes(t->arr_access.ind_expr, count);
+        count_nodes(t->arr_access.affect_expr, count);
+        count_nodes(t->arr_access.col_expr, count);
+        break;
+    case array_decla_type:
+        count_nodes(t->arr_decla.id, count);
+        count_nodes(t->arr_decla.list_expr, count);
+        break;
+    case alloc_type:
+        count_nodes(t->alloc.id, count);
+        count_nodes(t->alloc.expr, count);
+        break;
+    case proto_type:
+        count_nodes(t->proto.id, count);
+        count_nodes(t->proto.params, count);
+        break;
+    case inc_type:
+        count_nodes(t->inc.id, count);
+        break;
+    case free_type:
+        count_nodes(t->free_n.id, count);
+        break;
+    default:
+        break;
+    }
+}
+
+
+
+/**
+ * @brief Copie (en profondeur) l'ASA `t`.
+ * Les informations de position sont conservées.
+ * 
+ * @param t 
+ * @return ast* La copie
+ */
+ast *copy_ast(ast *t)
+{
+    if (t == NULL) return NULL;
+
+    ast *c = (ast *) malloc(sizeof(ast));
+    check_alloc(c);
+    *c = *t;
+
+    switch (t->type)
+    {
+    case b_op_type:
+        c->b_op.l_memb = copy_ast(t->b_op.l_memb);
+        c->b_op.r_memb = copy_ast(t->b_op.r_memb);
+        break;
+    case u_op_type:
+        c->u_op.child = copy_ast(t->u_op.child);
+        break;
+    case instr_type:
+        c->list_instr.instr = copy_ast(t->list_instr.instr);
+        c->list_instr.next = copy_ast(t->list_instr.next);
+        break;
+    case affect_type:
+        c->affect.id = copy_ast(t->affect.id);
+        c->affect.expr = copy_ast(t->affect.expr);
+        break;
+    case decla_type:
+        c->decla_list.decla = copy_ast(t->decla_list.decla);
+        c->decla_list.next = copy_ast(t->decla_list.next);
+        break;
+    case var_decla_type:
+        c->var_decla.expr = copy_ast(t->var_decla.expr);
+        c->var_decla.var = copy_ast(t->var_decla.var);
+        c->var_decla.next = copy_ast(t->var_decla.next);
+        break;
+    case prog_type:
+        c->root.list_decl = copy_ast(t->root.list_decl);
+        c->root.main_prog = copy_ast(t->root.main_prog);
+        break;
+    case func_decla_type:
+        c->func_decla.id = copy_ast(t->func_decla.id);
+        c->func_decla.list_decl = copy_ast(t->func_decla.list_decl);
+        c->func_decla.list_instr = copy_ast(t->func_decla.list_instr);
+        c->func_decla.params = copy_ast(t->func_decla.params);
+        break;
+    case while_type:
+        c->while_n.expr = copy_ast(t->while_n.expr);
+        c->while_n.list_instr = copy_ast(t->while_n.list_instr);
+        break;
+    case if_type:
+        c->if_n.expr = copy_ast(t->if_n.expr);
+        c->if_n.list_instr1 = copy_ast(t->if_n.list_instr1);
+        c->if_n.list_instr2 = copy_ast(t->if_n.list_instr2);
+        break;
+    case switch_type:
+        c->switch_n.expr = copy_ast(t->switch_n.expr);
+        c->switch_n.cases = copy_ast(t->switch_n.cases);
+        c->switch_n.default_instr = copy_ast(t->switch_n.default_instr);
+        break;
+    case case_type:
+        c->case_n.list_instr = copy_ast(t->case_n.list_instr);
+        c->case_n.next = copy_ast(t->case_n.next);
+        break;
+    case block_type:
+        c->block.dst = copy_ast(t->block.dst);
+        c->block.src = copy_ast(t->block.src);
+        c->block.size = copy_ast(t->block.size);
+        break;
+    case do_while_type:
+        c->do_while.expr = copy_ast(t->do_while.expr);
+        c->do_while.list_instr = copy_ast(t->do_while.list_instr);
+        break;
+    case exp_list_type:
+        c->exp_list.exp = copy_ast(t->exp_list.exp);
+        c->exp_list.next = copy_ast(t->exp_list.next);
+        break;
+    case func_call_type:
+        c->func_call.func_id = copy_ast(t->func_call.func_id);
+        c->func_call.params = copy_ast(t->func_call.params);
+        break;
+    case return_type:
+        c->return_n.expr = copy_ast(t->return_n.expr);
+        break;
+    case for_type:
+        c->for_n.affect_init = copy_ast(t->for_n.affect_init);
+        c->for_n.list_instr = copy_ast(t->for_n.list_instr);
+        c->for_n.end_exp = copy_ast(t->for_n.end_exp);
+
+        /* La variable est partagée avec la condition (voir create_for_node) */
+        c->for_n.id = c->for_n.end_exp->b_op.l_memb;
+        break;
+    case io_type:
+        c->io.expr = copy_ast(t->io.expr);
+        c->io.id = copy_ast(t->io.id);
+        break;
+    case array_access_type:
+        c->arr_access.id = copy_ast(t->arr_access.id);
+        c->arr_access.ind_expr = copy_ast(t->arr_access.ind_expr);
+        c->arr_access.affect_expr = copy_ast(t->arr_access.affect_expr);
+        c->arr_access.col_expr = copy_ast(t->arr_access.col_expr);
+        break;
+    case array_decla_type:
+        c->arr_decla.id = copy_ast(t->arr_decla.id);
+        c->arr_decla.list_expr = copy_ast(t->arr_decla.list_expr);
+        break;
+    case alloc_type:
+        c->alloc.id = copy_ast(t->alloc.id);
+        c->alloc.expr = copy_ast(t->alloc.expr);
+        break;
+    case proto_type:
+        c->proto.id = copy_ast(t->proto.id);
+        c->proto.params = copy_ast(t->proto.params);
+        break;
+    case inc_type:
+        c->inc.id = copy_ast(t->inc.id);
+        break;
+    case free_type:
+        c->free_n.id = copy_ast(t->free_n.id);
+        break;
+    default:
+        break;
+    }
+
+    return c;
+}
+
+
+
 /************************** Partie affichage **************************/
 
 
@@ -849,9 +1323,14 @@ static void io_to_dot(ast *t, int c_id, FILE *fp)
     io_node node = t->io;
     static char *fmt = "\"{%s|{<c%dc>}}\"";
 
-    char inst_name[32];
+    char inst_name[64];
     if (node.mode == 'r') strcpy(inst_name, "Lire");
-    else strcpy(inst_name, "Afficher");
+    else if (node.mode == 'w') strcpy(inst_name, "Afficher");
+    else
+    {
+        sprintf(inst_name, "%s %s", node.mode == 'R' ? "Lire" : "Afficher",
+                node.id->id.name);
+    }
 
     sprintf(buff, fmt, inst_name, c_id);
     fprintf(fp, "    %d [label=%s];\n", c_id, buff);
@@ -870,7 +1349,7 @@ static void prog_to_dot(ast *t, int c_id, FILE *fp)
     static char *fmt = "\"{%s|{<l%dl>Déclarations|<r%dr> main}}\"";
 
     /* Création de la racine */
-    sprintf(buff, fmt, src, c_id, c_id);
+    sprintf(buff, fmt, arc_ctx.src, c_id, c_id);
     fprintf(fp, "    %d [label=%s];\n", c_id, buff);
     
     tmp = ast_to_dot(node.main_prog, fp);
@@ -928,6 +1407,13 @@ static void arr_access_to_dot(ast *t, int c_id, FILE *fp)
     tmp = ast_to_dot(node.ind_expr, fp);
     fprintf(fp, "    %d:l%dl -- %d;\n", c_id, c_id, tmp);
 
+    /* 2ème indice de T[i][j] (avant flatten_arr_access) */
+    if (node.col_expr != NULL)
+    {
+        tmp = ast_to_dot(node.col_expr, fp);
+        fprintf(fp, "    %d:l%dl -- %d;\n", c_id, c_id, tmp);
+    }
+
     if (node.affect_expr == NULL) return;
     tmp = ast_to_dot(node.affect_expr, fp);
     fprintf(fp, "    %d:r%dr -- %d;\n", c_id, c_id, tmp);
@@ -937,9 +1423,9 @@ static void arr_access_to_dot(ast *t, int c_id, FILE *fp)
 static void alloc_to_dot(ast *t, int c_id, FILE *fp)
 {
     alloc_node node = t->alloc;
-    static char *fmt = "\"{Allocation pour %s|{<c%dc>}}\"";
+    static char *fmt = "\"{Allocation%s pour %s|{<c%dc>}}\"";
 
-    sprintf(buff, fmt, node.id->id.name, c_id);
+    sprintf(buff, fmt, node.is_local ? " locale" : "", node.id->id.name, c_id);
     fprintf(fp, "    %d [label=%s];\n", c_id, buff);
 
     tmp = ast_to_dot(node.expr, fp);
@@ -958,6 +1444,74 @@ static void proto_to_dot(ast *t, int c_id, FILE *fp)
 }
 
 
+static void inc_to_dot(ast *t, int c_id, FILE *fp)
+{
+    fprintf(fp, "    %d [label=\"INC %s\"];\n", c_id, t->inc.id->id.name);
+}
+
+
+static void free_to_dot(ast *t, int c_id, FILE *fp)
+{
+    fprintf(fp, "    %d [label=\"Libération de %s\"];\n", c_id,
+            t->free_n.id->id.name);
+}
+
+
+static void switch_to_dot(ast *t, int c_id, FILE *fp)
+{
+    switch_node node = t->switch_n;
+    static char *fmt = "\"{SELON|{<l%dl>valeur|<m%dm>CAS|<r%dr>SINON}}\"";
+
+    sprintf(buff, fmt, c_id, c_id, c_id);
+    fprintf(fp, "    %d [label=%s];\n", c_id, buff);
+
+    tmp = ast_to_dot(node.expr, fp);
+    fprintf(fp, "    %d:l%dl -- %d;\n", c_id, c_id, tmp);
+
+    tmp = ast_to_dot(node.cases, fp);
+    fprintf(fp, "    %d:m%dm -- %d;\n", c_id, c_id, tmp);
+
+    if (node.default_instr == NULL) return;
+    tmp = ast_to_dot(node.default_instr, fp);
+    fprintf(fp, "    %d:r%dr -- %d;\n", c_id, c_id, tmp);
+}
+
+
+static void case_to_dot(ast *t, int c_id, FILE *fp)
+{
+    case_node node = t->case_n;
+    static char *fmt = "\"{CAS %d|{<i%di>instructions|<n%dn>suivant}}\"";
+
+    sprintf(buff, fmt, node.val, c_id, c_id);
+    fprintf(fp, "    %d [label=%s];\n", c_id, buff);
+
+    tmp = ast_to_dot(node.list_instr, fp);
+    fprintf(fp, "    %d:i%di -- %d;\n", c_id, c_id, tmp);
+
+    if (node.next == NULL) return;
+    tmp = ast_to_dot(node.next, fp);
+    fprintf(fp, "    %d:n%dn -- %d;\n", c_id, c_id, tmp);
+}
+
+
+static void block_to_dot(ast *t, int c_id, FILE *fp)
+{
+    block_node node = t->block;
+    static char *fmt = "\"{%s %s|{<s%ds>%s|<n%dn>taille}}\"";
+
+    sprintf(buff, fmt, node.op == 'c' ? "COPIER" : "REMPLIR",
+            node.dst->id.name, c_id, node.op == 'c' ? "source" : "valeur",
+            c_id);
+    fprintf(fp, "    %d [label=%s];\n", c_id, buff);
+
+    tmp = ast_to_dot(node.src, fp);
+    fprintf(fp, "    %d:s%ds -- %d;\n", c_id, c_id, tmp);
+
+    tmp = ast_to_dot(node.size, fp);
+    fprintf(fp, "    %d:n%dn -- %d;\n", c_id, c_id, tmp);
+}
+
+
 
 
 
@@ -1043,6 +1597,21 @@ int ast_to_dot(ast *t, FILE *fp)
     case proto_type:
         proto_to_dot(t, c_id, fp);
         break;
+    case inc_type:
+        inc_to_dot(t, c_id, fp);
+        break;
+    case free_type:
+        free_to_dot(t, c_id, fp);
+        break;
+    case switch_type:
+        switch_to_dot(t, c_id, fp);
+        break;
+    case case_type:
+        case_to_dot(t, c_id, fp);
+        break;
+    case block_type:
+        block_to_dot(t, c_id, fp);
+        break;
     default:
         break;
     }
@@ -1,10 +1,13 @@
 #include "codegen.h"
 #include "arc_utils.h"
 #include "symbol_table.h"
+#include "arc_context.h"
+#include "arc_cache.h"
+#include "semantic.h"
 #include <string.h>
+#include <stdlib.h>
 
 
-extern symb_table table;
 static char c_context[32] = "global";
 static char old_context[32];
 
@@ -12,8 +15,33 @@ static char old_context[32];
 /* Compteur d'instruction. Utilisé pour les JUMP */
 static int nb_instr = 0;
 
+/* Sauvegarde de HEAP_REG de la fonction courante (voir ALLOUER_LOCAL) */
+static int heap_mark = 0;
+
+/* Valeurs temporaires empilées par la fonction courante (voir --guard) */
+static int temps = 0;
+
 /* Pour la taille de la pile */
 extern int mem_size;
+extern int heap_size;
+extern int recursion_depth;
+
+/*
+ * Disposition de la mémoire (voir init_mem_layout): tailles maximales du tas
+ * et de la pile (-1 si inconnues) et adresse du début de la pile
+ */
+static int heap_len = 0;
+static int stack_len = 0;
+static int stack_start = STACK_START;
+
+/* Vérification des indices des tableaux (--bounds-check) */
+extern int bounds_check;
+
+/* Vérification des débordements de la pile et du tas (--guard) */
+extern int guard_mode;
+
+/* Taille de la mémoire statique (voir semantic.c) */
+extern int static_rel_adr;
 
 
 
@@ -68,6 +96,7 @@ void add_instr(instr_ram instr, char t_adr, int adr)
         break;
     }
     
+    cache_record(instr, t_adr, adr);
     nb_instr++;
 }
 
@@ -110,20 +139,286 @@ void peek()
 
 
 
+/**
+ * @brief Insère les routines de l'allocateur de ramOS (voir ram_os.h), après
+ * la mise à 0 des têtes des listes de blocs libres (l'ACC contient 0).
+ * 
+ * @param lists L'adresse de la tête de la liste 0
+ */
+static void init_allocator(int lists)
+{
+    int i;
+    for (i = 0; i < NB_SIZE_CLASSES; i++) add_instr(STORE, ' ', lists + i);
+    add_instr(JUMP, ' ', FREE_ADR + FREE_ROUTINE_SIZE);
+
+    /* ALLOUER: la taille doit être > 0, sinon "segfault" -> on quitte */
+    add_instr(LOAD, ' ', ALLOC_REG_SIZE);
+    add_instr(JUMG, ' ', ALLOC_ADR + 3);
+    add_instr(STOP, ' ', 0);
+    add_instr(SUB, '#', NB_SIZE_CLASSES);
+    add_instr(JUML, ' ', ALLOC_ADR + 18);
+
+    /*
+     * Grand bloc: parcours de la liste 0 jusqu'à un bloc de la même taille
+     * (l'en-tête doit rester la taille demandée, pour --bounds-check)
+     */
+    add_instr(LOAD, '#', lists);
+    add_instr(STORE, ' ', ALLOC_REG_PREV);
+    add_instr(LOAD, '@', ALLOC_REG_PREV);
+    add_instr(JUMZ, ' ', ALLOC_ADR + 27);
+    add_instr(STORE, ' ', ALLOC_REG_BLOCK);
+    add_instr(SUB, '#', 1);
+    add_instr(STORE, ' ', ALLOC_REG_TMP);
+    add_instr(LOAD, '@', ALLOC_REG_TMP);
+    add_instr(SUB, ' ', ALLOC_REG_SIZE);
+    add_instr(JUMZ, ' ', ALLOC_ADR + 23);
+    add_instr(LOAD, ' ', ALLOC_REG_BLOCK);
+    add_instr(STORE, ' ', ALLOC_REG_PREV);
+    add_instr(JUMP, ' ', ALLOC_ADR + 7);
+
+    /* Petit bloc: liste de sa taille (l'ACC contient taille - NB_SIZE_CLASSES) */
+    add_instr(ADD, '#', lists + NB_SIZE_CLASSES);
+    add_instr(STORE, ' ', ALLOC_REG_PREV);
+    add_instr(LOAD, '@', ALLOC_REG_PREV);
+    add_instr(JUMZ, ' ', ALLOC_ADR + 27);
+    add_instr(STORE, ' ', ALLOC_REG_BLOCK);
+
+    /* Retrait du bloc de la liste (ALLOC_REG_PREV pointe sur le lien) */
+    add_instr(LOAD, '@', ALLOC_REG_BLOCK);
+    add_instr(STORE, '@', ALLOC_REG_PREV);
+    add_instr(LOAD, ' ', ALLOC_REG_BLOCK);
+    add_instr(JUMP, '@', ALLOC_REG_RET);
+
+    /* Pas de bloc libre: nouveau bloc (et son en-tête) à la fin du tas */
+    add_instr(LOAD, ' ', ALLOC_REG_SIZE);
+    add_instr(STORE, '@', HEAP_REG);
+    add_instr(INC, ' ', HEAP_REG);
+    add_instr(LOAD, ' ', HEAP_REG);
+    add_instr(STORE, ' ', ALLOC_REG_BLOCK);
+    add_instr(ADD, ' ', ALLOC_REG_SIZE);
+    add_instr(STORE, ' ', HEAP_REG);
+    add_instr(LOAD, ' ', ALLOC_REG_BLOCK);
+    add_instr(JUMP, '@', ALLOC_REG_RET);
+
+    /* LIBERER: rien à faire pour un pointeur nul */
+    add_instr(LOAD, ' ', ALLOC_REG_BLOCK);
+    add_instr(JUMG, ' ', FREE_ADR + 3);
+    add_instr(JUMP, '@', ALLOC_REG_RET);
+
+    /* Liste de la taille du bloc (lue dans son en-tête) */
+    add_instr(SUB, '#', 1);
+    add_instr(STORE, ' ', ALLOC_REG_TMP);
+    add_instr(LOAD, '@', ALLOC_REG_TMP);
+    add_instr(SUB, '#', NB_SIZE_CLASSES);
+    add_instr(JUML, ' ', FREE_ADR + 10);
+    add_instr(LOAD, '#', lists);
+    add_instr(JUMP, ' ', FREE_ADR + 11);
+    add_instr(ADD, '#', lists + NB_SIZE_CLASSES);
+
+    /* Ajout du bloc en tête de la liste */
+    add_instr(STORE, ' ', ALLOC_REG_PREV);
+    add_instr(LOAD, '@', ALLOC_REG_PREV);
+    add_instr(STORE, '@', ALLOC_REG_BLOCK);
+    add_instr(LOAD, ' ', ALLOC_REG_BLOCK);
+    add_instr(STORE, '@', ALLOC_REG_PREV);
+    add_instr(JUMP, '@', ALLOC_REG_RET);
+}
+
+
+
+/**
+ * @brief Calcule la disposition de la mémoire (voir ram_os.h), après l'analyse
+ * sémantique: le début de la pile est à --mem-size (USHRT_MAX par défaut), ou
+ * juste après le tas et la pile avec --mem-size=auto.
+ * 
+ */
+void init_mem_layout()
+{
+    /* Les têtes des listes de l'allocateur sont au-dessus de la pile */
+    int lists = arc_ctx.uses_free ? NB_SIZE_CLASSES : 0;
+
+    heap_len = arc_ctx.uses_alloc ? heap_size : 0;
+    stack_len = max_stack_size(arc_ctx.tree, recursion_depth);
+
+    if (mem_size != MEM_SIZE_AUTO)
+    {
+        stack_start = (mem_size == 0 ? STACK_START : mem_size) - lists;
+        return;
+    }
+
+    if (stack_len < 0 || heap_len < 0)
+    {
+        unset_error_info();
+        if (stack_len < 0)
+        {
+            warning("~B--mem-size=auto~E: programme récursif sans "\
+                    "~B--recursion-depth~E, taille de la mémoire par défaut");
+        }
+        else
+        {
+            warning("~B--mem-size=auto~E: ~BALLOUER~E utilisé sans "\
+                    "~B--heap-size~E, taille de la mémoire par défaut");
+        }
+        stack_start = STACK_START - lists;
+    }
+    else stack_start = STATIC_START + static_rel_adr + heap_len + stack_len;
+}
+
+
+
+/**
+ * @brief Affiche la disposition de la mémoire calculée par init_mem_layout
+ * (-d). La dernière ligne donne la taille de la mémoire utilisée.
+ * 
+ */
+void print_mem_layout()
+{
+    int heap_start = STATIC_START + static_rel_adr;
+    int lists = arc_ctx.uses_free ? NB_SIZE_CLASSES : 0;
+
+    printf("Disposition de la mémoire:\n");
+    printf("  ramOS:    [0, %d[\n", STATIC_START);
+    printf("  statique: [%d, %d[\n", STATIC_START, heap_start);
+
+    if (heap_len >= 0)
+    {
+        printf("  tas:      [%d, %d[\n", heap_start, heap_start + heap_len);
+    }
+    else printf("  tas:      [%d, ...[ (taille inconnue)\n", heap_start);
+
+    if (stack_len >= 0)
+    {
+        printf("  pile:     [%d, %d]\n", stack_start - stack_len + 1,
+               stack_start);
+    }
+    else printf("  pile:     [..., %d] (taille inconnue)\n", stack_start);
+
+    if (lists > 0)
+    {
+        printf("  listes:   [%d, %d]\n", stack_start + 1, stack_start + lists);
+    }
+
+    printf("Taille de la mémoire: %d\n", stack_start + lists + 1);
+}
+
+
+
 /**
  * @brief Insère tout le code propre à ram_OS
  * 
  */
 void init_ram_os()
 {
-    int adr = mem_size == 0 ? STACK_START : mem_size;
+    int adr = stack_start;
+
     add_instr(LOAD, '#', adr);
     add_instr(STORE, ' ', STACK_REG);
     add_instr(STORE, ' ', STACK_REL_START);
-    add_instr(LOAD, '#', STATIC_START);
+    /* Le tas commence après la mémoire statique, réservée dès la compilation */
+    add_instr(LOAD, '#', STATIC_START + static_rel_adr);
     add_instr(STORE, ' ', HEAP_REG);
     add_instr(LOAD, '#', 0);
     add_instr(STORE, ' ', TMP_REG_REL_STK_CPY);
+
+    if (arc_ctx.uses_free) init_allocator(adr + 1);
+
+    /* Routines d'erreur de --guard: le code d'erreur est écrit puis on quitte */
+    if (guard_mode)
+    {
+        add_instr(JUMP, ' ', nb_instr + RAM_OS_TRAP_SIZE);
+        add_instr(LOAD, '#', TRAP_STACK_OVERFLOW);
+        add_instr(WRITE, ' ', 0);
+        add_instr(STOP, ' ', 0);
+        add_instr(LOAD, '#', TRAP_HEAP_OVERFLOW);
+        add_instr(WRITE, ' ', 0);
+        add_instr(STOP, ' ', 0);
+    }
+}
+
+
+
+/**
+ * @brief Renvoie le nombre d'instructions du code de ramOS (placé avant les
+ * fonctions).
+ * 
+ * @return int 
+ */
+int ram_os_size()
+{
+    return RAM_OS_INIT_SIZE + (arc_ctx.uses_free ? RAM_OS_ALLOC_SIZE : 0)
+           + (guard_mode ? RAM_OS_TRAP_SIZE : 0);
+}
+
+
+
+/**
+ * @brief Saute dans la routine d'erreur de --guard `offset` (voir ram_os.h)
+ * si l'ACC est < 0 (TRAP_STACK_OFFSET) ou > 0 (TRAP_HEAP_OFFSET).
+ * 
+ * @param offset
+ */
+static void jump_trap(int offset)
+{
+    int adr = ram_os_size() - RAM_OS_TRAP_SIZE + offset;
+    cache_tag(RELOC_OS, NULL);
+    add_instr(offset == TRAP_STACK_OFFSET ? JUML : JUMG, ' ', adr);
+}
+
+
+
+/**
+ * @brief --guard: vérifie que `size` cases sont encore libres sous le sommet
+ * de la pile sans atteindre la fin du tas (GUARD_STACK_COST instructions).
+ * 
+ * @param size
+ */
+static void codegen_guard_stack(int size)
+{
+    add_instr(LOAD, ' ', STACK_REG);
+    add_instr(SUB, '#', size);
+    add_instr(SUB, ' ', HEAP_REG);
+    jump_trap(TRAP_STACK_OFFSET);
+}
+
+
+
+/**
+ * @brief --guard: vérifie qu'après un ALLOUER, la fin du tas reste sous les
+ * valeurs temporaires que la fonction courante peut encore empiler
+ * (GUARD_HEAP_COST instructions, +1 s'il y en a).
+ * 
+ */
+static void codegen_guard_heap()
+{
+    add_instr(LOAD, ' ', HEAP_REG);
+    add_instr(SUB, ' ', STACK_REG);
+    if (temps > 0) add_instr(ADD, '#', temps);
+    jump_trap(TRAP_HEAP_OFFSET);
+}
+
+
+
+/**
+ * @brief Remet à zéro l'état de la génération de code avant la compilation
+ * d'un autre fichier.
+ * 
+ */
+void reset_codegen()
+{
+    nb_instr = 0;
+    strcpy(c_context, "global");
+}
+
+
+
+/**
+ * @brief Renvoie le nombre d'instructions écrites dans le fichier produit.
+ * 
+ * @return int 
+ */
+int codegen_nb_instr()
+{
+    return nb_instr;
 }
 
 
@@ -166,6 +461,9 @@ void codegen(ast *t)
     case if_type:
         codegen_if(t);
         break;
+    case switch_type:
+        codegen_switch(t);
+        break;
     case prog_type:
         codegen(t->root.list_decl);
         codegen(t->root.main_prog);
@@ -192,6 +490,15 @@ void codegen(ast *t)
     case alloc_type:
         codegen_alloc(t);
         break;
+    case inc_type:
+        codegen_inc(t);
+        break;
+    case free_type:
+        codegen_free(t);
+        break;
+    case block_type:
+        codegen_block(t);
+        break;
     default:
         break;
     }
@@ -305,7 +612,7 @@ void codegen_u_op(ast *t)
         add_instr(MUL, '#', -1);
         break;
     case '@':
-        tmp = get_symbol(table, c_context, t->u_op.child->id.name);
+        tmp = get_symbol(arc_ctx.table, c_context, t->u_op.child->id.name);
         if (tmp->mem_zone == 's')
         {
             add_instr(LOAD, ' ', STACK_REL_START);
@@ -314,7 +621,7 @@ void codegen_u_op(ast *t)
         else add_instr(LOAD, '#', tmp->adr);
         break;
     case '*':
-        tmp = get_symbol(table, c_context, t->u_op.child->id.name);
+        tmp = get_symbol(arc_ctx.table, c_context, t->u_op.child->id.name);
         if (tmp->mem_zone == 's')
         {
             add_instr(LOAD, ' ', STACK_REL_START);
@@ -337,7 +644,7 @@ void codegen_u_op(ast *t)
 
 void codegen_id(ast *t)
 {
-    symbol *tmp = get_symbol(table, c_context, t->id.name);
+    symbol *tmp = get_symbol(arc_ctx.table, c_context, t->id.name);
 
     /*
      * Si l'id est un tableau, il ne faut pas charger la valeur contenue à
@@ -662,7 +969,7 @@ void codegen_affect(ast *t)
 
     /* On évalue l'expression et on la stocke à la bonne adresse */
     codegen(node.expr);
-    symbol *tmp = get_symbol(table, c_context, node.id->id.name);
+    symbol *tmp = get_symbol(arc_ctx.table, c_context, node.id->id.name);
 
     /* Si déréférencement on utilise l'adressage indirect */
     char adr_type = node.is_deref ? '@' : ' ';
@@ -690,7 +997,8 @@ void codegen_affect(ast *t)
 void codegen_io(ast *t)
 {
     io_node node = t->io;
-    if (node.mode == 'w')
+    if (node.id != NULL) codegen_io_tab(t);
+    else if (node.mode == 'w')
     {
         codegen(node.expr);
         add_instr(WRITE, ' ', 0);
@@ -729,12 +1037,34 @@ void codegen_do_while(ast *t)
 }
 
 
+/**
+ * @brief Incrémente de 1 la variable `tmp` (1 instruction si elle est dans la
+ * mémoire statique, 4 si elle est dans la pile).
+ * 
+ * @param tmp 
+ */
+static void codegen_inc_var(symbol *tmp)
+{
+    int adr = tmp->adr;
+    char adr_type = ' ';
+    if (tmp->mem_zone == 's')
+    {
+        add_instr(LOAD, ' ', STACK_REL_START);
+        add_instr(SUB, '#', adr);
+        add_instr(STORE, ' ', TMP_REG_STK_ADR);
+        adr = TMP_REG_STK_ADR;
+        adr_type = '@';
+    }
+    add_instr(INC, adr_type, adr);
+}
+
+
 void codegen_for(ast *t)
 {
     for_node node = t->for_n;
 
     // ToDo: autoriser déclaration de variable dans le POUR ?
-    symbol *tmp = get_symbol(table, c_context, node.id->id.name);
+    symbol *tmp = get_symbol(arc_ctx.table, c_context, node.id->id.name);
 
     /* Initialisation de la variable */
     codegen(node.affect_init);
@@ -749,22 +1079,18 @@ void codegen_for(ast *t)
     codegen(node.list_instr);
 
     /* Incrément de la variable controllant la boucle */
-    int adr = tmp->adr;
-    char adr_type = ' ';
-    if (tmp->mem_zone == 's')
-    {
-        add_instr(LOAD, ' ', STACK_REL_START);
-        add_instr(SUB, '#', adr);
-        add_instr(STORE, ' ', TMP_REG_STK_ADR);
-        adr = TMP_REG_STK_ADR;
-        adr_type = '@';
-    }
-    add_instr(INC, adr_type, adr);
+    codegen_inc_var(tmp);
 
     add_instr(JUMP, ' ', jump_back);
 }
 
 
+void codegen_inc(ast *t)
+{
+    codegen_inc_var(get_symbol(arc_ctx.table, c_context, t->inc.id->id.name));
+}
+
+
 void codegen_if(ast *t)
 {
     if_node node = t->if_n;
@@ -787,12 +1113,231 @@ void codegen_if(ast *t)
 }
 
 
+
+static int cmp_cases(const void *a, const void *b)
+{
+    int x = (*(ast **) a)->case_n.val, y = (*(ast **) b)->case_n.val;
+    return (x > y) - (x < y);
+}
+
+
+/**
+ * @brief Renvoie les CAS du SELON t triés par valeur croissante (tableau à
+ * libérer), et leur nombre dans nb.
+ * 
+ * @param t 
+ * @param nb 
+ * @return ast** 
+ */
+static ast **sorted_cases(ast *t, int *nb)
+{
+    ast *aux;
+    int i = 0;
+
+    for (aux = t->switch_n.cases, *nb = 0; aux != NULL; aux = aux->case_n.next)
+    {
+        (*nb)++;
+    }
+
+    ast **cases = (ast **) malloc(sizeof(ast *) * (*nb + 1));
+    check_alloc(cases);
+
+    for (aux = t->switch_n.cases; aux != NULL; aux = aux->case_n.next)
+    {
+        cases[i++] = aux;
+    }
+    qsort(cases, *nb, sizeof(ast *), cmp_cases);
+
+    return cases;
+}
+
+
+/**
+ * @brief Renvoie 1 si les CAS (triés) sont assez nombreux et rapprochés pour
+ * utiliser une table de sauts.
+ * 
+ * @param cases 
+ * @param nb 
+ * @return int 
+ */
+static int is_dense(ast **cases, int nb)
+{
+    long range = (long) cases[nb - 1]->case_n.val - cases[0]->case_n.val + 1;
+    return nb >= SWITCH_TABLE_MIN_CASES && range <= SWITCH_TABLE_DENSITY * nb;
+}
+
+
+/**
+ * @brief Taille de la recherche dichotomique parmi les CAS lo à hi (voir
+ * codegen_search).
+ * 
+ * @param lo 
+ * @param hi 
+ * @return int 
+ */
+static int search_len(int lo, int hi)
+{
+    if (lo > hi) return 1;
+
+    int mid = (lo + hi) / 2;
+    int len = 4 + search_len(mid + 1, hi);
+    if (lo < mid) len += search_len(lo, mid - 1);
+
+    return len;
+}
+
+
+/**
+ * @brief Renvoie le nombre d'instructions qui choisissent le CAS à exécuter
+ * (sans l'expression du SELON), utilisé par l'analyse sémantique.
+ * 
+ * @param t 
+ * @return int 
+ */
+int switch_dispatch_len(ast *t)
+{
+    int nb;
+    ast **cases = sorted_cases(t, &nb);
+    int len;
+
+    if (nb == 0) len = 1;
+    else if (is_dense(cases, nb))
+    {
+        len = 8 + cases[nb - 1]->case_n.val - cases[0]->case_n.val + 1;
+    }
+    else len = 1 + search_len(0, nb - 1);
+
+    free(cases);
+    return len;
+}
+
+
+/**
+ * @brief Recherche dichotomique de la valeur du SELON (dans TMP_REG_SWP)
+ * parmi les CAS lo à hi: comparaison avec le CAS du milieu, puis recherche
+ * parmi les CAS supérieurs et enfin parmi les CAS inférieurs.
+ * 
+ * @param cases Les CAS triés
+ * @param adrs L'adresse du code de chaque CAS
+ * @param lo 
+ * @param hi 
+ * @param default_adr L'adresse du SINON (ou de la fin du SELON)
+ */
+static void codegen_search(ast **cases, int *adrs, int lo, int hi,
+                           int default_adr)
+{
+    if (lo > hi)
+    {
+        add_instr(JUMP, ' ', default_adr);
+        return;
+    }
+
+    int mid = (lo + hi) / 2;
+
+    /* Les CAS inférieurs sont après les CAS supérieurs */
+    int left_adr = default_adr;
+    if (lo < mid) left_adr = nb_instr + 4 + search_len(mid + 1, hi);
+
+    add_instr(LOAD, ' ', TMP_REG_SWP);
+    add_instr(SUB, '#', cases[mid]->case_n.val);
+    add_instr(JUMZ, ' ', adrs[mid]);
+    add_instr(JUML, ' ', left_adr);
+
+    codegen_search(cases, adrs, mid + 1, hi, default_adr);
+    if (lo < mid) codegen_search(cases, adrs, lo, mid - 1, default_adr);
+}
+
+
+/**
+ * @brief Génère le code du SELON.
+ * Si les CAS sont rapprochés, la valeur sert d'indice dans une table de JUMP
+ * (une entrée par valeur entre le plus petit et le plus grand CAS) atteinte par
+ * un JUMP indirect. Sinon, le CAS est cherché par dichotomie.
+ * Les instructions des CAS suivent, dans l'ordre du programme, chacune suivie
+ * d'un JUMP à la fin du SELON, puis celles du SINON.
+ * 
+ * @param t 
+ */
+void codegen_switch(ast *t)
+{
+    switch_node node = t->switch_n;
+    int nb, i;
+    ast *aux;
+    ast **cases = sorted_cases(t, &nb);
+
+    codegen(node.expr);
+
+    /* Adresses des instructions de chaque CAS, du SINON et de la fin */
+    int adr = nb_instr + switch_dispatch_len(t);
+    for (aux = node.cases; aux != NULL; aux = aux->case_n.next)
+    {
+        aux->mem_adr = adr;
+        adr += aux->case_n.list_instr->codelen;
+        if (aux->case_n.next != NULL || node.default_instr != NULL) adr++;
+    }
+    int default_adr = adr;
+    int end_adr = adr;
+    if (node.default_instr != NULL) end_adr += node.default_instr->codelen;
+
+    int *adrs = (int *) malloc(sizeof(int) * (nb + 1));
+    check_alloc(adrs);
+    for (i = 0; i < nb; i++) adrs[i] = cases[i]->mem_adr;
+
+    if (nb == 0) add_instr(JUMP, ' ', default_adr);
+    else if (is_dense(cases, nb))
+    {
+        int min = cases[0]->case_n.val, max = cases[nb - 1]->case_n.val;
+
+        /* Valeur hors de [min, max]: SINON */
+        add_instr(SUB, '#', max + 1);
+        add_instr(JUMG, ' ', default_adr);
+        add_instr(JUMZ, ' ', default_adr);
+        add_instr(ADD, '#', max + 1 - min);
+        add_instr(JUML, ' ', default_adr);
+
+        /* JUMP à l'entrée valeur - min de la table */
+        cache_tag(RELOC_CODE, NULL);
+        add_instr(ADD, '#', nb_instr + 3);
+        add_instr(STORE, ' ', TMP_REG_SWP);
+        add_instr(JUMP, '@', TMP_REG_SWP);
+
+        /* Les valeurs sans CAS vont au SINON */
+        int k = 0;
+        for (i = min; i <= max; i++)
+        {
+            if (cases[k]->case_n.val == i) add_instr(JUMP, ' ', adrs[k++]);
+            else add_instr(JUMP, ' ', default_adr);
+        }
+    }
+    else
+    {
+        add_instr(STORE, ' ', TMP_REG_SWP);
+        codegen_search(cases, adrs, 0, nb - 1, default_adr);
+    }
+
+    /* Instructions des CAS */
+    for (aux = node.cases; aux != NULL; aux = aux->case_n.next)
+    {
+        codegen(aux->case_n.list_instr);
+        if (aux->case_n.next != NULL || node.default_instr != NULL)
+        {
+            add_instr(JUMP, ' ', end_adr);
+        }
+    }
+
+    codegen(node.default_instr);
+
+    free(adrs);
+    free(cases);
+}
+
+
 static void codegen_int_decla(ast *t)
 {
     var_decla_node node = t->var_decla;
 
     char *id = node.var->id.name;
-    symbol *tmp = get_symbol(table, c_context, id);
+    symbol *tmp = get_symbol(arc_ctx.table, c_context, id);
     
     /*
      * S'il y a une expression, il faut initialiser la variable.
@@ -823,9 +1368,25 @@ static void codegen_int_decla(ast *t)
         add_instr(STORE, adr_type, adr);
     }
 
-    /* MAJ du tas / pile */
+    /* MAJ de la pile (la mémoire statique est déjà réservée) */
     if (tmp->mem_zone == 's') add_instr(DEC, ' ', STACK_REG);
-    else add_instr(INC, ' ', HEAP_REG);
+}
+
+
+
+/**
+ * @brief Renvoie 1 si l'expression exp est la même constante que l'expression
+ * prev qui la précède dans l'initialisation d'un tableau statique: l'ACC
+ * contient alors déjà sa valeur.
+ * 
+ * @param prev 
+ * @param exp 
+ * @return int 
+ */
+int is_repeated_constant(ast *prev, ast *exp)
+{
+    return prev != NULL && prev->type == nb_type && exp->type == nb_type
+           && prev->nb.val == exp->nb.val;
 }
 
 
@@ -836,38 +1397,61 @@ static void codegen_arr_decla(ast *t)
     array_decla_node arr_node = node.var->arr_decla;
 
     char *id = arr_node.id->id.name;
-    symbol *tmp = get_symbol(table, c_context, id);
+    symbol *tmp = get_symbol(arc_ctx.table, c_context, id);
 
     /* On parcourt les expressions et on les stocke */
     ast *aux = arr_node.list_expr;
 
-    /* Si pas d'initialisation on alloue quand même la mémoire */
+    /*
+     * Si pas d'initialisation on alloue quand même la mémoire (la mémoire
+     * statique est déjà réservée)
+     */
     if (tmp->mem_zone == 's')
     {
         add_instr(LOAD, ' ', STACK_REG);
-        add_instr(SUB, '#', arr_node.size);
+        add_instr(SUB, '#', arr_node.size + bounds_check);
         add_instr(STORE, ' ', STACK_REG);
     }
-    else if (aux == NULL)
+
+    /* --bounds-check: la taille est dans la case qui précède tab[0] */
+    if (bounds_check && tmp->mem_zone == 's')
     {
-        add_instr(LOAD, ' ', HEAP_REG);
-        add_instr(ADD, '#', arr_node.size);
-        add_instr(STORE, ' ', HEAP_REG);
+        add_instr(LOAD, ' ', STACK_REL_START);
+        add_instr(SUB, '#', tmp->adr + 1);
+        add_instr(STORE, ' ', TMP_REG_STK_ADR);
+        add_instr(LOAD, '#', arr_node.size);
+        add_instr(STORE, '@', TMP_REG_STK_ADR);
+    }
+    else if (bounds_check)
+    {
+        add_instr(LOAD, '#', arr_node.size);
+        add_instr(STORE, ' ', tmp->adr - 1);
     }
 
+    /* La place est déjà réservée: on stocke tab[i] directement */
+    int i = 0;
+    ast *prev = NULL;
     while (aux != NULL)
     {
-        codegen(aux->exp_list.exp);
-        if (tmp->mem_zone == 's')
+        /* Statique: l'ACC n'est pas modifié entre 2 éléments */
+        if (tmp->mem_zone == 's'
+            || !is_repeated_constant(prev, aux->exp_list.exp))
         {
-            add_instr(STORE, '@', STACK_REG);
-            add_instr(INC, ' ', STACK_REG);
+            codegen(aux->exp_list.exp);
         }
-        else
+
+        if (tmp->mem_zone == 's')
         {
-            add_instr(STORE, '@', HEAP_REG);
-            add_instr(INC, ' ', HEAP_REG);
+            add_instr(STORE, ' ', TMP_REG_ACC_SWP);
+            add_instr(LOAD, ' ', STACK_REL_START);
+            add_instr(SUB, '#', tmp->adr - i++);
+            add_instr(STORE, ' ', TMP_REG_STK_ADR);
+            add_instr(LOAD, ' ', TMP_REG_ACC_SWP);
+            add_instr(STORE, '@', TMP_REG_STK_ADR);
         }
+        else add_instr(STORE, ' ', tmp->adr + i++);
+
+        prev = aux->exp_list.exp;
         aux = aux->exp_list.next;
     }
 }
@@ -896,6 +1480,13 @@ void codegen_func_decla(ast *t)
     strcpy(old_context, c_context);
     strcpy(c_context, node.id->id.name);
 
+    /* Fonction inchangée depuis une compilation précédente (--cache) */
+    if (cache_dir != NULL && cache_load(t, c_context, nb_instr))
+    {
+        strcpy(c_context, old_context);
+        return;
+    }
+
 
     /*
      * Si jamais la fonction est déclarée avant le programme principal,
@@ -908,16 +1499,36 @@ void codegen_func_decla(ast *t)
         add_instr(JUMP, ' ', nb_instr + t->codelen);
     }
 
+    /*
+     * --guard: la pile de la fonction principale est vérifiée à son début,
+     * celle des autres fonctions par chaque appel (voir codegen_func_call)
+     */
+    symbol *tmp = get_symbol(arc_ctx.table, old_context, node.id->id.name);
+    if (guard_mode && strcmp(node.id->id.name, "PROGRAMME") == 0)
+    {
+        codegen_guard_stack(tmp->frame_size);
+    }
+    temps = node.temps;
+
     codegen(node.list_decl);
-    codegen(node.list_instr);
 
-    /* Pas de retour pour la fonction principale */
-    if (strcmp(node.id->id.name, "PROGRAMME") == 0)
+    /* Sauvegarde de HEAP_REG pour ALLOUER_LOCAL (voir codegen_return) */
+    heap_mark = node.heap_mark;
+    if (heap_mark != 0)
     {
-        add_instr(STOP, ' ', 0);
-        return;
+        add_instr(LOAD, ' ', HEAP_REG);
+        push();
     }
 
+    codegen(node.list_instr);
+    heap_mark = 0;
+    temps = 0;
+
+    /* Pas de retour pour la fonction principale */
+    if (strcmp(node.id->id.name, "PROGRAMME") == 0) add_instr(STOP, ' ', 0);
+
+    if (cache_dir != NULL) cache_save();
+
     /* On remet le bon contexte */
     strcpy(c_context, old_context);
 }
@@ -973,6 +1584,11 @@ void codegen_func_decla(ast *t)
 void codegen_func_call(ast *t)
 {
     func_call_node node = t->func_call;
+    symbol *tmp = get_symbol(arc_ctx.table, c_context, node.func_id->id.name);
+    int start = nb_instr;
+
+    /* --guard: la pile de la fonction appelée ne doit pas atteindre le tas */
+    if (guard_mode) codegen_guard_stack(tmp->frame_size);
 
     /*
      * Pour gérer les appels de fonctions imbriqués (du style foo(bar(1), 2)).
@@ -1005,9 +1621,9 @@ void codegen_func_call(ast *t)
      * On empile l'adresse de retour.
      * -10 pour retirer les 10 dernières instructions (qui sont celles exécutées)
      * après la fonction appelée).
-     * -9 pour ajouter le décalage des 9 premières instructions (dont celle-ci)
      */
-    add_instr(LOAD, '#', nb_instr + t->codelen - 10 - 9 + 1);
+    cache_tag(RELOC_CODE, NULL);
+    add_instr(LOAD, '#', start + t->codelen - 10);
     push();
 
     /*
@@ -1030,7 +1646,7 @@ void codegen_func_call(ast *t)
 
 
     /* On JUMP à l'adresse de la fonction */
-    symbol *tmp = get_symbol(table, c_context, node.func_id->id.name);
+    cache_tag(RELOC_FUNC, node.func_id->id.name);
     add_instr(JUMP, ' ', tmp->adr);
 
     /*
@@ -1082,6 +1698,15 @@ void codegen_return(ast *t)
     /* On stocke le contenu de la valeur de retour */
     add_instr(STORE, ' ', REG_RETURN_VALUE);
 
+    /* ALLOUER_LOCAL: le tas reprend sa taille du début de la fonction */
+    if (heap_mark != 0)
+    {
+        add_instr(LOAD, ' ', STACK_REL_START);
+        add_instr(SUB, '#', heap_mark);
+        add_instr(LOAD, '@', 0);
+        add_instr(STORE, ' ', HEAP_REG);
+    }
+
     /*
      * On dépile jusqu'à atteindre le point de départ pour récupérer
      * l'adresse de retour.
@@ -1105,33 +1730,111 @@ void codegen_return(ast *t)
 
 
 
+/**
+ * @brief Renvoie les bornes de l'indice de l'accès `t` qui doivent être
+ * vérifiées à l'exécution (BOUNDS_LOW, BOUNDS_HIGH): aucune sans
+ * --bounds-check, sinon celles qui n'ont pas été prouvées par les
+ * optimisations.
+ * 
+ * @param t Le noeud d'accès au tableau
+ * @return int 
+ */
+int bounds_to_check(ast *t)
+{
+    return bounds_check ? ~t->arr_access.in_bounds & BOUNDS_OK : 0;
+}
+
+
+
+/**
+ * @brief Vérifie que l'indice contenu dans l'ACC est compris entre 0 et la
+ * taille du tableau `tmp`, sinon on quitte ("segfault", comme ALLOUER).
+ * L'ACC contient ensuite indice - taille.
+ * 
+ * @param tmp 
+ * @param check Les bornes à vérifier (voir bounds_to_check)
+ */
+static void codegen_check_array(symbol *tmp, int check)
+{
+    if (check & BOUNDS_LOW) add_instr(JUML, ' ', nb_instr + 3);
+    add_instr(SUB, '#', tmp->size);
+    add_instr(JUML, ' ', nb_instr + 2);
+    add_instr(STOP, ' ', 0);
+}
+
+
+
+/**
+ * @brief Calcule l'adresse p + indice (l'indice est dans l'ACC) en vérifiant
+ * que 0 <= indice < taille du bloc pointé par `tmp`, sinon on quitte.
+ * La taille est dans la case qui précède le bloc: en-tête des blocs
+ * d'ALLOUER, ou case réservée avant les tableaux avec --bounds-check.
+ * 
+ * @param tmp 
+ * @param check Les bornes à vérifier (voir bounds_to_check)
+ */
+static void codegen_check_pointer(symbol *tmp, int check)
+{
+    int load_len = tmp->mem_zone == 's' ? 3 : 1;
+
+    if (check & BOUNDS_LOW) add_instr(JUML, ' ', nb_instr + 8 + load_len);
+    add_instr(STORE, ' ', TMP_REG_ACC_SWP);
+    if (tmp->mem_zone == 's')
+    {
+        add_instr(LOAD, ' ', STACK_REL_START);
+        add_instr(SUB, '#', tmp->adr);
+        add_instr(LOAD, '@', 0);
+    }
+    else add_instr(LOAD, ' ', tmp->adr);
+
+    /* Pointeur nul, ou indice >= taille lue dans l'en-tête: on quitte */
+    add_instr(JUMZ, ' ', nb_instr + 6);
+    add_instr(STORE, ' ', TMP_REG_SWP);
+    add_instr(SUB, '#', 1);
+    add_instr(LOAD, '@', 0);
+    add_instr(SUB, ' ', TMP_REG_ACC_SWP);
+    add_instr(JUMG, ' ', nb_instr + 2);
+    add_instr(STOP, ' ', 0);
+
+    add_instr(LOAD, ' ', TMP_REG_SWP);
+    add_instr(ADD, ' ', TMP_REG_ACC_SWP);
+}
+
+
+
 void codegen_arr_access(ast *t)
 {
     array_access_node node = t->arr_access;
+    int check = bounds_to_check(t);
 
     codegen(node.ind_expr);
 
-    symbol *tmp = get_symbol(table, c_context, node.id->id.name);
+    symbol *tmp = get_symbol(arc_ctx.table, c_context, node.id->id.name);
 
     /*
-     * Si le tableau est dans le tas, tab[x] est la valeur située à l'adresse
-     * de tab + x.
-     * Si dans la pile, c'est la valeur située à l'adresse de tab - x.
+     * tab[x] est la valeur située à l'adresse de tab + x, que le tableau soit
+     * dans la mémoire statique ou dans la pile (l'adresse de tab est alors
+     * STACK_REL_START - adr).
      * 
      * Si c'est un pointeur il faut charger le contenu de la variable dans l'ACC
      * et ensuite calculer le décalage.
      */
     if (tmp->type == array)
     {
+        /* Après la vérification, l'ACC contient x - taille */
+        if (check) codegen_check_array(tmp, check);
+
         if (tmp->mem_zone == 's')
         {
+            if (check) add_instr(ADD, '#', tmp->size);
             add_instr(STORE, ' ', TMP_REG_ACC_SWP);
             add_instr(LOAD, ' ', STACK_REL_START);
             add_instr(SUB, '#', tmp->adr);
             add_instr(ADD, ' ', TMP_REG_ACC_SWP);
         }
-        else add_instr(ADD, '#', tmp->adr);
+        else add_instr(ADD, '#', tmp->adr + (check ? tmp->size : 0));
     }
+    else if (check) codegen_check_pointer(tmp, check);
     else
     {
         add_instr(STORE, ' ', TMP_REG_ACC_SWP);
@@ -1144,7 +1847,7 @@ void codegen_arr_access(ast *t)
         }
         else
         {
-            add_instr(LOAD, '#', tmp->adr);
+            add_instr(LOAD, ' ', tmp->adr);
             add_instr(ADD, ' ', TMP_REG_ACC_SWP);
         }
     }
@@ -1167,12 +1870,74 @@ void codegen_arr_access(ast *t)
 
 
 
+/**
+ * @brief Appelle la routine de ramOS à l'adresse `adr` (voir ram_os.h).
+ * Coûte 3 instructions.
+ * 
+ * @param adr 
+ */
+static void call_ram_os(int adr)
+{
+    cache_tag(RELOC_CODE, NULL);
+    add_instr(LOAD, '#', nb_instr + 3);
+    add_instr(STORE, ' ', ALLOC_REG_RET);
+    cache_tag(RELOC_OS, NULL);
+    add_instr(JUMP, ' ', adr);
+}
+
+
+
+/**
+ * @brief Génère le code d'ALLOUER quand le programme utilise LIBERER: le bloc
+ * est alloué par l'allocateur de ramOS.
+ * 
+ * @param t 
+ */
+static void codegen_alloc_os(ast *t)
+{
+    alloc_node node = t->alloc;
+    symbol *tmp = get_symbol(arc_ctx.table, c_context, node.id->id.name);
+
+    codegen(node.expr);
+    add_instr(STORE, ' ', ALLOC_REG_SIZE);
+    call_ram_os(ALLOC_ADR);
+
+    /* --guard: le nouveau bloc ne doit pas atteindre la pile */
+    if (guard_mode)
+    {
+        codegen_guard_heap();
+        if (tmp->mem_zone != 's') add_instr(LOAD, ' ', ALLOC_REG_BLOCK);
+    }
+
+    /* On stocke l'adresse du bloc dans le pointeur */
+    if (tmp->mem_zone == 's')
+    {
+        add_instr(LOAD, ' ', STACK_REL_START);
+        add_instr(SUB, '#', tmp->adr);
+        add_instr(STORE, ' ', TMP_REG_STK_ADR);
+        add_instr(LOAD, ' ', ALLOC_REG_BLOCK);
+        add_instr(STORE, '@', TMP_REG_STK_ADR);
+    }
+    else add_instr(STORE, ' ', tmp->adr);
+}
+
+
+
 void codegen_alloc(ast *t)
 {
     alloc_node node = t->alloc;
-    symbol *tmp = get_symbol(table, c_context, node.id->id.name);
+    symbol *tmp = get_symbol(arc_ctx.table, c_context, node.id->id.name);
+
+    if (arc_ctx.uses_free)
+    {
+        codegen_alloc_os(t);
+        return;
+    }
 
-    /* On stocke l'adresse du tas dans le pointeur */
+    /*
+     * On stocke l'adresse du tas dans le pointeur (avec --bounds-check, le
+     * bloc est précédé d'un en-tête contenant sa taille)
+     */
     if (tmp->mem_zone == 's')
     {
         add_instr(LOAD, ' ', STACK_REL_START);
@@ -1180,12 +1945,14 @@ void codegen_alloc(ast *t)
         add_instr(STORE, ' ', TMP_REG_STK_ADR);
 
         add_instr(LOAD, ' ', HEAP_REG);
+        if (bounds_check) add_instr(ADD, '#', 1);
         add_instr(STORE, '@', TMP_REG_STK_ADR);
     }
     else
     {
         add_instr(LOAD, ' ', HEAP_REG);
-        add_instr(STORE, '@', tmp->adr);
+        if (bounds_check) add_instr(ADD, '#', 1);
+        add_instr(STORE, ' ', tmp->adr);
     }
 
     /* On génère l'expression donnant la taille à allouer */
@@ -1195,7 +1962,247 @@ void codegen_alloc(ast *t)
     add_instr(JUMG, ' ', nb_instr + 2);
     add_instr(STOP, ' ', 0);
 
+    if (bounds_check)
+    {
+        add_instr(STORE, '@', HEAP_REG);
+        add_instr(INC, ' ', HEAP_REG);
+    }
+
     /* Sinon on augmente la taille du tas */
     add_instr(ADD, ' ', HEAP_REG);
     add_instr(STORE, ' ', HEAP_REG);
-}
\ No newline at end of file
+
+    /* --guard: le tas ne doit pas atteindre la pile */
+    if (guard_mode) codegen_guard_heap();
+}
+
+
+
+void codegen_free(ast *t)
+{
+    codegen(t->free_n.id);
+    add_instr(STORE, ' ', ALLOC_REG_BLOCK);
+    call_ram_os(FREE_ADR);
+}
+
+
+
+/**
+ * @brief Charge dans l'ACC l'adresse de la 1ère case du tableau ou du bloc
+ * pointé par `tmp` (voir block_base_len).
+ * 
+ * @param tmp 
+ */
+static void codegen_block_base(symbol *tmp)
+{
+    if (tmp->mem_zone == 's')
+    {
+        add_instr(LOAD, ' ', STACK_REL_START);
+        add_instr(SUB, '#', tmp->adr);
+        if (tmp->type == pointer) add_instr(LOAD, '@', 0);
+    }
+    else if (tmp->type == array) add_instr(LOAD, '#', tmp->adr);
+    else add_instr(LOAD, ' ', tmp->adr);
+}
+
+
+/**
+ * @brief Déroule COPIER ou REMPLIR pour une taille constante k
+ * (0 < k <= BLOCK_UNROLL_MAX).
+ * Les cases d'un tableau de la mémoire statique sont accédées directement,
+ * sinon l'adresse est dans BLOCK_REG_DST (ou BLOCK_REG_SRC) et incrémentée
+ * après chaque case.
+ * 
+ * @param t 
+ * @param dst 
+ * @param src Le tableau source (NULL pour REMPLIR)
+ * @param k 
+ */
+static void codegen_block_unrolled(ast *t, symbol *dst, symbol *src, int k)
+{
+    int dst_direct = dst->type == array && dst->mem_zone != 's';
+    int src_direct = src != NULL && src->type == array && src->mem_zone != 's';
+    int i;
+
+    if (src == NULL)
+    {
+        codegen(t->block.src);
+        if (!dst_direct)
+        {
+            add_instr(STORE, ' ', BLOCK_REG_SRC);
+            codegen_block_base(dst);
+            add_instr(STORE, ' ', BLOCK_REG_DST);
+            add_instr(LOAD, ' ', BLOCK_REG_SRC);
+        }
+
+        for (i = 0; i < k; i++)
+        {
+            if (dst_direct) add_instr(STORE, ' ', dst->adr + i);
+            else
+            {
+                add_instr(STORE, '@', BLOCK_REG_DST);
+                if (i < k - 1) add_instr(INC, ' ', BLOCK_REG_DST);
+            }
+        }
+        return;
+    }
+
+    if (!src_direct)
+    {
+        codegen_block_base(src);
+        add_instr(STORE, ' ', BLOCK_REG_SRC);
+    }
+    if (!dst_direct)
+    {
+        codegen_block_base(dst);
+        add_instr(STORE, ' ', BLOCK_REG_DST);
+    }
+
+    for (i = 0; i < k; i++)
+    {
+        if (src_direct) add_instr(LOAD, ' ', src->adr + i);
+        else add_instr(LOAD, '@', BLOCK_REG_SRC);
+
+        if (dst_direct) add_instr(STORE, ' ', dst->adr + i);
+        else add_instr(STORE, '@', BLOCK_REG_DST);
+
+        if (i == k - 1) continue;
+        if (!src_direct) add_instr(INC, ' ', BLOCK_REG_SRC);
+        if (!dst_direct) add_instr(INC, ' ', BLOCK_REG_DST);
+    }
+}
+
+
+/**
+ * @brief Génère le code de COPIER (op = 'c') et de REMPLIR (op = 'f').
+ * Si la taille est une petite constante la boucle est déroulée, sinon les
+ * adresses de destination et de source sont dans BLOCK_REG_DST et
+ * BLOCK_REG_SRC (la valeur à écrire pour REMPLIR) et le nombre de cases
+ * restantes dans BLOCK_REG_CNT:
+ * 
+ * L: LOAD @BLOCK_REG_SRC   (LOAD BLOCK_REG_SRC pour REMPLIR)
+ *    STORE @BLOCK_REG_DST
+ *    INC BLOCK_REG_SRC     (seulement pour COPIER)
+ *    INC BLOCK_REG_DST
+ *    DEC BLOCK_REG_CNT
+ *    LOAD BLOCK_REG_CNT
+ *    JUMG L
+ * 
+ * Rien n'est fait si la taille est <= 0. La copie se fait dans l'ordre
+ * croissant des adresses.
+ * 
+ * @param t 
+ */
+void codegen_block(ast *t)
+{
+    block_node node = t->block;
+    symbol *dst = get_symbol(arc_ctx.table, c_context, node.dst->id.name);
+    symbol *src = NULL;
+    if (node.op == 'c')
+    {
+        src = get_symbol(arc_ctx.table, c_context, node.src->id.name);
+    }
+
+    if (node.size->type == nb_type && node.size->nb.val <= BLOCK_UNROLL_MAX)
+    {
+        if (node.size->nb.val > 0)
+        {
+            codegen_block_unrolled(t, dst, src, node.size->nb.val);
+        }
+        else if (src == NULL) codegen(node.src);
+        return;
+    }
+
+    /* Adresse de fin: après la boucle */
+    int end_adr = nb_instr + t->codelen;
+    int is_simple = node.src->type == nb_type || node.src->type == id_type;
+
+    codegen(node.size);
+
+    /* La valeur peut appeler une fonction qui modifierait les registres */
+    if (src == NULL && !is_simple)
+    {
+        push();
+        codegen(node.src);
+        add_instr(STORE, ' ', BLOCK_REG_SRC);
+        pop();
+    }
+
+    add_instr(JUMZ, ' ', end_adr);
+    add_instr(JUML, ' ', end_adr);
+    add_instr(STORE, ' ', BLOCK_REG_CNT);
+
+    if (src == NULL && is_simple) codegen(node.src);
+    else if (src != NULL) codegen_block_base(src);
+    if (src != NULL || is_simple) add_instr(STORE, ' ', BLOCK_REG_SRC);
+
+    codegen_block_base(dst);
+    add_instr(STORE, ' ', BLOCK_REG_DST);
+
+    int loop_adr = nb_instr;
+    if (src == NULL) add_instr(LOAD, ' ', BLOCK_REG_SRC);
+    else add_instr(LOAD, '@', BLOCK_REG_SRC);
+    add_instr(STORE, '@', BLOCK_REG_DST);
+    if (src != NULL) add_instr(INC, ' ', BLOCK_REG_SRC);
+    add_instr(INC, ' ', BLOCK_REG_DST);
+    add_instr(DEC, ' ', BLOCK_REG_CNT);
+    add_instr(LOAD, ' ', BLOCK_REG_CNT);
+    add_instr(JUMG, ' ', loop_adr);
+}
+
+
+/**
+ * @brief Génère le code de LIRE_TABLEAU (mode 'R') et d'ECRIRE_TABLEAU
+ * (mode 'W'): l'adresse de la case courante est dans BLOCK_REG_DST (ou
+ * BLOCK_REG_SRC) et le nombre de cases restantes dans BLOCK_REG_CNT.
+ * 
+ * L: READ                  LOAD @BLOCK_REG_SRC
+ *    STORE @BLOCK_REG_DST  WRITE
+ *    INC BLOCK_REG_DST     INC BLOCK_REG_SRC
+ *    DEC BLOCK_REG_CNT
+ *    LOAD BLOCK_REG_CNT
+ *    JUMG L
+ * 
+ * Rien n'est fait si la taille est <= 0. Les cases ne sont pas vérifiées par
+ * --bounds-check (comme pour COPIER et REMPLIR).
+ * 
+ * @param t 
+ */
+void codegen_io_tab(ast *t)
+{
+    io_node node = t->io;
+    symbol *tmp = get_symbol(arc_ctx.table, c_context, node.id->id.name);
+    int reg = node.mode == 'R' ? BLOCK_REG_DST : BLOCK_REG_SRC;
+
+    if (node.expr->type == nb_type && node.expr->nb.val <= 0) return;
+
+    /* Adresse de fin: après la boucle */
+    int end_adr = nb_instr + t->codelen;
+
+    codegen(node.expr);
+    if (node.expr->type != nb_type)
+    {
+        add_instr(JUMZ, ' ', end_adr);
+        add_instr(JUML, ' ', end_adr);
+    }
+    add_instr(STORE, ' ', BLOCK_REG_CNT);
+
+    codegen_block_base(tmp);
+    add_instr(STORE, ' ', reg);
+
+    int loop_adr = nb_instr;
+    if (node.mode == 'R')
+    {
+        add_instr(READ, ' ', 0);
+        add_instr(STORE, '@', reg);
+    }
+    else
+    {
+        add_instr(LOAD, '@', reg);
+        add_instr(WRITE, ' ', 0);
+    }
+    add_instr(INC, ' ', reg);
+    add_instr(DEC, ' ', BLOCK_REG_CNT);
+    add_instr(LOAD, ' ', BLOCK_REG_CNT);
+    add_instr(JUMG, ' ', loop_adr);
+}
@@ -0,0 +1,4505 @@
+#include "optim.h"
+#include "arc_utils.h"
+#include "semantic.h"       /* Pour PUSH_COST */
+#include "codegen.h"        /* Pour BLOCK_UNROLL_MAX */
+#include "arc_context.h"
+#include <string.h>
+#include <stdio.h>
+
+
+/*
+ * L'optimiseur travaille avant l'analyse sémantique: la table des symboles
+ * n'existe donc pas encore. On construit ici une version simplifiée des
+ * informations dont on a besoin (type et zone mémoire des variables, graphe
+ * d'appel, variables dont l'adresse est prise).
+ */
+
+
+/*
+ * Variable vue par l'optimiseur (équivalent simplifié d'un symbole).
+ * is_const: 1 pour un paramètre qui vaut `val` à chaque appel (voir
+ * find_const_params), ou une variable temporaire de LICM qui en contient un
+ */
+typedef struct _optim_var {
+    char id[ID_MAX_SIZE];
+    type_symb type;
+    char mem_zone;
+    int is_addr_taken;
+    int nb_cols;
+    int size;
+    int is_const;
+    int val;
+    struct _optim_var *next;
+} optim_var;
+
+
+/* Liste de noms (fonctions appelées, variables modifiées, etc.) */
+typedef struct _name_list {
+    char id[ID_MAX_SIZE];
+    struct _name_list *next;
+} name_list;
+
+
+/* Appel d'une fonction: le noeud func_call et la fonction qui le contient */
+typedef struct _call_site {
+    ast *call;
+    struct _optim_func *caller;
+    struct _call_site *next;
+} call_site;
+
+
+/*
+ * Fonction du programme.
+ * node: le noeud func_decla
+ * locals: paramètres et variables locales
+ * callees: les fonctions appelées
+ * calls: les appels de la fonction (seulement pendant collect_program)
+ * is_recursive: 1 si la fonction peut s'appeler elle-même (directement ou non).
+ * Si ça n'est pas le cas, une seule instance de la fonction peut être en cours
+ * d'exécution, et ses variables temporaires peuvent être placées dans la
+ * mémoire statique (1 instruction par accès au lieu de 4 dans la pile).
+ */
+typedef struct _optim_func {
+    ast *node;
+    optim_var *locals;
+    name_list *callees;
+    call_site *calls;
+    int is_recursive;
+    int is_visited;
+    struct _optim_func *next;
+} optim_func;
+
+
+/*
+ * Effets de bord d'une portion de code (typiquement une boucle).
+ * modified: les variables affectées
+ * has_call: contient un appel de fonction
+ * has_ptr_write: contient une écriture via un pointeur (*p <- ou p[i] <-)
+ * has_arr_write: contient une écriture dans un tableau (T[i] <-)
+ * has_aliased_write: affecte une variable dont l'adresse est prise
+ * has_io: contient un LIRE
+ */
+typedef struct {
+    name_list *modified;
+    int has_call;
+    int has_ptr_write;
+    int has_arr_write;
+    int has_aliased_write;
+    int has_io;
+} effects;
+
+
+/* Expression sortie d'une boucle et variable temporaire qui la contient */
+typedef struct _hoisted {
+    ast *expr;
+    char tmp[ID_MAX_SIZE];
+    struct _hoisted *next;
+} hoisted;
+
+
+/* Liste d'emplacements d'expressions dans l'ASA */
+typedef struct _slot_list {
+    ast **slot;
+    struct _slot_list *next;
+} slot_list;
+
+
+/*
+ * Position d'une expression dans une boucle (voir licm_expr). MAYBE_POS est
+ * ajouté à BODY_POS si l'expression n'est pas évaluée à chaque itération.
+ */
+#define COND_POS 0
+#define BODY_POS 1
+#define MAYBE_POS 2
+
+
+static ast *prog = NULL;
+static optim_var *globals = NULL;
+static optim_func *funcs = NULL;
+static optim_func *cur_func = NULL;
+
+extern int is_dbg_mode;
+extern int bounds_check;
+
+/* Compteur pour le nom des variables temporaires */
+static int nb_tmp = 0;
+
+
+
+/************************* Infos sur le programme *************************/
+
+
+static name_list *add_name(name_list *l, const char *id)
+{
+    name_list *aux;
+    for (aux = l; aux != NULL; aux = aux->next)
+    {
+        if (strcmp(aux->id, id) == 0) return l;
+    }
+
+    aux = (name_list *) malloc(sizeof(name_list));
+    check_alloc(aux);
+    strcpy(aux->id, id);
+    aux->next = l;
+
+    return aux;
+}
+
+
+static int has_name(name_list *l, const char *id)
+{
+    for (; l != NULL; l = l->next)
+    {
+        if (strcmp(l->id, id) == 0) return 1;
+    }
+
+    return 0;
+}
+
+
+static void free_names(name_list *l)
+{
+    name_list *aux;
+    while (l != NULL)
+    {
+        aux = l->next;
+        free(l);
+        l = aux;
+    }
+}
+
+
+static optim_var *add_var(optim_var *l, const char *id, type_symb t, char zone)
+{
+    optim_var *v = (optim_var *) calloc(1, sizeof(optim_var));
+    check_alloc(v);
+
+    strcpy(v->id, id);
+    v->type = t;
+    v->mem_zone = zone;
+    v->next = l;
+
+    return v;
+}
+
+
+static void free_vars(optim_var *l)
+{
+    optim_var *aux;
+    while (l != NULL)
+    {
+        aux = l->next;
+        free(l);
+        l = aux;
+    }
+}
+
+
+/**
+ * @brief Ajoute les variables déclarées dans la liste de déclarations de
+ * variables `t` (chaîne de var_decla).
+ *
+ * @param l
+ * @param t
+ * @param zone
+ * @return optim_var*
+ */
+static optim_var *add_var_decla(optim_var *l, ast *t, char zone)
+{
+    for (; t != NULL; t = t->var_decla.next)
+    {
+        ast *var = t->var_decla.var;
+        int nb_cols = 0, size = 0;
+        if (t->var_decla.type == array)
+        {
+            nb_cols = var->arr_decla.nb_cols;
+            size = var->arr_decla.size;
+            var = var->arr_decla.id;
+        }
+        l = add_var(l, var->id.name, t->var_decla.type, zone);
+        l->nb_cols = nb_cols;
+        l->size = size;
+    }
+
+    return l;
+}
+
+
+/**
+ * @brief Cherche la variable `id` dans le contexte de la fonction courante
+ * puis dans le contexte global (comme get_symbol).
+ * Renvoie NULL si elle n'existe pas (l'erreur sera levée par l'analyse
+ * sémantique).
+ *
+ * @param id
+ * @return optim_var*
+ */
+static optim_var *lookup(const char *id)
+{
+    optim_var *aux;
+    if (cur_func != NULL)
+    {
+        for (aux = cur_func->locals; aux != NULL; aux = aux->next)
+        {
+            if (strcmp(aux->id, id) == 0) return aux;
+        }
+    }
+
+    for (aux = globals; aux != NULL; aux = aux->next)
+    {
+        if (strcmp(aux->id, id) == 0) return aux;
+    }
+
+    return NULL;
+}
+
+
+static optim_func *search_func(const char *id)
+{
+    optim_func *aux;
+    for (aux = funcs; aux != NULL; aux = aux->next)
+    {
+        if (strcmp(aux->node->func_decla.id->id.name, id) == 0) return aux;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief Ajoute l'appel `t`, fait depuis la fonction courante, aux appels de
+ * la fonction appelée.
+ *
+ * @param t
+ */
+static void add_call_site(ast *t)
+{
+    optim_func *callee = search_func(t->func_call.func_id->id.name);
+    if (callee == NULL) return;
+
+    call_site *c = (call_site *) malloc(sizeof(call_site));
+    check_alloc(c);
+    c->call = t;
+    c->caller = cur_func;
+    c->next = callee->calls;
+    callee->calls = c;
+}
+
+
+/**
+ * @brief Parcourt le corps d'une fonction pour relever les fonctions appelées
+ * et les variables dont l'adresse est prise (opérateur @).
+ * Les accès T[i][j] sont aussi remplacés par T[i * m + j] (voir
+ * flatten_arr_access).
+ *
+ * @param t
+ */
+static void scan_func_body(ast *t)
+{
+    optim_var *v;
+
+    if (t == NULL) return;
+
+    switch (t->type)
+    {
+    case b_op_type:
+        scan_func_body(t->b_op.l_memb);
+        scan_func_body(t->b_op.r_memb);
+        break;
+    case u_op_type:
+        if (t->u_op.ope == '@')
+        {
+            v = lookup(t->u_op.child->id.name);
+            if (v != NULL) v->is_addr_taken = 1;
+        }
+        scan_func_body(t->u_op.child);
+        break;
+    case affect_type:
+        scan_func_body(t->affect.expr);
+        break;
+    case instr_type:
+        scan_func_body(t->list_instr.instr);
+        scan_func_body(t->list_instr.next);
+        break;
+    case decla_type:
+        scan_func_body(t->decla_list.decla);
+        scan_func_body(t->decla_list.next);
+        break;
+    case var_decla_type:
+        scan_func_body(t->var_decla.expr);
+        if (t->var_decla.type == array)
+        {
+            scan_func_body(t->var_decla.var->arr_decla.list_expr);
+        }
+        scan_func_body(t->var_decla.next);
+        break;
+    case while_type:
+        scan_func_body(t->while_n.expr);
+        scan_func_body(t->while_n.list_instr);
+        break;
+    case do_while_type:
+        scan_func_body(t->do_while.list_instr);
+        scan_func_body(t->do_while.expr);
+        break;
+    case if_type:
+        scan_func_body(t->if_n.expr);
+        scan_func_body(t->if_n.list_instr1);
+        scan_func_body(t->if_n.list_instr2);
+        break;
+    case switch_type:
+        scan_func_body(t->switch_n.expr);
+        scan_func_body(t->switch_n.cases);
+        scan_func_body(t->switch_n.default_instr);
+        break;
+    case case_type:
+        scan_func_body(t->case_n.list_instr);
+        scan_func_body(t->case_n.next);
+        break;
+    case for_type:
+        scan_func_body(t->for_n.affect_init);
+        scan_func_body(t->for_n.end_exp);
+        scan_func_body(t->for_n.list_instr);
+        break;
+    case io_type:
+        scan_func_body(t->io.expr);
+        break;
+    case func_call_type:
+        cur_func->callees = add_name(cur_func->callees,
+                                     t->func_call.func_id->id.name);
+        add_call_site(t);
+        scan_func_body(t->func_call.params);
+        break;
+    case exp_list_type:
+        scan_func_body(t->exp_list.exp);
+        scan_func_body(t->exp_list.next);
+        break;
+    case return_type:
+        scan_func_body(t->return_n.expr);
+        break;
+    case array_access_type:
+        /* T[i][j] devient T[i * m + j] pour les passes suivantes */
+        v = lookup(t->arr_access.id->id.name);
+        if (v != NULL && v->nb_cols > 0) flatten_arr_access(t, v->nb_cols);
+        scan_func_body(t->arr_access.ind_expr);
+        scan_func_body(t->arr_access.col_expr);
+        scan_func_body(t->arr_access.affect_expr);
+        break;
+    case alloc_type:
+        scan_func_body(t->alloc.expr);
+        break;
+    case block_type:
+        scan_func_body(t->block.src);
+        scan_func_body(t->block.size);
+        break;
+    default:
+        break;
+    }
+}
+
+
+static optim_func *add_func(ast *t)
+{
+    optim_func *f = (optim_func *) calloc(1, sizeof(optim_func));
+    check_alloc(f);
+
+    f->node = t;
+    f->next = funcs;
+    funcs = f;
+
+    /* Les variables de toutes les fonctions sont dans la pile */
+    f->locals = add_var_decla(NULL, t->func_decla.params, 's');
+
+    ast *aux;
+    for (aux = t->func_decla.list_decl; aux != NULL; aux = aux->decla_list.next)
+    {
+        f->locals = add_var_decla(f->locals, aux->decla_list.decla, 's');
+    }
+
+    return f;
+}
+
+
+/**
+ * @brief Renvoie 1 si la fonction `target` est atteignable depuis `f` dans le
+ * graphe d'appel.
+ *
+ * @param f
+ * @param target
+ * @return int
+ */
+static int can_reach(optim_func *f, optim_func *target)
+{
+    name_list *aux;
+    for (aux = f->callees; aux != NULL; aux = aux->next)
+    {
+        optim_func *callee = search_func(aux->id);
+        if (callee == NULL || callee->is_visited) continue;
+        if (callee == target) return 1;
+
+        callee->is_visited = 1;
+        if (can_reach(callee, target)) return 1;
+    }
+
+    return 0;
+}
+
+
+static int fold_const(ast *t, int *val);
+static void collect_effects(ast *t, effects *eff);
+
+
+/**
+ * @brief Renvoie 1 si le paramètre de rang `param` de la fonction `f` reçoit
+ * la même valeur à chaque appel: une constante, ou un paramètre constant de
+ * la fonction appelante.
+ *
+ * @param f
+ * @param param
+ * @param val La valeur du paramètre
+ * @return int
+ */
+static int param_value(optim_func *f, int param, int *val)
+{
+    call_site *c;
+    optim_var *v;
+    ast *arg;
+    int i, x;
+
+    if (f->calls == NULL) return 0;
+
+    for (c = f->calls; c != NULL; c = c->next)
+    {
+        arg = c->call->func_call.params;
+        for (i = 0; arg != NULL && i < param; i++) arg = arg->exp_list.next;
+        if (arg == NULL) return 0;
+
+        arg = arg->exp_list.exp;
+        if (arg->type == id_type)
+        {
+            cur_func = c->caller;
+            v = lookup(arg->id.name);
+            if (v == NULL || !v->is_const) return 0;
+            x = v->val;
+        }
+        else if (!fold_const(arg, &x)) return 0;
+
+        if (c != f->calls && x != *val) return 0;
+        *val = x;
+    }
+
+    return 1;
+}
+
+
+/**
+ * @brief Relève les paramètres entiers qui reçoivent la même valeur à chaque
+ * appel et ne sont jamais modifiés (voir fold_bound). Un paramètre peut
+ * recevoir un paramètre constant de l'appelant: on recommence tant qu'on en
+ * trouve de nouveaux.
+ */
+static void find_const_params()
+{
+    optim_func *f;
+    optim_var *v;
+    ast *p;
+    int i, val, is_changed = 1;
+
+    while (is_changed)
+    {
+        is_changed = 0;
+        for (f = funcs; f != NULL; f = f->next)
+        {
+            effects eff = {0};
+            collect_effects(f->node->func_decla.list_instr, &eff);
+
+            p = f->node->func_decla.params;
+            for (i = 0; p != NULL; p = p->var_decla.next, i++)
+            {
+                cur_func = f;
+                v = lookup(p->var_decla.var->id.name);
+                if (v == NULL || v->is_const || v->type != integer
+                    || v->is_addr_taken || has_name(eff.modified, v->id))
+                {
+                    continue;
+                }
+
+                if (param_value(f, i, &val))
+                {
+                    v->is_const = 1;
+                    v->val = val;
+                    is_changed = 1;
+                }
+            }
+            free_names(eff.modified);
+        }
+    }
+    cur_func = NULL;
+}
+
+
+static void free_calls(optim_func *f)
+{
+    call_site *aux;
+    while (f->calls != NULL)
+    {
+        aux = f->calls->next;
+        free(f->calls);
+        f->calls = aux;
+    }
+}
+
+
+/**
+ * @brief Construit les informations nécessaires aux optimisations: variables
+ * globales, variables locales de chaque fonction, graphe d'appel, paramètres
+ * constants.
+ *
+ * @param t La racine de l'ASA
+ */
+static void collect_program(ast *t)
+{
+    prog = t;
+    ast *aux;
+    optim_func *f, *g;
+
+    for (aux = t->root.list_decl; aux != NULL; aux = aux->decla_list.next)
+    {
+        ast *d = aux->decla_list.decla;
+        if (d->type == var_decla_type) globals = add_var_decla(globals, d, 'h');
+        else if (d->type == func_decla_type) add_func(d);
+    }
+    add_func(t->root.main_prog);
+
+    /* Appels et variables dont l'adresse est prise */
+    for (f = funcs; f != NULL; f = f->next)
+    {
+        cur_func = f;
+        scan_func_body(f->node->func_decla.list_decl);
+        scan_func_body(f->node->func_decla.list_instr);
+    }
+    cur_func = NULL;
+
+    /* Fonctions récursives */
+    for (f = funcs; f != NULL; f = f->next)
+    {
+        for (g = funcs; g != NULL; g = g->next) g->is_visited = 0;
+        f->is_recursive = can_reach(f, f);
+    }
+
+    /* Les appels ne sont plus valides une fois l'ASA modifié */
+    find_const_params();
+    for (f = funcs; f != NULL; f = f->next) free_calls(f);
+}
+
+
+static void free_program_info()
+{
+    optim_func *aux;
+    while (funcs != NULL)
+    {
+        aux = funcs->next;
+        free_vars(funcs->locals);
+        free_names(funcs->callees);
+        free(funcs);
+        funcs = aux;
+    }
+
+    free_vars(globals);
+    globals = NULL;
+    cur_func = NULL;
+    prog = NULL;
+}
+
+
+
+/****************************** Utilitaires ******************************/
+
+
+/**
+ * @brief Position de l'expression `t` dans le source, de son premier opérande
+ * à son dernier. La position d'un noeud opérateur est celle du token qui suit
+ * l'expression (voir init_ast): une constante qui remplace l'expression prend
+ * celle-ci, pour que les diagnostics pointent au même endroit qu'en -O0.
+ *
+ * @param t
+ * @return YYLTYPE
+ */
+static YYLTYPE expr_pos(ast *t)
+{
+    ast *first = t;
+    ast *last = t;
+    while (first->type == b_op_type || first->type == u_op_type)
+    {
+        if (first->type == b_op_type) first = first->b_op.l_memb;
+        else first = first->u_op.child;
+    }
+    while (last->type == b_op_type || last->type == u_op_type)
+    {
+        if (last->type == b_op_type) last = last->b_op.r_memb;
+        else last = last->u_op.child;
+    }
+
+    YYLTYPE pos = first->pos_infos;
+    pos.last_line = last->pos_infos.last_line;
+    pos.last_column = last->pos_infos.last_column;
+
+    return pos;
+}
+
+
+/**
+ * @brief Estimation du nombre d'instructions RAM générées pour l'expression.
+ * Reprend les coûts calculés dans semantic.c (les variables temporaires
+ * n'existant pas encore dans la table des symboles, on ne peut pas utiliser
+ * directement le codelen).
+ *
+ * @param t
+ * @return int
+ */
+static int expr_cost(ast *t)
+{
+    optim_var *v;
+    int cost, check;
+
+    if (t == NULL) return 0;
+
+    switch (t->type)
+    {
+    case nb_type:
+        return 1;
+    case id_type:
+        v = lookup(t->id.name);
+        if (v == NULL || v->mem_zone == 'h') return 1;
+        return v->type == array ? 2 : 4;
+    case b_op_type:
+        cost = expr_cost(t->b_op.l_memb) + expr_cost(t->b_op.r_memb);
+        switch (t->b_op.ope)
+        {
+        case AND_OP:
+            return cost + 5;
+        case OR_OP:
+            return cost + 6;
+        case '<':
+        case '>':
+        case '=':
+        case NE_OP:
+            return cost + 8;
+        case LE_OP:
+        case GE_OP:
+            return cost + 9;
+        default:
+            return cost + 4;
+        }
+    case u_op_type:
+        if (t->u_op.ope == NOT_OP) return expr_cost(t->u_op.child) + 4;
+        if (t->u_op.ope == '-') return expr_cost(t->u_op.child) + 1;
+
+        v = lookup(t->u_op.child->id.name);
+        if (v == NULL || v->mem_zone == 'h') return 1;
+        return t->u_op.ope == '@' ? 2 : 4;
+    case array_access_type:
+        v = lookup(t->arr_access.id->id.name);
+        cost = expr_cost(t->arr_access.ind_expr) + 1;
+
+        /* Vérification des bornes (--bounds-check) */
+        check = bounds_to_check(t);
+        if (check & BOUNDS_LOW) cost += 1;
+        if (v == NULL) return cost;
+        if (v->type == array)
+        {
+            if (check) cost += v->mem_zone == 's' ? 4 : 3;
+            return cost + (v->mem_zone == 's' ? 4 : 1);
+        }
+        if (check) cost += 8;
+        return cost + (v->mem_zone == 's' ? 5 : 3);
+    case func_call_type:
+        cost = 24;
+        for (t = t->func_call.params; t != NULL; t = t->exp_list.next)
+        {
+            cost += 2 + expr_cost(t->exp_list.exp);
+        }
+        return cost;
+    default:
+        return 1;
+    }
+}
+
+
+/**
+ * @brief Estimation du nombre d'instructions RAM générées pour une
+ * instruction ou une liste d'instructions (voir semantic.c).
+ *
+ * @param t
+ * @return int
+ */
+static int code_cost(ast *t)
+{
+    optim_var *v;
+    ast *aux;
+    int cost, is_stack;
+
+    if (t == NULL) return 0;
+
+    switch (t->type)
+    {
+    case instr_type:
+        cost = 0;
+        for (; t != NULL; t = t->list_instr.next)
+        {
+            cost += code_cost(t->list_instr.instr);
+            if (t->list_instr.instr->type == return_type) break;
+        }
+        return cost;
+    case affect_type:
+        v = lookup(t->affect.id->id.name);
+        is_stack = v != NULL && v->mem_zone == 's';
+        cost = expr_cost(t->affect.expr) + (is_stack ? 6 : 1);
+        return cost + (t->affect.is_deref && is_stack);
+    case io_type:
+        /* Boucle de LIRE_TABLEAU et d'ECRIRE_TABLEAU (voir block_type) */
+        if (t->io.id != NULL) return expr_cost(t->io.expr) + 18;
+        return 1 + expr_cost(t->io.expr);
+    case while_type:
+        return expr_cost(t->while_n.expr) + code_cost(t->while_n.list_instr) + 2;
+    case do_while_type:
+        return expr_cost(t->do_while.expr) + code_cost(t->do_while.list_instr)
+               + 2;
+    case if_type:
+        return expr_cost(t->if_n.expr) + code_cost(t->if_n.list_instr1)
+               + code_cost(t->if_n.list_instr2) + 2;
+    case switch_type:
+        /* Au + 5 instructions par CAS pour le choix du CAS et le JUMP */
+        cost = expr_cost(t->switch_n.expr) + 1
+               + code_cost(t->switch_n.default_instr);
+        for (aux = t->switch_n.cases; aux != NULL; aux = aux->case_n.next)
+        {
+            cost += code_cost(aux->case_n.list_instr) + 5;
+        }
+        return cost;
+    case for_type:
+        v = lookup(t->for_n.id->id.name);
+        is_stack = v != NULL && v->mem_zone == 's';
+        return code_cost(t->for_n.affect_init) + expr_cost(t->for_n.end_exp)
+               + code_cost(t->for_n.list_instr) + (is_stack ? 6 : 3);
+    case return_type:
+        cost = t->return_n.expr == NULL ? 1 : expr_cost(t->return_n.expr);
+        if (cur_func->node == prog->root.main_prog) return cost + 1;
+        return cost + 10 + PUSH_COST;
+    case array_access_type:
+        if (t->arr_access.affect_expr == NULL) return expr_cost(t);
+        return expr_cost(t) + 7 + expr_cost(t->arr_access.affect_expr);
+    case alloc_type:
+        v = lookup(t->alloc.id->id.name);
+        is_stack = v != NULL && v->mem_zone == 's';
+        if (arc_ctx.uses_free) cost = is_stack ? 9 : 5;
+        else cost = is_stack ? 9 : 6;
+        return expr_cost(t->alloc.expr) + cost;
+    case inc_type:
+        v = lookup(t->inc.id->id.name);
+        return v != NULL && v->mem_zone == 's' ? 4 : 1;
+    case free_type:
+        return expr_cost(t->free_n.id) + 4;
+    case block_type:
+        /* Déroulé si la taille est une petite constante (3 instr. par case) */
+        cost = expr_cost(t->block.src) + expr_cost(t->block.size);
+        if (t->block.size->type == nb_type
+            && t->block.size->nb.val <= BLOCK_UNROLL_MAX)
+        {
+            return cost + 3 * t->block.size->nb.val + 4;
+        }
+        return cost + 18;
+    default:
+        return expr_cost(t);
+    }
+}
+
+
+/**
+ * @brief Évalue l'expression si elle ne dépend que de constantes.
+ *
+ * @param t
+ * @param val La valeur de l'expression (si constante)
+ * @return int 1 si l'expression est constante, 0 sinon
+ */
+static int fold_const(ast *t, int *val)
+{
+    int l, r;
+
+    switch (t->type)
+    {
+    case nb_type:
+        *val = t->nb.val;
+        return 1;
+    case u_op_type:
+        if (t->u_op.ope != '-' && t->u_op.ope != NOT_OP) return 0;
+        if (!fold_const(t->u_op.child, &l)) return 0;
+        *val = t->u_op.ope == '-' ? -l : !l;
+        return 1;
+    case b_op_type:
+        if (!fold_const(t->b_op.l_memb, &l)) return 0;
+
+        /* Évaluation paresseuse: l'opérande droit n'est pas évalué */
+        if ((t->b_op.ope == AND_OP && !l) || (t->b_op.ope == OR_OP && l))
+        {
+            *val = t->b_op.ope == OR_OP;
+            return 1;
+        }
+
+        if (!fold_const(t->b_op.r_memb, &r)) return 0;
+
+        switch (t->b_op.ope)
+        {
+        case '+':
+            *val = l + r;
+            return 1;
+        case '-':
+            *val = l - r;
+            return 1;
+        case '*':
+            *val = l * r;
+            return 1;
+        case '/':
+            if (r == 0) return 0;
+            *val = l / r;
+            return 1;
+        case '%':
+            if (r == 0) return 0;
+            *val = l % r;
+            return 1;
+        case '<':
+            *val = l < r;
+            return 1;
+        case '>':
+            *val = l > r;
+            return 1;
+        case '=':
+            *val = l == r;
+            return 1;
+        case NE_OP:
+            *val = l != r;
+            return 1;
+        case LE_OP:
+            *val = l <= r;
+            return 1;
+        case GE_OP:
+            *val = l >= r;
+            return 1;
+        case AND_OP:
+            *val = l && r;
+            return 1;
+        case OR_OP:
+            *val = l || r;
+            return 1;
+        default:
+            return 0;
+        }
+    default:
+        return 0;
+    }
+}
+
+
+/**
+ * @brief Comme fold_const, mais un paramètre constant (voir
+ * find_const_params) est remplacé par sa valeur. Ne sert qu'à estimer le
+ * nombre d'itérations d'une boucle: l'expression n'est pas remplacée.
+ *
+ * @param t
+ * @param val
+ * @return int
+ */
+static int fold_bound(ast *t, int *val)
+{
+    if (t->type == id_type)
+    {
+        optim_var *v = lookup(t->id.name);
+        if (v == NULL || !v->is_const) return 0;
+
+        *val = v->val;
+        return 1;
+    }
+
+    return fold_const(t, val);
+}
+
+
+/**
+ * @brief Renvoie 1 si les 2 expressions sont identiques.
+ *
+ * @param a
+ * @param b
+ * @return int
+ */
+static int expr_equal(ast *a, ast *b)
+{
+    if (a == NULL || b == NULL) return a == b;
+    if (a->type != b->type) return 0;
+
+    switch (a->type)
+    {
+    case nb_type:
+        return a->nb.val == b->nb.val;
+    case id_type:
+        return strcmp(a->id.name, b->id.name) == 0;
+    case b_op_type:
+        return a->b_op.ope == b->b_op.ope
+               && expr_equal(a->b_op.l_memb, b->b_op.l_memb)
+               && expr_equal(a->b_op.r_memb, b->b_op.r_memb);
+    case u_op_type:
+        return a->u_op.ope == b->u_op.ope
+               && expr_equal(a->u_op.child, b->u_op.child);
+    case array_access_type:
+        return a->arr_access.affect_expr == NULL
+               && b->arr_access.affect_expr == NULL
+               && expr_equal(a->arr_access.id, b->arr_access.id)
+               && expr_equal(a->arr_access.ind_expr, b->arr_access.ind_expr);
+    default:
+        /* Appels de fonctions, LIRE, etc. ne sont jamais identiques */
+        return 0;
+    }
+}
+
+
+/**
+ * @brief Renvoie 1 si l'évaluation de l'expression peut échouer à
+ * l'exécution (division par 0, accès mémoire via un pointeur invalide).
+ * De telles expressions ne peuvent pas être évaluées si elles ne l'auraient
+ * pas été dans le programme d'origine.
+ *
+ * @param t
+ * @return int
+ */
+static int may_trap(ast *t)
+{
+    if (t == NULL) return 0;
+
+    switch (t->type)
+    {
+    case b_op_type:
+        if (t->b_op.ope == '/' || t->b_op.ope == '%') return 1;
+        return may_trap(t->b_op.l_memb) || may_trap(t->b_op.r_memb);
+    case u_op_type:
+        return t->u_op.ope == '*' || may_trap(t->u_op.child);
+    case array_access_type:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+
+/**
+ * @brief Renvoie 1 si l'évaluation de l'expression n'a pas d'effet de bord
+ * (pas d'appel de fonction ni de LIRE): l'évaluer une fois de plus ne change
+ * pas le comportement du programme.
+ *
+ * @param t
+ * @return int
+ */
+static int is_pure(ast *t)
+{
+    if (t == NULL) return 1;
+
+    switch (t->type)
+    {
+    case b_op_type:
+        return is_pure(t->b_op.l_memb) && is_pure(t->b_op.r_memb);
+    case u_op_type:
+        return is_pure(t->u_op.child);
+    case array_access_type:
+        return is_pure(t->arr_access.ind_expr)
+               && is_pure(t->arr_access.affect_expr);
+    case func_call_type:
+    case io_type:
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+
+static void set_modified(effects *eff, const char *id)
+{
+    eff->modified = add_name(eff->modified, id);
+
+    optim_var *v = lookup(id);
+    if (v != NULL && v->is_addr_taken) eff->has_aliased_write = 1;
+}
+
+
+/**
+ * @brief Relève les effets de bord de `t` (instruction ou expression).
+ *
+ * @param t
+ * @param eff
+ */
+static void collect_effects(ast *t, effects *eff)
+{
+    optim_var *v;
+
+    if (t == NULL) return;
+
+    switch (t->type)
+    {
+    case b_op_type:
+        collect_effects(t->b_op.l_memb, eff);
+        collect_effects(t->b_op.r_memb, eff);
+        break;
+    case u_op_type:
+        collect_effects(t->u_op.child, eff);
+        break;
+    case affect_type:
+        if (t->affect.is_deref) eff->has_ptr_write = 1;
+        else set_modified(eff, t->affect.id->id.name);
+        collect_effects(t->affect.expr, eff);
+        break;
+    case instr_type:
+        collect_effects(t->list_instr.instr, eff);
+        collect_effects(t->list_instr.next, eff);
+        break;
+    case while_type:
+        collect_effects(t->while_n.expr, eff);
+        collect_effects(t->while_n.list_instr, eff);
+        break;
+    case do_while_type:
+        collect_effects(t->do_while.list_instr, eff);
+        collect_effects(t->do_while.expr, eff);
+        break;
+    case if_type:
+        collect_effects(t->if_n.expr, eff);
+        collect_effects(t->if_n.list_instr1, eff);
+        collect_effects(t->if_n.list_instr2, eff);
+        break;
+    case switch_type:
+        collect_effects(t->switch_n.expr, eff);
+        collect_effects(t->switch_n.cases, eff);
+        collect_effects(t->switch_n.default_instr, eff);
+        break;
+    case case_type:
+        collect_effects(t->case_n.list_instr, eff);
+        collect_effects(t->case_n.next, eff);
+        break;
+    case for_type:
+        set_modified(eff, t->for_n.id->id.name);
+        collect_effects(t->for_n.affect_init->affect.expr, eff);
+        collect_effects(t->for_n.end_exp, eff);
+        collect_effects(t->for_n.list_instr, eff);
+        break;
+    case io_type:
+        if (t->io.mode == 'r' || t->io.mode == 'R') eff->has_io = 1;
+        if (t->io.mode == 'R')
+        {
+            v = lookup(t->io.id->id.name);
+            if (v != NULL && v->type == array) eff->has_arr_write = 1;
+            else eff->has_ptr_write = 1;
+        }
+        collect_effects(t->io.expr, eff);
+        break;
+    case func_call_type:
+        eff->has_call = 1;
+        collect_effects(t->func_call.params, eff);
+        break;
+    case exp_list_type:
+        collect_effects(t->exp_list.exp, eff);
+        collect_effects(t->exp_list.next, eff);
+        break;
+    case return_type:
+        collect_effects(t->return_n.expr, eff);
+        break;
+    case array_access_type:
+        if (t->arr_access.affect_expr != NULL)
+        {
+            v = lookup(t->arr_access.id->id.name);
+            if (v != NULL && v->type == array) eff->has_arr_write = 1;
+            else eff->has_ptr_write = 1;
+        }
+        collect_effects(t->arr_access.ind_expr, eff);
+        collect_effects(t->arr_access.affect_expr, eff);
+        break;
+    case alloc_type:
+        set_modified(eff, t->alloc.id->id.name);
+        collect_effects(t->alloc.expr, eff);
+        break;
+    case inc_type:
+        set_modified(eff, t->inc.id->id.name);
+        break;
+    case free_type:
+        /* Le lien vers le bloc libre suivant est écrit dans le bloc */
+        eff->has_ptr_write = 1;
+        break;
+    case block_type:
+        v = lookup(t->block.dst->id.name);
+        if (v != NULL && v->type == array) eff->has_arr_write = 1;
+        else eff->has_ptr_write = 1;
+        collect_effects(t->block.src, eff);
+        collect_effects(t->block.size, eff);
+        break;
+    default:
+        break;
+    }
+}
+
+
+/**
+ * @brief Renvoie 1 si la mémoire lue via un pointeur ou un tableau peut
+ * être modifiée par le code ayant les effets `eff`.
+ * Un appel de fonction peut écrire via les pointeurs qui lui sont passés.
+ *
+ * @param eff
+ * @return int
+ */
+static int mem_written(effects *eff)
+{
+    return eff->has_call || eff->has_ptr_write || eff->has_arr_write
+           || eff->has_aliased_write;
+}
+
+
+/**
+ * @brief Renvoie 1 si la valeur de la variable `id` ne peut pas être modifiée
+ * par le code ayant les effets `eff`.
+ *
+ * Analyse d'alias: une variable locale dont l'adresse n'est jamais prise ne
+ * peut être modifiée que par une affectation directe. Une variable globale
+ * peut en plus être modifiée par n'importe quelle fonction appelée, et une
+ * variable dont l'adresse est prise par une écriture via un pointeur.
+ *
+ * @param id
+ * @param eff
+ * @return int
+ */
+static int var_is_invariant(const char *id, effects *eff)
+{
+    optim_var *v = lookup(id);
+    if (v == NULL) return 0;
+
+    /* L'adresse d'un tableau ne change pas */
+    if (v->type == array) return 1;
+
+    if (has_name(eff->modified, id)) return 0;
+    if (v->mem_zone == 'h' && eff->has_call) return 0;
+    if (v->is_addr_taken && (eff->has_call || eff->has_ptr_write)) return 0;
+
+    return 1;
+}
+
+
+/**
+ * @brief Renvoie 1 si l'expression a la même valeur à chaque évaluation dans
+ * le code ayant les effets `eff`.
+ *
+ * @param t
+ * @param eff
+ * @return int
+ */
+static int is_invariant(ast *t, effects *eff)
+{
+    switch (t->type)
+    {
+    case nb_type:
+        return 1;
+    case id_type:
+        return var_is_invariant(t->id.name, eff);
+    case b_op_type:
+        return is_invariant(t->b_op.l_memb, eff)
+               && is_invariant(t->b_op.r_memb, eff);
+    case u_op_type:
+        if (t->u_op.ope == '@') return lookup(t->u_op.child->id.name) != NULL;
+        if (t->u_op.ope == '*')
+        {
+            return !mem_written(eff)
+                   && var_is_invariant(t->u_op.child->id.name, eff);
+        }
+        return is_invariant(t->u_op.child, eff);
+    case array_access_type:
+        return t->arr_access.affect_expr == NULL && !mem_written(eff)
+               && var_is_invariant(t->arr_access.id->id.name, eff)
+               && is_invariant(t->arr_access.ind_expr, eff);
+    default:
+        /* Appels de fonctions et LIRE */
+        return 0;
+    }
+}
+
+
+/**
+ * @brief Créé une nouvelle variable temporaire (entier ou pointeur).
+ * Si la fonction courante n'est pas récursive, la variable est globale (donc
+ * dans la mémoire statique), sinon elle est locale (dans la pile).
+ *
+ * @param name Le nom de la variable (rempli par la fonction)
+ * @param type integer ou pointer
+ * @return char 'h' ou 's' selon la zone mémoire de la variable
+ */
+static char new_tmp(char *name, type_symb type)
+{
+    sprintf(name, "%s%d", OPTIM_TMP_PREFIX, nb_tmp++);
+
+    ast *var_d = create_var_decla_node(create_id_leaf(name), NULL, NULL, type);
+    ast *decla = create_decla_node(var_d, NULL);
+
+    if (!cur_func->is_recursive)
+    {
+        /* En tête des déclarations globales pour être déclarée avant usage */
+        decla->decla_list.next = prog->root.list_decl;
+        prog->root.list_decl = decla;
+        globals = add_var(globals, name, type, 'h');
+        return 'h';
+    }
+
+    func_decla_node *f = &cur_func->node->func_decla;
+    f->list_decl = create_decla_node(var_d, f->list_decl);
+    f->nb_decla++;
+
+    /* create_decla_node a créé un nouveau noeud */
+    free(decla);
+
+    cur_func->locals = add_var(cur_func->locals, name, type, 's');
+    return 's';
+}
+
+
+/**
+ * @brief Insère l'instruction `instr` avant l'instruction contenue dans le
+ * noeud `n` de la liste d'instructions.
+ *
+ * @param n
+ * @param instr
+ * @return ast* Le noeud contenant maintenant l'instruction d'origine
+ */
+static ast *insert_before(ast *n, ast *instr)
+{
+    ast *moved = create_instr_node(n->list_instr.instr, NULL);
+    moved->list_instr.next = n->list_instr.next;
+    moved->pos_infos = n->pos_infos;
+
+    n->list_instr.instr = instr;
+    n->list_instr.next = moved;
+
+    return moved;
+}
+
+
+
+/**
+ * @brief Remplace l'instruction contenue dans le noeud `n` de la liste
+ * d'instructions par la liste d'instructions `l`.
+ *
+ * @param n
+ * @param l
+ * @return ast* Le noeud contenant la dernière instruction de `l`
+ */
+static ast *replace_instr(ast *n, ast *l)
+{
+    ast *last = l;
+    while (last->list_instr.next != NULL) last = last->list_instr.next;
+    last->list_instr.next = n->list_instr.next;
+
+    n->list_instr.instr = l->list_instr.instr;
+    n->list_instr.next = l->list_instr.next;
+    if (last == l) last = n;
+
+    /* Seul le 1er noeud de `l` est libéré, ses instructions sont dans `n` */
+    free(l);
+
+    return last;
+}
+
+
+
+/*************** Déplacement des invariants de boucle (LICM) ***************/
+
+
+static void licm_list(ast *t);
+
+/* Nombre d'itérations de la boucle courante (-1 si inconnu) */
+static int licm_trip = -1;
+
+
+/**
+ * @brief Estime le nombre d'itérations de la boucle `loop`: POUR dont les
+ * bornes sont constantes, ou TQ / FAIRE TQ de condition `v < K` juste après
+ * `v <- c` (instruction `prev`). Les bornes peuvent être des paramètres
+ * constants (voir fold_bound).
+ *
+ * @param prev L'instruction qui précède la boucle (NULL si aucune)
+ * @param loop
+ * @return int Le nombre d'itérations, -1 s'il est inconnu
+ */
+static int loop_trip(ast *prev, ast *loop)
+{
+    ast *cond;
+    int a, b;
+
+    switch (loop->type)
+    {
+    case for_type:
+        if (!fold_bound(loop->for_n.affect_init->affect.expr, &a)
+            || !fold_bound(loop->for_n.end_exp->b_op.r_memb, &b)) return -1;
+        return b > a ? b - a : 0;
+    case while_type:
+        cond = loop->while_n.expr;
+        break;
+    case do_while_type:
+        cond = loop->do_while.expr;
+        break;
+    default:
+        return -1;
+    }
+
+    if (prev == NULL || prev->type != affect_type || prev->affect.is_deref
+        || cond->type != b_op_type || cond->b_op.ope != '<'
+        || cond->b_op.l_memb->type != id_type
+        || strcmp(cond->b_op.l_memb->id.name, prev->affect.id->id.name) != 0
+        || !fold_bound(prev->affect.expr, &a)
+        || !fold_bound(cond->b_op.r_memb, &b)) return -1;
+
+    /* Le corps d'un FAIRE TQ est exécuté au moins une fois */
+    if (loop->type == do_while_type && b - a < 1) return 1;
+    return b > a ? b - a : 0;
+}
+
+
+/**
+ * @brief Renvoie 1 s'il est rentable de calculer l'expression `t` avant la
+ * boucle courante: elle économise à chaque évaluation la différence entre son
+ * coût et la lecture de la variable temporaire, mais son calcul et
+ * l'affectation de la variable temporaire sont faits à chaque entrée dans la
+ * boucle, même si l'expression n'est jamais évaluée.
+ * Comme pour la réduction de force (voir sr_is_profitable), si le nombre
+ * d'itérations est inconnu, l'expression n'est pas déplacée dans une fonction
+ * récursive (variable temporaire dans la pile), et on suppose 2 itérations
+ * sinon. Une expression en position MAYBE_POS est supposée évaluée une
+ * itération sur deux.
+ *
+ * @param t
+ * @param pos
+ * @return int
+ */
+static int licm_is_profitable(ast *t, int pos)
+{
+    int trip = licm_trip;
+    if (trip < 0)
+    {
+        if (cur_func->is_recursive) return 0;
+        trip = 2;
+    }
+
+    /* Nombre d'évaluations de l'expression à chaque entrée dans la boucle */
+    int evals = pos == COND_POS ? trip + 1 : trip;
+    if (pos & MAYBE_POS) evals /= 2;
+
+    int cost = expr_cost(t);
+    int tmp_cost = cur_func->is_recursive ? 4 : 1;
+    int setup = cost + (cur_func->is_recursive ? 7 : 1);
+
+    return (cost - tmp_cost) * evals > setup;
+}
+
+
+/**
+ * @brief Remplace l'expression pointée par `slot` par une variable temporaire
+ * si elle est invariante et si c'est rentable, sinon cherche dans ses
+ * sous-expressions.
+ *
+ * Une expression en position COND_POS est évaluée au moins une fois dès que la
+ * boucle est atteinte (condition d'un TQ, borne d'un POUR). Elle peut donc être
+ * évaluée avant la boucle même si elle peut échouer (division par 0, etc.).
+ * En position BODY_POS, seules les expressions qui ne peuvent pas échouer sont
+ * déplacées.
+ *
+ * @param slot
+ * @param pos
+ * @param eff Les effets de bord de la boucle
+ * @param list Les expressions déjà sorties de la boucle
+ */
+static void licm_expr(ast **slot, int pos, effects *eff, hoisted **list)
+{
+    ast *t = *slot;
+    if (t == NULL) return;
+
+    int is_candidate = t->type == b_op_type || t->type == u_op_type
+                       || t->type == id_type
+                       || (t->type == array_access_type
+                           && t->arr_access.affect_expr == NULL);
+
+    if (is_candidate && is_invariant(t, eff) && (pos == COND_POS || !may_trap(t)))
+    {
+        /* Coût de lecture de la variable temporaire */
+        int tmp_cost = cur_func->is_recursive ? 4 : 1;
+        if (expr_cost(t) > tmp_cost)
+        {
+            hoisted *h;
+            for (h = *list; h != NULL && !expr_equal(h->expr, t); h = h->next);
+
+            /* Une expression déjà calculée avant la boucle est réutilisée */
+            if (h == NULL && licm_is_profitable(t, pos))
+            {
+                h = (hoisted *) malloc(sizeof(hoisted));
+                check_alloc(h);
+                new_tmp(h->tmp, integer);
+                h->expr = t;
+                h->next = *list;
+                *list = h;
+
+                /* La borne d'un POUR reste connue pour le déroulage */
+                optim_var *v = lookup(h->tmp);
+                v->is_const = fold_bound(t, &v->val);
+            }
+            if (h != NULL)
+            {
+                *slot = create_id_leaf(h->tmp);
+                (*slot)->pos_infos = t->pos_infos;
+
+                /* L'expression est déjà calculée dans la variable temporaire */
+                if (h->expr != t) free_ast(t);
+                return;
+            }
+        }
+    }
+
+    switch (t->type)
+    {
+    case b_op_type:
+        licm_expr(&t->b_op.l_memb, pos, eff, list);
+
+        /*
+         * Le membre droit d'un ET / OU n'est pas toujours évalué. Dans la
+         * condition d'une boucle, celui d'un ET l'est à chaque itération.
+         */
+        if (t->b_op.ope == AND_OP && pos == COND_POS) pos = BODY_POS;
+        else if (t->b_op.ope == AND_OP || t->b_op.ope == OR_OP)
+        {
+            pos = BODY_POS | MAYBE_POS;
+        }
+        licm_expr(&t->b_op.r_memb, pos, eff, list);
+        break;
+    case u_op_type:
+        /* Le fils de @ et * doit rester un identificateur */
+        if (t->u_op.ope == '-' || t->u_op.ope == NOT_OP)
+        {
+            licm_expr(&t->u_op.child, pos, eff, list);
+        }
+        break;
+    case array_access_type:
+        licm_expr(&t->arr_access.ind_expr, pos, eff, list);
+        licm_expr(&t->arr_access.affect_expr, pos, eff, list);
+        break;
+    case func_call_type:
+        licm_expr(&t->func_call.params, pos, eff, list);
+        break;
+    case exp_list_type:
+        licm_expr(&t->exp_list.exp, pos, eff, list);
+        licm_expr(&t->exp_list.next, pos, eff, list);
+        break;
+    case io_type:
+        licm_expr(&t->io.expr, pos, eff, list);
+        break;
+    default:
+        break;
+    }
+}
+
+
+/**
+ * @brief Cherche les expressions invariantes dans les instructions du corps
+ * d'une boucle. Comme pour l'analyse sémantique, les instructions qui suivent
+ * un RETOURNER sont ignorées.
+ *
+ * @param t La liste d'instructions
+ * @param pos BODY_POS, avec MAYBE_POS si la liste n'est pas exécutée à chaque
+ * itération
+ * @param eff Les effets de bord de la boucle
+ * @param list Les expressions déjà sorties de la boucle
+ */
+static void licm_body(ast *t, int pos, effects *eff, hoisted **list)
+{
+    int maybe = pos | MAYBE_POS;
+
+    for (; t != NULL; t = t->list_instr.next)
+    {
+        ast *instr = t->list_instr.instr, *c;
+        switch (instr->type)
+        {
+        case affect_type:
+            licm_expr(&instr->affect.expr, pos, eff, list);
+            break;
+        case while_type:
+            licm_expr(&instr->while_n.expr, pos, eff, list);
+            licm_body(instr->while_n.list_instr, maybe, eff, list);
+            break;
+        case do_while_type:
+            licm_body(instr->do_while.list_instr, pos, eff, list);
+            licm_expr(&instr->do_while.expr, pos, eff, list);
+            break;
+        case if_type:
+            licm_expr(&instr->if_n.expr, pos, eff, list);
+            licm_body(instr->if_n.list_instr1, maybe, eff, list);
+            licm_body(instr->if_n.list_instr2, maybe, eff, list);
+            break;
+        case switch_type:
+            licm_expr(&instr->switch_n.expr, pos, eff, list);
+            for (c = instr->switch_n.cases; c != NULL; c = c->case_n.next)
+            {
+                licm_body(c->case_n.list_instr, maybe, eff, list);
+            }
+            licm_body(instr->switch_n.default_instr, maybe, eff, list);
+            break;
+        case for_type:
+            licm_expr(&instr->for_n.affect_init->affect.expr, pos, eff, list);
+            licm_expr(&instr->for_n.end_exp->b_op.r_memb, pos, eff, list);
+            licm_body(instr->for_n.list_instr, maybe, eff, list);
+            break;
+        case return_type:
+            licm_expr(&instr->return_n.expr, pos, eff, list);
+            return;
+        case alloc_type:
+            licm_expr(&instr->alloc.expr, pos, eff, list);
+            break;
+        case block_type:
+            /* La source de COPIER doit rester un identificateur */
+            if (instr->block.op == 'f')
+            {
+                licm_expr(&instr->block.src, pos, eff, list);
+            }
+            licm_expr(&instr->block.size, pos, eff, list);
+            break;
+        default:
+            /* Expression utilisée comme instruction, ECRIRE, T[i] <- ... */
+            licm_expr(&t->list_instr.instr, pos, eff, list);
+            break;
+        }
+    }
+}
+
+
+/**
+ * @brief Sort les expressions invariantes de la boucle contenue dans le noeud
+ * `n` de la liste d'instructions.
+ * Chaque expression est calculée une seule fois dans une variable temporaire
+ * affectée juste avant la boucle, si c'est rentable (voir licm_is_profitable).
+ *
+ * @param n
+ * @param before L'instruction qui précède la boucle (NULL si aucune)
+ * @return ast* Le noeud contenant maintenant la boucle
+ */
+static ast *licm_loop(ast *n, ast *before)
+{
+    ast *loop = n->list_instr.instr;
+    effects eff = {0};
+    hoisted *list = NULL;
+
+    collect_effects(loop, &eff);
+    licm_trip = loop_trip(before, loop);
+
+    switch (loop->type)
+    {
+    case while_type:
+        licm_expr(&loop->while_n.expr, COND_POS, &eff, &list);
+        licm_body(loop->while_n.list_instr, BODY_POS, &eff, &list);
+        break;
+    case do_while_type:
+        /* La condition n'est évaluée qu'après une 1ère exécution du corps */
+        licm_body(loop->do_while.list_instr, BODY_POS, &eff, &list);
+        licm_expr(&loop->do_while.expr, BODY_POS, &eff, &list);
+        break;
+    case for_type:
+        licm_expr(&loop->for_n.end_exp->b_op.r_memb, COND_POS, &eff, &list);
+        licm_body(loop->for_n.list_instr, BODY_POS, &eff, &list);
+        break;
+    default:
+        break;
+    }
+
+    free_names(eff.modified);
+
+    /* La liste est dans l'ordre inverse de création */
+    hoisted *prev = NULL, *aux;
+    while (list != NULL)
+    {
+        aux = list->next;
+        list->next = prev;
+        prev = list;
+        list = aux;
+    }
+
+    while (prev != NULL)
+    {
+        ast *affect = create_affect_node(prev->tmp, prev->expr, 0);
+        affect->pos_infos = loop->pos_infos;
+        n = insert_before(n, affect);
+
+        aux = prev->next;
+        free(prev);
+        prev = aux;
+    }
+
+    return n;
+}
+
+
+/**
+ * @brief Applique LICM à toutes les boucles de la liste d'instructions, en
+ * commençant par les boucles les plus imbriquées.
+ *
+ * @param t
+ */
+static void licm_list(ast *t)
+{
+    ast *prev = NULL;
+    for (; t != NULL; prev = t->list_instr.instr, t = t->list_instr.next)
+    {
+        ast *instr = t->list_instr.instr, *c;
+        switch (instr->type)
+        {
+        case if_type:
+            licm_list(instr->if_n.list_instr1);
+            licm_list(instr->if_n.list_instr2);
+            break;
+        case switch_type:
+            for (c = instr->switch_n.cases; c != NULL; c = c->case_n.next)
+            {
+                licm_list(c->case_n.list_instr);
+            }
+            licm_list(instr->switch_n.default_instr);
+            break;
+        case while_type:
+            licm_list(instr->while_n.list_instr);
+            t = licm_loop(t, prev);
+            break;
+        case do_while_type:
+            licm_list(instr->do_while.list_instr);
+            t = licm_loop(t, prev);
+            break;
+        case for_type:
+            licm_list(instr->for_n.list_instr);
+            t = licm_loop(t, prev);
+            break;
+        case return_type:
+            /* Les instructions suivantes ne sont jamais exécutées */
+            return;
+        default:
+            break;
+        }
+    }
+}
+
+
+/**
+ * @brief Déplacement des calculs invariants hors des boucles (Loop-Invariant
+ * Code Motion).
+ *
+ * Par exemple dans `TQ i < n - 1 FAIRE ...`, si n n'est pas modifié dans la
+ * boucle, `n - 1` est calculé une seule fois avant la boucle.
+ *
+ * @param t La racine de l'ASA
+ */
+void optim_licm(ast *t)
+{
+    optim_func *f;
+    for (f = funcs; f != NULL; f = f->next)
+    {
+        cur_func = f;
+        licm_list(f->node->func_decla.list_instr);
+    }
+    cur_func = NULL;
+}
+
+
+/*************** Réduction de force sur les accès aux tableaux ***************/
+
+
+/*
+ * Groupe d'accès `tab[i + K]` (ou `tab[i - K]`) au même tableau avec le même
+ * décalage K, dans un POUR sur la variable i.
+ * Ils partagent une variable temporaire contenant l'adresse de tab[i + K],
+ * incrémentée en même temps que i.
+ * gain: nombre d'instructions économisées par itération
+ */
+typedef struct _iv_group {
+    char arr[ID_MAX_SIZE];
+    ast *offset;
+    int sign;
+    int gain;
+    slot_list *refs;
+    char tmp[ID_MAX_SIZE];
+    struct _iv_group *next;
+} iv_group;
+
+
+/**
+ * @brief Renvoie 1 si l'indice `ind` est de la forme i, i + K, K + i ou i - K
+ * avec K invariant dans la boucle.
+ *
+ * @param ind
+ * @param iv La variable d'induction (variable du POUR)
+ * @param eff Les effets de bord du corps de la boucle
+ * @param offset K (NULL si l'indice est i)
+ * @param sign -1 pour i - K, 1 sinon
+ * @return int
+ */
+static int match_index(ast *ind, const char *iv, effects *eff, ast **offset,
+                       int *sign)
+{
+    *offset = NULL;
+    *sign = 1;
+
+    if (ind->type == id_type) return strcmp(ind->id.name, iv) == 0;
+    if (ind->type != b_op_type) return 0;
+
+    ast *l = ind->b_op.l_memb;
+    ast *r = ind->b_op.r_memb;
+    int l_is_iv = l->type == id_type && strcmp(l->id.name, iv) == 0;
+    int r_is_iv = r->type == id_type && strcmp(r->id.name, iv) == 0;
+
+    if (ind->b_op.ope == '+' && l_is_iv) *offset = r;
+    else if (ind->b_op.ope == '+' && r_is_iv) *offset = l;
+    else if (ind->b_op.ope == '-' && l_is_iv)
+    {
+        *offset = r;
+        *sign = -1;
+    }
+    else return 0;
+
+    /* K est calculé une seule fois avant la boucle */
+    return is_invariant(*offset, eff) && !may_trap(*offset)
+           && is_pure(*offset);
+}
+
+
+/**
+ * @brief Ajoute l'accès pointé par `slot` à son groupe (créé si besoin).
+ *
+ * @param groups
+ * @param slot
+ * @param offset
+ * @param sign
+ */
+static void add_arr_ref(iv_group **groups, ast **slot, ast *offset, int sign)
+{
+    ast *t = *slot;
+    char *arr = t->arr_access.id->id.name;
+    iv_group *g;
+
+    for (g = *groups; g != NULL; g = g->next)
+    {
+        if (strcmp(g->arr, arr) == 0 && g->sign == sign
+            && expr_equal(g->offset, offset)) break;
+    }
+
+    if (g == NULL)
+    {
+        g = (iv_group *) calloc(1, sizeof(iv_group));
+        check_alloc(g);
+        strcpy(g->arr, arr);
+        g->offset = offset;
+        g->sign = sign;
+        g->next = *groups;
+        *groups = g;
+    }
+
+    /* Coût de l'accès d'origine moins celui de l'accès via *tmp */
+    int is_static = !cur_func->is_recursive;
+    if (t->arr_access.affect_expr == NULL)
+    {
+        g->gain += expr_cost(t) - (is_static ? 1 : 4);
+    }
+    else g->gain += expr_cost(t) + 7 - (is_static ? 1 : 7);
+
+    slot_list *ref = (slot_list *) malloc(sizeof(slot_list));
+    check_alloc(ref);
+    ref->slot = slot;
+    ref->next = g->refs;
+    g->refs = ref;
+}
+
+
+/**
+ * @brief Relève les accès `tab[i + K]` dans le code pointé par `slot`
+ * (instruction, liste d'instructions ou expression).
+ *
+ * @param slot
+ * @param iv La variable d'induction
+ * @param eff Les effets de bord du corps de la boucle
+ * @param groups
+ */
+static void sr_collect(ast **slot, const char *iv, effects *eff,
+                       iv_group **groups)
+{
+    ast *t = *slot;
+    ast *offset;
+    int sign;
+    optim_var *v;
+
+    if (t == NULL) return;
+
+    switch (t->type)
+    {
+    case array_access_type:
+        /* Un accès via *tmp n'est plus vérifié (--bounds-check) */
+        v = lookup(t->arr_access.id->id.name);
+        if (v != NULL && (v->type == array || v->type == pointer)
+            && !bounds_to_check(t) && var_is_invariant(v->id, eff)
+            && match_index(t->arr_access.ind_expr, iv, eff, &offset, &sign))
+        {
+            add_arr_ref(groups, slot, offset, sign);
+        }
+        else sr_collect(&t->arr_access.ind_expr, iv, eff, groups);
+        sr_collect(&t->arr_access.affect_expr, iv, eff, groups);
+        break;
+    case b_op_type:
+        sr_collect(&t->b_op.l_memb, iv, eff, groups);
+        sr_collect(&t->b_op.r_memb, iv, eff, groups);
+        break;
+    case u_op_type:
+        if (t->u_op.ope == '-' || t->u_op.ope == NOT_OP)
+        {
+            sr_collect(&t->u_op.child, iv, eff, groups);
+        }
+        break;
+    case affect_type:
+        sr_collect(&t->affect.expr, iv, eff, groups);
+        break;
+    case instr_type:
+        sr_collect(&t->list_instr.instr, iv, eff, groups);
+        sr_collect(&t->list_instr.next, iv, eff, groups);
+        break;
+    case while_type:
+        sr_collect(&t->while_n.expr, iv, eff, groups);
+        sr_collect(&t->while_n.list_instr, iv, eff, groups);
+        break;
+    case do_while_type:
+        sr_collect(&t->do_while.list_instr, iv, eff, groups);
+        sr_collect(&t->do_while.expr, iv, eff, groups);
+        break;
+    case if_type:
+        sr_collect(&t->if_n.expr, iv, eff, groups);
+        sr_collect(&t->if_n.list_instr1, iv, eff, groups);
+        sr_collect(&t->if_n.list_instr2, iv, eff, groups);
+        break;
+    case switch_type:
+        sr_collect(&t->switch_n.expr, iv, eff, groups);
+        sr_collect(&t->switch_n.cases, iv, eff, groups);
+        sr_collect(&t->switch_n.default_instr, iv, eff, groups);
+        break;
+    case case_type:
+        sr_collect(&t->case_n.list_instr, iv, eff, groups);
+        sr_collect(&t->case_n.next, iv, eff, groups);
+        break;
+    case for_type:
+        sr_collect(&t->for_n.affect_init->affect.expr, iv, eff, groups);
+        sr_collect(&t->for_n.end_exp->b_op.r_memb, iv, eff, groups);
+        sr_collect(&t->for_n.list_instr, iv, eff, groups);
+        break;
+    case io_type:
+        sr_collect(&t->io.expr, iv, eff, groups);
+        break;
+    case func_call_type:
+        sr_collect(&t->func_call.params, iv, eff, groups);
+        break;
+    case exp_list_type:
+        sr_collect(&t->exp_list.exp, iv, eff, groups);
+        sr_collect(&t->exp_list.next, iv, eff, groups);
+        break;
+    case return_type:
+        sr_collect(&t->return_n.expr, iv, eff, groups);
+        break;
+    case alloc_type:
+        sr_collect(&t->alloc.expr, iv, eff, groups);
+        break;
+    case block_type:
+        if (t->block.op == 'f') sr_collect(&t->block.src, iv, eff, groups);
+        sr_collect(&t->block.size, iv, eff, groups);
+        break;
+    default:
+        break;
+    }
+}
+
+
+/**
+ * @brief Remplace les accès du groupe par des accès via sa variable
+ * temporaire: `tab[i + K]` devient `*tmp` et `tab[i + K] <- e` devient
+ * `*tmp <- e`.
+ * Les lectures doivent être remplacées avant les écritures, car une lecture
+ * peut se trouver dans l'expression affectée par une écriture.
+ *
+ * @param g
+ * @param writes 0 pour remplacer les lectures, 1 pour les écritures
+ */
+static void sr_rewrite(iv_group *g, int writes)
+{
+    slot_list *ref;
+    for (ref = g->refs; ref != NULL; ref = ref->next)
+    {
+        ast *t = *ref->slot;
+        int is_write = t->arr_access.affect_expr != NULL;
+        if (is_write != writes) continue;
+
+        if (is_write)
+        {
+            *ref->slot = create_affect_node(g->tmp, t->arr_access.affect_expr, 1);
+            t->arr_access.affect_expr = NULL;
+        }
+        else *ref->slot = create_u_op_node('*', create_id_leaf(g->tmp));
+
+        (*ref->slot)->pos_infos = t->pos_infos;
+        free_ast(t);
+    }
+}
+
+
+/**
+ * @brief Renvoie 1 si la variable d'induction d'un groupe est rentable: le
+ * gain par itération moins l'INC doit compenser l'initialisation `setup`,
+ * faite à chaque entrée dans la boucle.
+ * Si le nombre d'itérations `trip` n'est pas connu (-1), l'initialisation
+ * n'est supposée amortie que dans une fonction non récursive (variable dans
+ * la mémoire statique): dans la pile, elle coûte autant que plusieurs accès.
+ *
+ * @param gain
+ * @param inc_cost
+ * @param setup
+ * @param trip
+ * @return int
+ */
+static int sr_is_profitable(int gain, int inc_cost, int setup, int trip)
+{
+    if (gain <= inc_cost) return 0;
+    if (trip < 0) return !cur_func->is_recursive;
+
+    return (gain - inc_cost) * trip > setup;
+}
+
+
+/**
+ * @brief Réduction de force sur le POUR contenu dans le noeud `n` de la liste
+ * d'instructions.
+ *
+ * @param n
+ * @return ast* Le noeud contenant maintenant la boucle
+ */
+static ast *sr_loop(ast *n)
+{
+    ast *loop = n->list_instr.instr;
+    for_node *node = &loop->for_n;
+    char *iv = node->id->id.name;
+    ast *start = node->affect_init->affect.expr;
+
+    /*
+     * La valeur de départ est évaluée une 2ème fois pour initialiser les
+     * adresses, et i ne doit être modifié que par l'incrément du POUR.
+     */
+    if (lookup(iv) == NULL || !is_pure(start)) return n;
+
+    ast *last = node->list_instr;
+    while (last->list_instr.next != NULL) last = last->list_instr.next;
+    if (last->list_instr.instr->type == return_type) return n;
+
+    effects eff = {0};
+    collect_effects(node->list_instr, &eff);
+
+    iv_group *groups = NULL, *g, *aux;
+    if (var_is_invariant(iv, &eff))
+    {
+        /* K ne doit pas dépendre de i (i * n + i n'est pas de la forme i + K) */
+        set_modified(&eff, iv);
+        sr_collect(&node->list_instr, iv, &eff, &groups);
+    }
+
+    /* Nombre d'itérations, -1 s'il n'est pas connu */
+    int a, b, trip = -1;
+    if (fold_const(start, &a) && fold_const(node->end_exp->b_op.r_memb, &b))
+    {
+        trip = b > a ? b - a : 0;
+    }
+
+    /* Un INC par groupe et par itération */
+    int inc_cost = cur_func->is_recursive ? 4 : 1;
+    for (g = groups; g != NULL; g = g->next)
+    {
+        /* tmp <- @tab + début (+ K) avant la boucle (p + début pour p[i]) */
+        ast *base = create_id_leaf(g->arr);
+        if (lookup(g->arr)->type == array) base = create_u_op_node('@', base);
+
+        ast *init = create_b_op_node('+', base, copy_ast(start));
+        if (g->offset != NULL)
+        {
+            init = create_b_op_node(g->sign == 1 ? '+' : '-', init,
+                                    copy_ast(g->offset));
+        }
+
+        /* Calcul et STORE de tmp (+ DEC STACK_REG de sa déclaration) */
+        int setup = expr_cost(init) + (cur_func->is_recursive ? 7 : 1);
+        if (!sr_is_profitable(g->gain, inc_cost, setup, trip))
+        {
+            free_ast(init);
+            continue;
+        }
+
+        new_tmp(g->tmp, pointer);
+        ast *affect = create_affect_node(g->tmp, init, 0);
+        affect->pos_infos = loop->pos_infos;
+        n = insert_before(n, affect);
+
+        /* INC tmp à la fin de chaque itération */
+        ast *inc = create_inc_node(g->tmp);
+        inc->pos_infos = loop->pos_infos;
+        create_instr_node(inc, node->list_instr);
+    }
+
+    for (g = groups; g != NULL; g = g->next)
+    {
+        if (g->tmp[0] != '\0') sr_rewrite(g, 0);
+    }
+
+    while (groups != NULL)
+    {
+        if (groups->tmp[0] != '\0') sr_rewrite(groups, 1);
+
+        while (groups->refs != NULL)
+        {
+            slot_list *ref = groups->refs->next;
+            free(groups->refs);
+            groups->refs = ref;
+        }
+
+        aux = groups->next;
+        free(groups);
+        groups = aux;
+    }
+
+    free_names(eff.modified);
+    return n;
+}
+
+
+/**
+ * @brief Applique la réduction de force à tous les POUR de la liste
+ * d'instructions, en commençant par les plus imbriqués.
+ *
+ * @param t
+ */
+static void sr_list(ast *t)
+{
+    for (; t != NULL; t = t->list_instr.next)
+    {
+        ast *instr = t->list_instr.instr, *c;
+        switch (instr->type)
+        {
+        case if_type:
+            sr_list(instr->if_n.list_instr1);
+            sr_list(instr->if_n.list_instr2);
+            break;
+        case switch_type:
+            for (c = instr->switch_n.cases; c != NULL; c = c->case_n.next)
+            {
+                sr_list(c->case_n.list_instr);
+            }
+            sr_list(instr->switch_n.default_instr);
+            break;
+        case while_type:
+            sr_list(instr->while_n.list_instr);
+            break;
+        case do_while_type:
+            sr_list(instr->do_while.list_instr);
+            break;
+        case for_type:
+            sr_list(instr->for_n.list_instr);
+            t = sr_loop(t);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+
+/**
+ * @brief Réduction de force des accès aux tableaux dans les POUR.
+ *
+ * Dans `POUR i DANS 0...n FAIRE tab[i] <- tab[i] + 1 FPOUR`, l'adresse de
+ * tab[i] est recalculée (et pour un tableau dans la pile, à partir de
+ * STACK_REL_START) à chaque accès. Elle est à la place gardée dans une
+ * variable temporaire initialisée avant la boucle, et incrémentée (INC) en
+ * même temps que i:
+ *
+ * tmp <- @tab + 0
+ * POUR i DANS 0...n FAIRE *tmp <- *tmp + 1; INC tmp FPOUR
+ *
+ * Fonctionne aussi pour les pointeurs (p[i]) et les indices de la forme
+ * i + K, K + i et i - K avec K invariant dans la boucle.
+ *
+ * @param t La racine de l'ASA
+ */
+void optim_strength_reduction(ast *t)
+{
+    optim_func *f;
+    for (f = funcs; f != NULL; f = f->next)
+    {
+        cur_func = f;
+        sr_list(f->node->func_decla.list_instr);
+    }
+    cur_func = NULL;
+}
+
+
+/***************************** Déroulage de boucle *****************************/
+
+
+/**
+ * @brief Remplace les lectures de la variable `id` par la constante `val` dans
+ * le code pointé par `slot`.
+ *
+ * @param slot
+ * @param id
+ * @param val
+ */
+static void subst_var(ast **slot, const char *id, int val)
+{
+    ast *t = *slot;
+    if (t == NULL) return;
+
+    switch (t->type)
+    {
+    case id_type:
+        if (strcmp(t->id.name, id) == 0)
+        {
+            *slot = create_nb_leaf(val);
+            (*slot)->pos_infos = expr_pos(t);
+            free_ast(t);
+        }
+        break;
+    case b_op_type:
+        subst_var(&t->b_op.l_memb, id, val);
+        subst_var(&t->b_op.r_memb, id, val);
+        break;
+    case u_op_type:
+        /* Le fils de @ et * doit rester un identificateur */
+        if (t->u_op.ope == '-' || t->u_op.ope == NOT_OP)
+        {
+            subst_var(&t->u_op.child, id, val);
+        }
+        break;
+    case affect_type:
+        subst_var(&t->affect.expr, id, val);
+        break;
+    case instr_type:
+        subst_var(&t->list_instr.instr, id, val);
+        subst_var(&t->list_instr.next, id, val);
+        break;
+    case while_type:
+        subst_var(&t->while_n.expr, id, val);
+        subst_var(&t->while_n.list_instr, id, val);
+        break;
+    case do_while_type:
+        subst_var(&t->do_while.list_instr, id, val);
+        subst_var(&t->do_while.expr, id, val);
+        break;
+    case if_type:
+        subst_var(&t->if_n.expr, id, val);
+        subst_var(&t->if_n.list_instr1, id, val);
+        subst_var(&t->if_n.list_instr2, id, val);
+        break;
+    case switch_type:
+        subst_var(&t->switch_n.expr, id, val);
+        subst_var(&t->switch_n.cases, id, val);
+        subst_var(&t->switch_n.default_instr, id, val);
+        break;
+    case case_type:
+        subst_var(&t->case_n.list_instr, id, val);
+        subst_var(&t->case_n.next, id, val);
+        break;
+    case for_type:
+        subst_var(&t->for_n.affect_init->affect.expr, id, val);
+        subst_var(&t->for_n.end_exp->b_op.r_memb, id, val);
+        subst_var(&t->for_n.list_instr, id, val);
+        break;
+    case io_type:
+        subst_var(&t->io.expr, id, val);
+        break;
+    case func_call_type:
+        subst_var(&t->func_call.params, id, val);
+        break;
+    case exp_list_type:
+        subst_var(&t->exp_list.exp, id, val);
+        subst_var(&t->exp_list.next, id, val);
+        break;
+    case return_type:
+        subst_var(&t->return_n.expr, id, val);
+        break;
+    case array_access_type:
+        subst_var(&t->arr_access.ind_expr, id, val);
+        subst_var(&t->arr_access.affect_expr, id, val);
+        break;
+    case alloc_type:
+        subst_var(&t->alloc.expr, id, val);
+        break;
+    case block_type:
+        if (t->block.op == 'f') subst_var(&t->block.src, id, val);
+        subst_var(&t->block.size, id, val);
+        break;
+    default:
+        break;
+    }
+}
+
+
+/**
+ * @brief Ajoute la liste d'instructions `l2` à la fin de la liste `l`.
+ *
+ * @param l
+ * @param l2
+ * @return ast* La liste
+ */
+static ast *append_list(ast *l, ast *l2)
+{
+    if (l == NULL) return l2;
+
+    ast *aux = l;
+    while (aux->list_instr.next != NULL) aux = aux->list_instr.next;
+    aux->list_instr.next = l2;
+
+    return l;
+}
+
+
+/**
+ * @brief Ajoute une instruction créée par l'optimiseur à la fin de la liste.
+ *
+ * @param l
+ * @param instr
+ * @param pos La position de la boucle d'origine dans le code source
+ * @return ast* La liste
+ */
+static ast *append_instr(ast *l, ast *instr, YYLTYPE pos)
+{
+    ast *n = create_instr_node(instr, NULL);
+    instr->pos_infos = pos;
+    n->pos_infos = pos;
+
+    return append_list(l, n);
+}
+
+
+/**
+ * @brief Déroule complètement un POUR dont les bornes sont constantes:
+ * `POUR i DANS 0...3 FAIRE f(i) FPOUR` devient `f(0) f(1) f(2) i <- 3`.
+ *
+ * Si l'adresse de i est prise, sa valeur peut être lue via un pointeur: i est
+ * alors affecté avant chaque copie au lieu d'être remplacé par sa valeur.
+ *
+ * @param n Le noeud de la liste d'instructions contenant la boucle
+ * @param start
+ * @param end
+ * @return ast* Le noeud contenant la dernière instruction générée
+ */
+static ast *full_unroll(ast *n, int start, int end)
+{
+    ast *loop = n->list_instr.instr;
+    char *iv = loop->for_n.id->id.name;
+    YYLTYPE pos = loop->pos_infos;
+    int is_addr_taken = lookup(iv)->is_addr_taken;
+
+    ast *l = NULL, *c;
+    int k;
+    for (k = start; k < end; k++)
+    {
+        c = copy_ast(loop->for_n.list_instr);
+        if (is_addr_taken)
+        {
+            l = append_instr(l, create_affect_node(iv, create_nb_leaf(k), 0),
+                             pos);
+        }
+        else subst_var(&c, iv, k);
+
+        l = append_list(l, c);
+    }
+
+    /* Valeur de i en sortie de boucle */
+    int last = end > start ? end : start;
+    l = append_instr(l, create_affect_node(iv, create_nb_leaf(last), 0), pos);
+
+    free_ast(loop);
+    return replace_instr(n, l);
+}
+
+
+/**
+ * @brief Déroule `factor` fois un POUR dont le nombre d'itérations n'est pas
+ * connu. `POUR i DANS a...b FAIRE corps FPOUR` devient:
+ *
+ * i <- a
+ * TQ i < b - (factor - 1) FAIRE corps; INC i; corps; INC i; ... FTQ
+ * TQ i < b FAIRE corps; INC i FTQ
+ *
+ * La 2ème boucle exécute les itérations restantes. Si b n'est pas constant,
+ * b - (factor - 1) est calculé une seule fois dans une variable temporaire.
+ *
+ * @param n Le noeud de la liste d'instructions contenant la boucle
+ * @param factor
+ * @return ast* Le noeud contenant la dernière instruction générée
+ */
+static ast *partial_unroll(ast *n, int factor)
+{
+    ast *loop = n->list_instr.instr;
+    for_node *node = &loop->for_n;
+    char *iv = node->id->id.name;
+    YYLTYPE pos = loop->pos_infos;
+    ast *end = node->end_exp->b_op.r_memb;
+    ast *l, *limit, *body = NULL;
+    char tmp[ID_MAX_SIZE];
+    int val, k;
+
+    /* i <- a */
+    l = append_instr(NULL, node->affect_init, node->affect_init->pos_infos);
+    node->affect_init = NULL;
+
+    if (fold_const(end, &val)) limit = create_nb_leaf(val - (factor - 1));
+    else
+    {
+        new_tmp(tmp, integer);
+        ast *e = create_b_op_node('-', copy_ast(end),
+                                  create_nb_leaf(factor - 1));
+        e->pos_infos = end->pos_infos;
+        l = append_instr(l, create_affect_node(tmp, e, 0), pos);
+        limit = create_id_leaf(tmp);
+    }
+    limit->pos_infos = end->pos_infos;
+
+    for (k = 0; k < factor; k++)
+    {
+        body = append_list(body, copy_ast(node->list_instr));
+        body = append_instr(body, create_inc_node(iv), pos);
+    }
+
+    ast *cond = create_b_op_node('<', create_id_leaf(iv), limit);
+    cond->pos_infos = node->end_exp->pos_infos;
+    l = append_instr(l, create_while_node(cond, body), pos);
+
+    /* Itérations restantes */
+    body = append_instr(node->list_instr, create_inc_node(iv), pos);
+    node->list_instr = NULL;
+
+    cond = create_b_op_node('<', create_id_leaf(iv), copy_ast(end));
+    cond->pos_infos = node->end_exp->pos_infos;
+    l = append_instr(l, create_while_node(cond, body), pos);
+
+    free_ast(loop);
+    return replace_instr(n, l);
+}
+
+
+/**
+ * @brief Renvoie 1 si le déroulage partiel (voir partial_unroll) du POUR
+ * `loop` exécute moins d'instructions que la boucle d'origine.
+ * Chaque groupe de `factor` itérations économise `factor - 1` tests de la
+ * condition, mais chaque entrée dans la boucle coûte le calcul de la limite
+ * (dans une variable temporaire si la borne n'est pas constante) et un test
+ * de plus (sortie de la 1ère boucle). Les itérations restantes coûtent autant
+ * que dans le POUR.
+ * Si le nombre d'itérations `trip` n'est pas connu (-1), la boucle n'est pas
+ * déroulée dans une fonction récursive (limite dans la pile), et on suppose
+ * 2 * factor itérations sinon.
+ *
+ * @param loop
+ * @param factor
+ * @param trip
+ * @return int
+ */
+static int unroll_is_profitable(ast *loop, int factor, int trip)
+{
+    for_node *node = &loop->for_n;
+    ast *end = node->end_exp->b_op.r_memb;
+    int is_rec = cur_func->is_recursive;
+    int val;
+
+    if (trip < 0)
+    {
+        if (is_rec) return 0;
+        trip = 2 * factor;
+    }
+
+    /* Calcul de la limite b - (factor - 1) */
+    int is_const = fold_const(end, &val);
+    int setup = is_const ? 0 : expr_cost(end) + 2 + (is_rec ? 7 : 1);
+    int limit_cost = is_const || !is_rec ? 1 : 4;
+
+    /* Une itération du POUR: condition, JUMZ, JUMP et INC i */
+    int inc_cost = is_rec ? 4 : 1;
+    int cond_cost = expr_cost(node->end_exp);
+    int iter_cost = cond_cost + 2 + inc_cost;
+
+    /* Test de la condition de la 1ère boucle (i < limite) */
+    int check = cond_cost - expr_cost(end) + limit_cost + 2;
+
+    int groups = trip / factor;
+    int saved = groups * (factor * iter_cost - check - factor * inc_cost);
+    return saved > setup + check - 1;
+}
+
+
+/**
+ * @brief Déroule si possible le POUR contenu dans le noeud `n` de la liste
+ * d'instructions.
+ *
+ * @param n
+ * @return ast* Le noeud contenant la dernière instruction générée (ou la
+ * boucle si elle n'est pas déroulée)
+ */
+static ast *unroll_loop(ast *n)
+{
+    ast *loop = n->list_instr.instr;
+    for_node *node = &loop->for_n;
+    char *iv = node->id->id.name;
+    ast *start = node->affect_init->affect.expr;
+    ast *end = node->end_exp->b_op.r_memb;
+    ast *aux;
+
+    if (lookup(iv) == NULL) return n;
+
+    /* Un RETOURNER suivi d'une copie du corps la rendrait inatteignable */
+    for (aux = node->list_instr; aux != NULL; aux = aux->list_instr.next)
+    {
+        if (aux->list_instr.instr->type == return_type) return n;
+    }
+
+    /* i ne doit être modifié que par l'incrément du POUR */
+    effects eff = {0};
+    collect_effects(node->list_instr, &eff);
+    int is_valid = var_is_invariant(iv, &eff);
+
+    /* La borne ne doit pas non plus dépendre de i */
+    set_modified(&eff, iv);
+    int is_end_invariant = is_invariant(end, &eff) && is_pure(end);
+    free_names(eff.modified);
+    if (!is_valid) return n;
+
+    int body_cost = code_cost(node->list_instr);
+    int a, b, trip = -1;
+    if (fold_const(start, &a) && fold_const(end, &b))
+    {
+        trip = b > a ? b - a : 0;
+        int copy_cost = body_cost;
+        if (lookup(iv)->is_addr_taken) copy_cost += code_cost(node->affect_init);
+
+        if (trip * copy_cost <= OPTIM_UNROLL_BUDGET)
+        {
+            return full_unroll(n, a, b);
+        }
+    }
+    else if (fold_bound(start, &a) && fold_bound(end, &b))
+    {
+        trip = b > a ? b - a : 0;
+    }
+
+    if (optim_unroll < 2 || !is_end_invariant) return n;
+    if (body_cost > 0 && optim_unroll > OPTIM_UNROLL_BUDGET / body_cost)
+    {
+        return n;
+    }
+
+    /* Les itérations restantes ne profitent pas du déroulage */
+    if (trip >= 0 && trip < 2 * optim_unroll) return n;
+    if (!unroll_is_profitable(loop, optim_unroll, trip)) return n;
+
+    return partial_unroll(n, optim_unroll);
+}
+
+
+/**
+ * @brief Applique le déroulage à tous les POUR de la liste d'instructions, en
+ * commençant par les plus imbriqués.
+ *
+ * @param t
+ */
+static void unroll_list(ast *t)
+{
+    for (; t != NULL; t = t->list_instr.next)
+    {
+        ast *instr = t->list_instr.instr, *c;
+        switch (instr->type)
+        {
+        case if_type:
+            unroll_list(instr->if_n.list_instr1);
+            unroll_list(instr->if_n.list_instr2);
+            break;
+        case switch_type:
+            for (c = instr->switch_n.cases; c != NULL; c = c->case_n.next)
+            {
+                unroll_list(c->case_n.list_instr);
+            }
+            unroll_list(instr->switch_n.default_instr);
+            break;
+        case while_type:
+            unroll_list(instr->while_n.list_instr);
+            break;
+        case do_while_type:
+            unroll_list(instr->do_while.list_instr);
+            break;
+        case for_type:
+            unroll_list(instr->for_n.list_instr);
+            t = unroll_loop(t);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+
+/**
+ * @brief Déroulage des POUR (--unroll=N).
+ *
+ * Les POUR dont les bornes sont constantes sont entièrement déroulés, ce qui
+ * supprime le test de la condition, les sauts et l'incrément de la variable.
+ * Les autres sont déroulés `optim_unroll` fois, avec une boucle pour les
+ * itérations restantes.
+ * Dans les 2 cas la taille du code déroulé est limitée à OPTIM_UNROLL_BUDGET
+ * instructions.
+ *
+ * @param t La racine de l'ASA
+ */
+void optim_unroll_loops(ast *t)
+{
+    optim_func *f;
+    for (f = funcs; f != NULL; f = f->next)
+    {
+        cur_func = f;
+        unroll_list(f->node->func_decla.list_instr);
+    }
+    cur_func = NULL;
+}
+
+
+/************** Élimination des sous-expressions communes (CSE) **************/
+
+
+/*
+ * Expression calculée plusieurs fois dans une suite d'instructions.
+ * first: l'emplacement de la 1ère occurrence
+ * n: le noeud de la liste d'instructions contenant la 1ère occurrence
+ * others: les emplacements des occurrences suivantes
+ * nb: le nombre d'occurrences, pondéré par la probabilité qu'elles soient
+ * évaluées (voir cse_visit)
+ * depth: la valeur de cse_depth à la 1ère occurrence
+ * is_available: 0 si une variable lue par l'expression a pu être modifiée
+ * depuis la 1ère occurrence
+ */
+typedef struct _cse_expr {
+    ast **first;
+    ast *n;
+    slot_list *others;
+    int nb;
+    int depth;
+    int is_available;
+    struct _cse_expr *next;
+} cse_expr;
+
+
+/* Poids d'une occurrence évaluée chaque fois que la 1ère l'est */
+#define CSE_WEIGHT 64
+
+/*
+ * L'instruction courante est supposée exécutée une fois sur 2^cse_depth:
+ * chaque branche d'un SI une fois sur 2, et chacune des k branches d'un SELON
+ * une fois sur k (arrondi à la puissance de 2 supérieure).
+ */
+static int cse_depth = 0;
+
+
+/**
+ * @brief Renvoie 1 si l'expression lit la valeur de la variable `id`.
+ *
+ * @param t
+ * @param id
+ * @return int
+ */
+static int reads_var(ast *t, const char *id)
+{
+    if (t == NULL) return 0;
+
+    switch (t->type)
+    {
+    case id_type:
+        return strcmp(t->id.name, id) == 0;
+    case b_op_type:
+        return reads_var(t->b_op.l_memb, id) || reads_var(t->b_op.r_memb, id);
+    case u_op_type:
+        /* @x ne dépend pas de la valeur de x */
+        if (t->u_op.ope == '@') return 0;
+        return reads_var(t->u_op.child, id);
+    case array_access_type:
+        return reads_var(t->arr_access.id, id)
+               || reads_var(t->arr_access.ind_expr, id);
+    default:
+        return 0;
+    }
+}
+
+
+/**
+ * @brief Renvoie 1 si la valeur de l'expression peut être modifiée par une
+ * écriture via un pointeur: elle lit la mémoire (*p, tab[i]) ou une variable
+ * dont l'adresse est prise.
+ *
+ * @param t
+ * @return int
+ */
+static int reads_mem(ast *t)
+{
+    optim_var *v;
+    if (t == NULL) return 0;
+
+    switch (t->type)
+    {
+    case id_type:
+        v = lookup(t->id.name);
+        return v == NULL || v->is_addr_taken;
+    case b_op_type:
+        return reads_mem(t->b_op.l_memb) || reads_mem(t->b_op.r_memb);
+    case u_op_type:
+        if (t->u_op.ope == '@') return 0;
+        return t->u_op.ope == '*' || reads_mem(t->u_op.child);
+    case array_access_type:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+
+/**
+ * @brief Renvoie 1 si l'expression contient un appel de fonction ou un LIRE.
+ * Ces expressions sont des barrières pour la CSE: un appel peut modifier
+ * n'importe quelle variable globale ou la mémoire.
+ *
+ * @param t
+ * @return int
+ */
+static int has_barrier(ast *t)
+{
+    return !is_pure(t);
+}
+
+
+/**
+ * @brief Invalide les expressions dont la valeur peut être modifiée par `t`
+ * (instruction ou expression), avec la même analyse d'alias que LICM: un
+ * appel de fonction n'invalide que les lectures de la mémoire et des
+ * variables qu'il peut modifier.
+ *
+ * @param l
+ * @param t
+ */
+static void cse_kill_code(cse_expr *l, ast *t)
+{
+    effects eff = {0};
+
+    collect_effects(t, &eff);
+    for (; l != NULL; l = l->next)
+    {
+        if (l->is_available && !is_invariant(*l->first, &eff))
+        {
+            l->is_available = 0;
+        }
+    }
+    free_names(eff.modified);
+}
+
+
+/**
+ * @brief Invalide les expressions qui lisent la variable `id` (si non NULL),
+ * et celles qui lisent la mémoire si `mem` vaut 1.
+ *
+ * @param l
+ * @param id
+ * @param mem
+ */
+static void cse_kill(cse_expr *l, const char *id, int mem)
+{
+    for (; l != NULL; l = l->next)
+    {
+        ast *e = *l->first;
+        if ((id != NULL && reads_var(e, id)) || (mem && reads_mem(e)))
+        {
+            l->is_available = 0;
+        }
+    }
+}
+
+
+/**
+ * @brief Invalide les expressions dépendant de la variable `id` après une
+ * affectation.
+ *
+ * @param l
+ * @param id
+ */
+static void cse_kill_var(cse_expr *l, const char *id)
+{
+    optim_var *v = lookup(id);
+    cse_kill(l, id, v == NULL || v->is_addr_taken);
+}
+
+
+/**
+ * @brief Numérotation des valeurs de l'expression pointée par `slot`.
+ * Les sous-expressions sont parcourues avant l'expression, l'ordre de
+ * création des expressions est donc un ordre dans lequel elles peuvent être
+ * calculées.
+ *
+ * Une expression en position conditionnelle (membre droit d'un ET / OU) n'est
+ * pas toujours évaluée: elle peut réutiliser une valeur déjà calculée, mais ne
+ * peut pas être la 1ère occurrence d'une expression.
+ * Le poids d'une occurrence est divisé par la fréquence d'exécution supposée
+ * de la 1ère relativement à la sienne (voir cse_depth), et par 2 si elle est
+ * en position conditionnelle.
+ *
+ * @param slot
+ * @param n Le noeud de la liste d'instructions contenant l'expression
+ * @param is_cond
+ * @param l
+ */
+static void cse_visit(ast **slot, ast *n, int is_cond, cse_expr **l)
+{
+    ast *t = *slot;
+    cse_expr *e;
+
+    if (t == NULL) return;
+
+    int is_candidate = t->type == b_op_type
+                       || (t->type == u_op_type && t->u_op.ope != '@')
+                       || (t->type == array_access_type
+                           && t->arr_access.affect_expr == NULL);
+
+    if (is_candidate)
+    {
+        for (e = *l; e != NULL; e = e->next)
+        {
+            if (e->is_available && expr_equal(*e->first, t)) break;
+        }
+
+        if (e != NULL)
+        {
+            slot_list *s = (slot_list *) malloc(sizeof(slot_list));
+            check_alloc(s);
+            s->slot = slot;
+            s->next = e->others;
+            e->others = s;
+
+            int shift = cse_depth - e->depth + is_cond;
+            e->nb += shift < 6 ? CSE_WEIGHT >> shift : 1;
+            return;
+        }
+    }
+
+    switch (t->type)
+    {
+    case b_op_type:
+        cse_visit(&t->b_op.l_memb, n, is_cond, l);
+        if (t->b_op.ope == AND_OP || t->b_op.ope == OR_OP) is_cond = 1;
+        cse_visit(&t->b_op.r_memb, n, is_cond, l);
+        break;
+    case u_op_type:
+        if (t->u_op.ope == '-' || t->u_op.ope == NOT_OP)
+        {
+            cse_visit(&t->u_op.child, n, is_cond, l);
+        }
+        break;
+    case array_access_type:
+        cse_visit(&t->arr_access.ind_expr, n, is_cond, l);
+        break;
+    default:
+        break;
+    }
+
+    /* Coût de lecture de la variable temporaire */
+    int tmp_cost = cur_func->is_recursive ? 4 : 1;
+    if (!is_candidate || is_cond || expr_cost(t) <= tmp_cost) return;
+
+    e = (cse_expr *) calloc(1, sizeof(cse_expr));
+    check_alloc(e);
+    e->first = slot;
+    e->n = n;
+    e->nb = CSE_WEIGHT;
+    e->depth = cse_depth;
+    e->is_available = 1;
+
+    /* Ajout en fin de liste pour garder l'ordre de création */
+    if (*l == NULL) *l = e;
+    else
+    {
+        cse_expr *aux = *l;
+        while (aux->next != NULL) aux = aux->next;
+        aux->next = e;
+    }
+}
+
+
+/**
+ * @brief Visite l'expression si elle ne contient pas d'appel de fonction ni de
+ * LIRE, sinon invalide les expressions qu'elle peut modifier.
+ *
+ * @param slot
+ * @param n
+ * @param l
+ */
+static void cse_visit_expr(ast **slot, ast *n, cse_expr **l)
+{
+    if (has_barrier(*slot)) cse_kill_code(*l, *slot);
+    else cse_visit(slot, n, 0, l);
+}
+
+
+/**
+ * @brief Visite la condition d'une boucle ou la borne d'un POUR. Elle peut
+ * réutiliser une valeur disponible, mais ne peut pas être la 1ère occurrence
+ * d'une expression (la variable temporaire serait affectée avant la boucle).
+ *
+ * @param slot
+ * @param n
+ * @param l
+ */
+static void cse_visit_cond(ast **slot, ast *n, cse_expr **l)
+{
+    if (has_barrier(*slot)) cse_kill_code(*l, *slot);
+    else cse_visit(slot, n, 1, l);
+}
+
+
+static void cse_block(ast *t, cse_expr **l);
+
+
+/**
+ * @brief Sauvegarde la disponibilité des expressions (avant un SI).
+ *
+ * @param l
+ * @param nb Le nombre d'expressions sauvegardées
+ * @return int*
+ */
+static int *cse_save(cse_expr *l, int *nb)
+{
+    cse_expr *aux;
+    int i = 0;
+
+    for (aux = l, *nb = 0; aux != NULL; aux = aux->next) (*nb)++;
+
+    int *saved = (int *) malloc(sizeof(int) * (*nb + 1));
+    check_alloc(saved);
+    for (aux = l; aux != NULL; aux = aux->next) saved[i++] = aux->is_available;
+
+    return saved;
+}
+
+
+/**
+ * @brief Restaure la disponibilité des expressions sauvegardée par cse_save.
+ * Les expressions créées depuis ne sont pas disponibles.
+ *
+ * @param l
+ * @param saved
+ * @param nb
+ */
+static void cse_restore(cse_expr *l, int *saved, int nb)
+{
+    int i;
+    for (i = 0; l != NULL; l = l->next, i++)
+    {
+        l->is_available = i < nb ? saved[i] : 0;
+    }
+}
+
+
+/**
+ * @brief Garde dans `avail` les expressions encore disponibles (à la fin
+ * d'une branche d'un SI ou d'un SELON).
+ *
+ * @param l
+ * @param avail
+ * @param nb
+ */
+static void cse_and(cse_expr *l, int *avail, int nb)
+{
+    int i;
+    for (i = 0; l != NULL && i < nb; l = l->next, i++)
+    {
+        avail[i] = avail[i] && l->is_available;
+    }
+}
+
+
+/**
+ * @brief Après un SI, un SELON ou une boucle: seules les expressions
+ * disponibles avant (`avail`) et toujours disponibles le restent. Les
+ * expressions créées depuis ne le sont pas.
+ *
+ * @param l
+ * @param avail
+ * @param nb
+ */
+static void cse_merge(cse_expr *l, int *avail, int nb)
+{
+    int i;
+    for (i = 0; l != NULL; l = l->next, i++)
+    {
+        l->is_available = l->is_available && i < nb && avail[i];
+    }
+}
+
+
+/**
+ * @brief Numérotation des valeurs de l'instruction contenue dans le noeud `n`
+ * de la liste d'instructions, puis invalidation des expressions dont la
+ * valeur peut être modifiée par l'instruction.
+ *
+ * Les valeurs calculées avant un SI sont disponibles dans ses 2 branches, et
+ * restent disponibles après s'il ne les modifie pas. Celles qu'une boucle ne
+ * modifie pas sont disponibles dans la boucle et après elle.
+ *
+ * @param n
+ * @param l
+ */
+static void cse_instr(ast *n, cse_expr **l)
+{
+    ast *instr = n->list_instr.instr, *c;
+    int *saved, *avail, nb, shift, k;
+
+    switch (instr->type)
+    {
+    case affect_type:
+        cse_visit_expr(&instr->affect.expr, n, l);
+        if (instr->affect.is_deref) cse_kill(*l, NULL, 1);
+        else cse_kill_var(*l, instr->affect.id->id.name);
+        break;
+    case array_access_type:
+        if (instr->arr_access.affect_expr == NULL)
+        {
+            cse_visit_expr(&n->list_instr.instr, n, l);
+            break;
+        }
+
+        if (has_barrier(instr))
+        {
+            cse_kill_code(*l, instr);
+            break;
+        }
+        cse_visit(&instr->arr_access.ind_expr, n, 0, l);
+        cse_visit(&instr->arr_access.affect_expr, n, 0, l);
+        cse_kill(*l, NULL, 1);
+        break;
+    case io_type:
+        if (instr->io.mode == 'r') cse_kill_code(*l, instr);
+        else cse_visit_expr(&instr->io.expr, n, l);
+        if (instr->io.mode == 'R') cse_kill(*l, NULL, 1);
+        break;
+    case alloc_type:
+        cse_visit_expr(&instr->alloc.expr, n, l);
+        cse_kill_var(*l, instr->alloc.id->id.name);
+        break;
+    case inc_type:
+        cse_kill_var(*l, instr->inc.id->id.name);
+        break;
+    case free_type:
+        cse_kill(*l, NULL, 1);
+        break;
+    case block_type:
+        if (instr->block.op == 'f')
+        {
+            cse_visit_expr(&instr->block.src, n, l);
+        }
+        cse_visit_expr(&instr->block.size, n, l);
+        cse_kill(*l, NULL, 1);
+        break;
+    case return_type:
+        cse_visit_expr(&instr->return_n.expr, n, l);
+        break;
+    case if_type:
+        cse_visit_expr(&instr->if_n.expr, n, l);
+        saved = cse_save(*l, &nb);
+        avail = cse_save(*l, &nb);
+        cse_depth++;
+        cse_block(instr->if_n.list_instr1, l);
+        cse_and(*l, avail, nb);
+        cse_restore(*l, saved, nb);
+        cse_block(instr->if_n.list_instr2, l);
+        cse_depth--;
+        cse_merge(*l, avail, nb);
+        free(saved);
+        free(avail);
+        break;
+    case switch_type:
+        cse_visit_expr(&instr->switch_n.expr, n, l);
+        saved = cse_save(*l, &nb);
+        avail = cse_save(*l, &nb);
+
+        /* k branches, SINON compris (voir cse_depth) */
+        k = 1;
+        for (c = instr->switch_n.cases; c != NULL; c = c->case_n.next) k++;
+        for (shift = 0; (1 << shift) < k; shift++);
+        cse_depth += shift;
+
+        for (c = instr->switch_n.cases; c != NULL; c = c->case_n.next)
+        {
+            cse_block(c->case_n.list_instr, l);
+            cse_and(*l, avail, nb);
+            cse_restore(*l, saved, nb);
+        }
+        cse_block(instr->switch_n.default_instr, l);
+        cse_depth -= shift;
+        cse_merge(*l, avail, nb);
+        free(saved);
+        free(avail);
+        break;
+    case for_type:
+        cse_visit_expr(&instr->for_n.affect_init->affect.expr, n, l);
+        cse_kill_code(*l, instr);
+        saved = cse_save(*l, &nb);
+        cse_visit_cond(&instr->for_n.end_exp->b_op.r_memb, n, l);
+        cse_block(instr->for_n.list_instr, l);
+        cse_merge(*l, saved, nb);
+        free(saved);
+        break;
+    case while_type:
+        cse_kill_code(*l, instr);
+        saved = cse_save(*l, &nb);
+        cse_visit_cond(&instr->while_n.expr, n, l);
+        cse_block(instr->while_n.list_instr, l);
+        cse_merge(*l, saved, nb);
+        free(saved);
+        break;
+    case do_while_type:
+        /*
+         * La condition est évaluée juste après le corps, et la boucle n'est
+         * quittée qu'après elle: les valeurs disponibles à ce moment le
+         * restent après la boucle.
+         */
+        cse_kill_code(*l, instr);
+        cse_block(instr->do_while.list_instr, l);
+        cse_visit_cond(&instr->do_while.expr, n, l);
+        break;
+    default:
+        /* Expression utilisée comme instruction */
+        cse_visit_expr(&n->list_instr.instr, n, l);
+        break;
+    }
+}
+
+
+/**
+ * @brief Remplace les expressions calculées plusieurs fois par une variable
+ * temporaire, si c'est rentable.
+ * La variable est affectée juste avant l'instruction contenant la 1ère
+ * occurrence de l'expression.
+ *
+ * @param l
+ */
+static void cse_commit(cse_expr *l)
+{
+    int is_static = !cur_func->is_recursive;
+    int store_cost = is_static ? 1 : 6;
+    int read_cost = is_static ? 1 : 4;
+    char tmp[ID_MAX_SIZE];
+    cse_expr *e, *f;
+    slot_list *s;
+
+    for (e = l; e != NULL; e = e->next)
+    {
+        int cost = expr_cost(*e->first);
+        if (e->nb * cost
+            <= CSE_WEIGHT * (cost + store_cost) + e->nb * read_cost) continue;
+
+        new_tmp(tmp, integer);
+        for (s = e->others; s != NULL; s = s->next)
+        {
+            ast *leaf = create_id_leaf(tmp);
+            leaf->pos_infos = (*s->slot)->pos_infos;
+            free_ast(*s->slot);
+            *s->slot = leaf;
+        }
+
+        ast *expr = *e->first;
+        *e->first = create_id_leaf(tmp);
+        (*e->first)->pos_infos = expr->pos_infos;
+
+        ast *affect = create_affect_node(tmp, expr, 0);
+        affect->pos_infos = expr->pos_infos;
+
+        /* L'instruction d'origine change de noeud */
+        ast *moved = insert_before(e->n, affect);
+        for (f = e->next; f != NULL; f = f->next)
+        {
+            if (f->n == e->n) f->n = moved;
+        }
+    }
+}
+
+
+static void cse_block(ast *t, cse_expr **l)
+{
+    for (; t != NULL; t = t->list_instr.next) cse_instr(t, l);
+}
+
+
+/**
+ * @brief Applique la CSE au corps d'une fonction.
+ *
+ * @param t
+ */
+static void cse_func(ast *t)
+{
+    cse_expr *l = NULL, *aux;
+
+    cse_block(t, &l);
+    cse_commit(l);
+
+    while (l != NULL)
+    {
+        while (l->others != NULL)
+        {
+            slot_list *s = l->others->next;
+            free(l->others);
+            l->others = s;
+        }
+
+        aux = l->next;
+        free(l);
+        l = aux;
+    }
+}
+
+
+/**
+ * @brief Élimination des sous-expressions communes (numérotation locale des
+ * valeurs).
+ *
+ * Une expression calculée plusieurs fois, sans que les variables ou la mémoire
+ * qu'elle lit ne puissent être modifiées entre temps (affectation, écriture
+ * via un pointeur ou dans un tableau, appel de fonction), est calculée une
+ * seule fois dans une variable temporaire. Par exemple:
+ *
+ * SI T[i + 1] > T[i] ALORS x <- T[i + 1] FSI
+ *
+ * devient:
+ *
+ * $t <- T[i + 1]
+ * SI $t > T[i] ALORS x <- $t FSI
+ *
+ * @param t La racine de l'ASA
+ */
+void optim_cse(ast *t)
+{
+    optim_func *f;
+    for (f = funcs; f != NULL; f = f->next)
+    {
+        cur_func = f;
+        cse_func(f->node->func_decla.list_instr);
+    }
+    cur_func = NULL;
+}
+
+
+
+/*************************** Élimination du code mort ***************************/
+
+
+/* Taille d'une instruction dans le fichier produit (voir add_instr) */
+#define RAM_INSTR_SIZE 17
+
+
+/**
+ * @brief Remplace les sous-expressions constantes par leur valeur
+ * (`2 * 3 + x` devient `6 + x`, `SI 1 > 2` devient `SI 0`).
+ *
+ * @param slot
+ */
+static void fold_code(ast **slot)
+{
+    ast *t = *slot;
+    int val;
+
+    if (t == NULL) return;
+
+    switch (t->type)
+    {
+    case b_op_type:
+        fold_code(&t->b_op.l_memb);
+        fold_code(&t->b_op.r_memb);
+        break;
+    case u_op_type:
+        /* Le fils de @ et * doit rester un identificateur */
+        if (t->u_op.ope == '-' || t->u_op.ope == NOT_OP)
+        {
+            fold_code(&t->u_op.child);
+        }
+        break;
+    case affect_type:
+        fold_code(&t->affect.expr);
+        return;
+    case instr_type:
+        fold_code(&t->list_instr.instr);
+        fold_code(&t->list_instr.next);
+        return;
+    case decla_type:
+        fold_code(&t->decla_list.decla);
+        fold_code(&t->decla_list.next);
+        return;
+    case var_decla_type:
+        fold_code(&t->var_decla.expr);
+        if (t->var_decla.type == array)
+        {
+            fold_code(&t->var_decla.var->arr_decla.list_expr);
+        }
+        fold_code(&t->var_decla.next);
+        return;
+    case while_type:
+        fold_code(&t->while_n.expr);
+        fold_code(&t->while_n.list_instr);
+        return;
+    case do_while_type:
+        fold_code(&t->do_while.list_instr);
+        fold_code(&t->do_while.expr);
+        return;
+    case if_type:
+        fold_code(&t->if_n.expr);
+        fold_code(&t->if_n.list_instr1);
+        fold_code(&t->if_n.list_instr2);
+        return;
+    case switch_type:
+        fold_code(&t->switch_n.expr);
+        fold_code(&t->switch_n.cases);
+        fold_code(&t->switch_n.default_instr);
+        return;
+    case case_type:
+        fold_code(&t->case_n.list_instr);
+        fold_code(&t->case_n.next);
+        return;
+    case for_type:
+        /* La condition i < fin doit rester une comparaison avec i */
+        fold_code(&t->for_n.affect_init->affect.expr);
+        fold_code(&t->for_n.end_exp->b_op.r_memb);
+        fold_code(&t->for_n.list_instr);
+        return;
+    case io_type:
+        fold_code(&t->io.expr);
+        return;
+    case func_call_type:
+        fold_code(&t->func_call.params);
+        return;
+    case exp_list_type:
+        fold_code(&t->exp_list.exp);
+        fold_code(&t->exp_list.next);
+        return;
+    case return_type:
+        fold_code(&t->return_n.expr);
+        return;
+    case array_access_type:
+        fold_code(&t->arr_access.ind_expr);
+        fold_code(&t->arr_access.affect_expr);
+        return;
+    case alloc_type:
+        fold_code(&t->alloc.expr);
+        return;
+    case block_type:
+        if (t->block.op == 'f') fold_code(&t->block.src);
+        fold_code(&t->block.size);
+        return;
+    default:
+        return;
+    }
+
+    if (fold_const(t, &val))
+    {
+        *slot = create_nb_leaf(val);
+        (*slot)->pos_infos = expr_pos(t);
+        free_ast(t);
+    }
+}
+
+
+/**
+ * @brief Supprime le noeud `n` d'une liste d'instructions (`prev` est le noeud
+ * précédent, NULL si `n` est en tête de liste).
+ * Le 1er noeud d'une liste est référencé par son parent: on y déplace alors
+ * l'instruction suivante. Une liste ne devient jamais vide (l'analyse
+ * sémantique suppose qu'un bloc contient au moins une instruction).
+ *
+ * @param prev
+ * @param n
+ * @return int 1 si l'instruction a été supprimée, 0 sinon
+ */
+static int remove_instr(ast *prev, ast *n)
+{
+    ast *instr = n->list_instr.instr;
+    ast *next = n->list_instr.next;
+
+    if (next != NULL)
+    {
+        n->list_instr.instr = next->list_instr.instr;
+        n->list_instr.next = next->list_instr.next;
+        n->pos_infos = next->pos_infos;
+        free(next);
+    }
+    else if (prev != NULL)
+    {
+        prev->list_instr.next = NULL;
+        free(n);
+    }
+    else return 0;
+
+    free_ast(instr);
+    return 1;
+}
+
+
+static int always_returns(ast *t);
+
+
+/**
+ * @brief Renvoie 1 si l'exécution de la liste d'instructions se termine
+ * toujours par un RETOURNER.
+ *
+ * @param l
+ * @return int
+ */
+static int list_returns(ast *l)
+{
+    for (; l != NULL; l = l->list_instr.next)
+    {
+        if (always_returns(l->list_instr.instr)) return 1;
+    }
+
+    return 0;
+}
+
+
+static int always_returns(ast *t)
+{
+    ast *c;
+
+    switch (t->type)
+    {
+    case return_type:
+        return 1;
+    case if_type:
+        return list_returns(t->if_n.list_instr1)
+               && list_returns(t->if_n.list_instr2);
+    case switch_type:
+        /* Sans SINON, l'exécution continue après le SELON */
+        if (!list_returns(t->switch_n.default_instr)) return 0;
+        for (c = t->switch_n.cases; c != NULL; c = c->case_n.next)
+        {
+            if (!list_returns(c->case_n.list_instr)) return 0;
+        }
+        return 1;
+    case do_while_type:
+        return list_returns(t->do_while.list_instr);
+    default:
+        return 0;
+    }
+}
+
+
+/**
+ * @brief Supprime le code inaccessible de la liste d'instructions:
+ * - SI dont la condition est constante: seule la branche exécutée est gardée
+ * - SELON dont la valeur est constante: seul le CAS exécuté est gardé
+ * - TQ FAUX et POUR sans itération (bornes constantes)
+ * - FAIRE ... TQ FAUX: le corps est exécuté une seule fois
+ * - les instructions qui suivent un SI dont toutes les branches se terminent
+ * par RETOURNER (celles qui suivent directement un RETOURNER sont déjà
+ * ignorées par la génération de code, et signalées par l'analyse sémantique)
+ *
+ * @param l
+ */
+static void prune_list(ast *l)
+{
+    ast *prev = NULL, *n = l, *kept, *instr, *c;
+    int val, start, end, removed;
+
+    while (n != NULL)
+    {
+        instr = n->list_instr.instr;
+        kept = NULL;
+        removed = 0;
+
+        switch (instr->type)
+        {
+        case if_type:
+            prune_list(instr->if_n.list_instr1);
+            prune_list(instr->if_n.list_instr2);
+            if (!fold_const(instr->if_n.expr, &val)) break;
+
+            if (val)
+            {
+                kept = instr->if_n.list_instr1;
+                instr->if_n.list_instr1 = NULL;
+            }
+            else if (instr->if_n.list_instr2 != NULL)
+            {
+                kept = instr->if_n.list_instr2;
+                instr->if_n.list_instr2 = NULL;
+            }
+            else removed = remove_instr(prev, n);
+            break;
+        case switch_type:
+            for (c = instr->switch_n.cases; c != NULL; c = c->case_n.next)
+            {
+                prune_list(c->case_n.list_instr);
+            }
+            prune_list(instr->switch_n.default_instr);
+            if (!fold_const(instr->switch_n.expr, &val)) break;
+
+            c = instr->switch_n.cases;
+            while (c != NULL && c->case_n.val != val) c = c->case_n.next;
+
+            if (c != NULL)
+            {
+                kept = c->case_n.list_instr;
+                c->case_n.list_instr = NULL;
+            }
+            else if (instr->switch_n.default_instr != NULL)
+            {
+                kept = instr->switch_n.default_instr;
+                instr->switch_n.default_instr = NULL;
+            }
+            else removed = remove_instr(prev, n);
+            break;
+        case while_type:
+            prune_list(instr->while_n.list_instr);
+            if (fold_const(instr->while_n.expr, &val) && !val)
+            {
+                removed = remove_instr(prev, n);
+            }
+            break;
+        case do_while_type:
+            prune_list(instr->do_while.list_instr);
+            if (fold_const(instr->do_while.expr, &val) && !val)
+            {
+                kept = instr->do_while.list_instr;
+                instr->do_while.list_instr = NULL;
+            }
+            break;
+        case for_type:
+            prune_list(instr->for_n.list_instr);
+            if (fold_const(instr->for_n.affect_init->affect.expr, &start)
+                && fold_const(instr->for_n.end_exp->b_op.r_memb, &end)
+                && start >= end)
+            {
+                /* Seule l'initialisation du compteur est exécutée */
+                n->list_instr.instr = instr->for_n.affect_init;
+                instr->for_n.affect_init = NULL;
+                free_ast(instr);
+            }
+            break;
+        default:
+            break;
+        }
+
+        if (removed)
+        {
+            /* L'instruction suivante a pris la place de `n` */
+            n = prev == NULL ? l : prev->list_instr.next;
+            continue;
+        }
+
+        if (kept != NULL)
+        {
+            /* Le bloc exécuté prend la place de l'instruction */
+            free_ast(instr);
+            n = replace_instr(n, kept);
+        }
+
+        instr = n->list_instr.instr;
+        if (instr->type != return_type && always_returns(instr)
+            && n->list_instr.next != NULL)
+        {
+            free_ast(n->list_instr.next);
+            n->list_instr.next = NULL;
+        }
+
+        prev = n;
+        n = n->list_instr.next;
+    }
+}
+
+
+/**
+ * @brief Renvoie 1 si l'optimiseur connaît toutes les lectures et écritures
+ * de la variable: variable locale (paramètre compris) ou temporaire, qui n'est
+ * pas un tableau et dont l'adresse n'est pas prise.
+ * Les variables globales peuvent être lues par les autres fonctions.
+ *
+ * @param id
+ * @return int
+ */
+static int is_tracked(const char *id)
+{
+    optim_var *v = lookup(id);
+    if (v == NULL || v->type == array || v->is_addr_taken) return 0;
+
+    return v->mem_zone == 's'
+           || strncmp(id, OPTIM_TMP_PREFIX, strlen(OPTIM_TMP_PREFIX)) == 0;
+}
+
+
+static name_list *remove_name(name_list *l, const char *id)
+{
+    name_list **aux, *tmp;
+    for (aux = &l; *aux != NULL; aux = &(*aux)->next)
+    {
+        if (strcmp((*aux)->id, id) == 0)
+        {
+            tmp = *aux;
+            *aux = tmp->next;
+            free(tmp);
+            break;
+        }
+    }
+
+    return l;
+}
+
+
+static name_list *copy_names(name_list *l)
+{
+    name_list *copy = NULL;
+    for (; l != NULL; l = l->next) copy = add_name(copy, l->id);
+
+    return copy;
+}
+
+
+static int nb_names(name_list *l)
+{
+    int n = 0;
+    for (; l != NULL; l = l->next) n++;
+
+    return n;
+}
+
+
+/**
+ * @brief Ajoute les noms de `l2` à la liste `l` et libère `l2`.
+ *
+ * @param l
+ * @param l2
+ * @return name_list*
+ */
+static name_list *merge_names(name_list *l, name_list *l2)
+{
+    name_list *aux;
+    for (aux = l2; aux != NULL; aux = aux->next) l = add_name(l, aux->id);
+    free_names(l2);
+
+    return l;
+}
+
+
+/**
+ * @brief Ajoute à l'ensemble `live` les variables suivies lues par
+ * l'expression.
+ *
+ * @param live
+ * @param t
+ * @return name_list*
+ */
+static name_list *live_uses(name_list *live, ast *t)
+{
+    if (t == NULL) return live;
+
+    switch (t->type)
+    {
+    case id_type:
+        if (is_tracked(t->id.name)) live = add_name(live, t->id.name);
+        return live;
+    case b_op_type:
+        live = live_uses(live, t->b_op.l_memb);
+        return live_uses(live, t->b_op.r_memb);
+    case u_op_type:
+        /* @x ne lit pas x (et x n'est alors pas suivie) */
+        if (t->u_op.ope == '@') return live;
+        return live_uses(live, t->u_op.child);
+    case array_access_type:
+        live = live_uses(live, t->arr_access.id);
+        live = live_uses(live, t->arr_access.ind_expr);
+        return live_uses(live, t->arr_access.affect_expr);
+    case func_call_type:
+        return live_uses(live, t->func_call.params);
+    case exp_list_type:
+        live = live_uses(live, t->exp_list.exp);
+        return live_uses(live, t->exp_list.next);
+    case io_type:
+        live = live_uses(live, t->io.id);
+        return live_uses(live, t->io.expr);
+    default:
+        return live;
+    }
+}
+
+
+/**
+ * @brief Renvoie 1 si l'affectation d'une valeur calculée par `expr` à la
+ * variable `id` peut être supprimée quand la variable n'est plus lue.
+ *
+ * @param id
+ * @param expr
+ * @return int
+ */
+static int is_removable(const char *id, ast *expr)
+{
+    return is_tracked(id) && is_pure(expr) && !may_trap(expr);
+}
+
+
+static name_list *live_list(ast *l, name_list *live, int remove);
+
+
+/**
+ * @brief Calcule les variables vivantes avant l'instruction `t` à partir de
+ * celles vivantes après (`live`, libérée par la fonction).
+ * Une affectation à une variable qui n'est plus lue est une affectation morte:
+ * elle ne rend pas vivantes les variables de son expression.
+ *
+ * @param t
+ * @param live
+ * @param remove 1 pour supprimer les affectations mortes des boucles et SI
+ * contenus dans `t`
+ * @param is_dead Mis à 1 si `t` est une affectation morte
+ * @return name_list*
+ */
+static name_list *live_instr(ast *t, name_list *live, int remove, int *is_dead)
+{
+    name_list *aux;
+    ast *c;
+    char *id;
+    int n;
+
+    *is_dead = 0;
+
+    switch (t->type)
+    {
+    case affect_type:
+        id = t->affect.id->id.name;
+        if (t->affect.is_deref) live = live_uses(live, t->affect.id);
+        else if (!has_name(live, id) && is_removable(id, t->affect.expr))
+        {
+            *is_dead = 1;
+            return live;
+        }
+        else live = remove_name(live, id);
+        return live_uses(live, t->affect.expr);
+    case alloc_type:
+        live = remove_name(live, t->alloc.id->id.name);
+        return live_uses(live, t->alloc.expr);
+    case free_type:
+        return live_uses(live, t->free_n.id);
+    case block_type:
+        live = live_uses(live, t->block.dst);
+        live = live_uses(live, t->block.src);
+        return live_uses(live, t->block.size);
+    case inc_type:
+        id = t->inc.id->id.name;
+        if (is_tracked(id) && !has_name(live, id))
+        {
+            *is_dead = 1;
+            return live;
+        }
+        return live_uses(live, t->inc.id);
+    case return_type:
+        free_names(live);
+        return live_uses(NULL, t->return_n.expr);
+    case if_type:
+        aux = live_list(t->if_n.list_instr1, copy_names(live), remove);
+        if (t->if_n.list_instr2 != NULL)
+        {
+            live = live_list(t->if_n.list_instr2, live, remove);
+        }
+        live = merge_names(live, aux);
+        return live_uses(live, t->if_n.expr);
+    case switch_type:
+        /* Sans SINON, les variables vivantes après le SELON le restent */
+        aux = copy_names(live);
+        if (t->switch_n.default_instr != NULL)
+        {
+            free_names(aux);
+            aux = live_list(t->switch_n.default_instr, copy_names(live),
+                            remove);
+        }
+        for (c = t->switch_n.cases; c != NULL; c = c->case_n.next)
+        {
+            aux = merge_names(aux, live_list(c->case_n.list_instr,
+                                             copy_names(live), remove));
+        }
+        free_names(live);
+        return live_uses(aux, t->switch_n.expr);
+    case while_type:
+        /* Point fixe: variables vivantes avant l'évaluation de la condition */
+        live = live_uses(live, t->while_n.expr);
+        do {
+            n = nb_names(live);
+            aux = live_list(t->while_n.list_instr, copy_names(live), 0);
+            live = merge_names(live, aux);
+        } while (nb_names(live) != n);
+
+        if (remove)
+        {
+            free_names(live_list(t->while_n.list_instr, copy_names(live), 1));
+        }
+        return live;
+    case do_while_type:
+        /* Point fixe: variables vivantes après le corps de la boucle */
+        live = live_uses(live, t->do_while.expr);
+        do {
+            n = nb_names(live);
+            aux = live_list(t->do_while.list_instr, copy_names(live), 0);
+            live = merge_names(live, aux);
+        } while (nb_names(live) != n);
+
+        return live_list(t->do_while.list_instr, live, remove);
+    case for_type:
+        /* Point fixe: variables vivantes avant la comparaison i < fin */
+        live = live_uses(live, t->for_n.end_exp);
+        do {
+            n = nb_names(live);
+            aux = live_list(t->for_n.list_instr, copy_names(live), 0);
+            live = merge_names(live, aux);
+        } while (nb_names(live) != n);
+
+        if (remove)
+        {
+            free_names(live_list(t->for_n.list_instr, copy_names(live), 1));
+        }
+
+        live = remove_name(live, t->for_n.id->id.name);
+        return live_uses(live, t->for_n.affect_init->affect.expr);
+    default:
+        return live_uses(live, t);
+    }
+}
+
+
+/**
+ * @brief Calcule les variables vivantes au début de la liste d'instructions
+ * `l` (parcourue à l'envers) à partir de celles vivantes à la fin.
+ *
+ * @param l
+ * @param live Libérée par la fonction
+ * @param remove 1 pour supprimer les affectations mortes
+ * @return name_list*
+ */
+static name_list *live_list(ast *l, name_list *live, int remove)
+{
+    ast *aux;
+    int n = 0, i, is_dead;
+
+    for (aux = l; aux != NULL; aux = aux->list_instr.next)
+    {
+        n++;
+        /* Le code qui suit un RETOURNER n'est pas généré */
+        if (aux->list_instr.instr->type == return_type) break;
+    }
+
+    ast **nodes = (ast **) malloc(sizeof(ast *) * (n + 1));
+    check_alloc(nodes);
+
+    for (i = 0, aux = l; i < n; i++, aux = aux->list_instr.next) nodes[i] = aux;
+
+    for (i = n - 1; i >= 0; i--)
+    {
+        live = live_instr(nodes[i]->list_instr.instr, live, remove, &is_dead);
+        if (is_dead && remove) remove_instr(i > 0 ? nodes[i - 1] : NULL, nodes[i]);
+    }
+
+    free(nodes);
+    return live;
+}
+
+
+/**
+ * @brief Supprime les initialisations mortes des déclarations de variables
+ * (`VAR x <- 0` quand x est toujours affectée avant d'être lue).
+ * Les déclarations sont parcourues à l'envers.
+ *
+ * @param t
+ * @param live Les variables vivantes après les déclarations (libérée par la
+ * fonction)
+ * @return name_list* Les variables vivantes avant les déclarations
+ */
+static name_list *dce_decla(ast *t, name_list *live)
+{
+    if (t == NULL) return live;
+
+    switch (t->type)
+    {
+    case decla_type:
+        live = dce_decla(t->decla_list.next, live);
+        return dce_decla(t->decla_list.decla, live);
+    case var_decla_type:
+        live = dce_decla(t->var_decla.next, live);
+        if (t->var_decla.type == array)
+        {
+            return live_uses(live, t->var_decla.var->arr_decla.list_expr);
+        }
+        if (t->var_decla.type != integer || t->var_decla.expr == NULL)
+        {
+            return live;
+        }
+
+        char *id = t->var_decla.var->id.name;
+        if (!has_name(live, id) && is_removable(id, t->var_decla.expr))
+        {
+            free_ast(t->var_decla.expr);
+            t->var_decla.expr = NULL;
+            return live;
+        }
+
+        live = remove_name(live, id);
+        return live_uses(live, t->var_decla.expr);
+    default:
+        return live;
+    }
+}
+
+
+/**
+ * @brief Estimation du nombre d'instructions RAM générées pour une fonction
+ * (corps et initialisation des variables locales).
+ *
+ * @param f
+ * @return int
+ */
+static int func_cost(optim_func *f)
+{
+    ast *d, *v;
+    int cost = code_cost(f->node->func_decla.list_instr);
+
+    for (d = f->node->func_decla.list_decl; d != NULL; d = d->decla_list.next)
+    {
+        for (v = d->decla_list.decla; v != NULL; v = v->var_decla.next)
+        {
+            if (v->var_decla.type != integer || v->var_decla.expr == NULL)
+            {
+                continue;
+            }
+            optim_var *var = lookup(v->var_decla.var->id.name);
+            cost += expr_cost(v->var_decla.expr);
+            cost += var != NULL && var->mem_zone == 's' ? 6 : 1;
+        }
+    }
+
+    return cost;
+}
+
+
+/**
+ * @brief Élimination du code mort.
+ *
+ * Les sous-expressions constantes sont d'abord calculées, ce qui permet de
+ * supprimer le code inaccessible (branches de SI jamais exécutées, boucles
+ * sans itération, code qui suit un SI dont toutes les branches renvoient une
+ * valeur).
+ * Une analyse de vivacité supprime ensuite les affectations (et INC) de
+ * variables locales ou temporaires qui ne sont plus lues, ainsi que les
+ * initialisations inutiles des déclarations.
+ *
+ * En mode debug, affiche le nombre d'instructions RAM supprimées dans chaque
+ * fonction.
+ *
+ * @param t La racine de l'ASA
+ */
+void optim_dce(ast *t)
+{
+    optim_func *f;
+    int before, removed;
+
+    fold_code(&t->root.list_decl);
+
+    for (f = funcs; f != NULL; f = f->next)
+    {
+        cur_func = f;
+        func_decla_node *node = &f->node->func_decla;
+        before = func_cost(f);
+
+        fold_code(&node->list_decl);
+        fold_code(&node->list_instr);
+        prune_list(node->list_instr);
+        free_names(dce_decla(node->list_decl,
+                             live_list(node->list_instr, NULL, 1)));
+
+        removed = before - func_cost(f);
+        if (is_dbg_mode)
+        {
+            fprintf(stderr, "Code mort (%s): %d instructions supprimées "\
+                    "(%d octets)\n",
+                    node->id->id.name, removed, removed * RAM_INSTR_SIZE);
+        }
+    }
+    cur_func = NULL;
+}
+
+
+
+/******************** Élimination des vérifications de bornes ********************/
+
+
+/*
+ * Intervalle des valeurs d'une variable de POUR dans le corps de la boucle.
+ * end: la variable n de `POUR i DANS a...n` si elle n'est pas modifiée dans la
+ * boucle (i < n), "" sinon.
+ */
+typedef struct _range {
+    char id[ID_MAX_SIZE];
+    long long lo;
+    long long hi;
+    char end[ID_MAX_SIZE];
+    struct _range *next;
+} range;
+
+
+/* Bloc pointé par ptr de taille >= la valeur de la variable size */
+typedef struct _size_fact {
+    char ptr[ID_MAX_SIZE];
+    char size[ID_MAX_SIZE];
+    struct _size_fact *next;
+} size_fact;
+
+
+/*
+ * Les bornes au-delà de RANGE_MAX ne sont pas gardées (pas de dépassement):
+ * elles sont remplacées par RANGE_INF (pas de borne).
+ */
+#define RANGE_MAX 1000000
+#define RANGE_INF (1LL << 40)
+
+
+/**
+ * @brief Remplace les bornes trop grandes de l'intervalle [lo, hi] par des
+ * bornes moins précises (mais toujours vraies).
+ *
+ * @param lo
+ * @param hi
+ */
+static void range_clamp(long long *lo, long long *hi)
+{
+    if (*lo < -RANGE_MAX) *lo = -RANGE_INF;
+    else if (*lo > RANGE_MAX) *lo = RANGE_MAX;
+
+    if (*hi > RANGE_MAX) *hi = RANGE_INF;
+    else if (*hi < -RANGE_MAX) *hi = -RANGE_MAX;
+}
+
+
+/**
+ * @brief Calcule l'intervalle [lo, hi] des valeurs de l'expression `t`.
+ * Seules les constantes et les variables des POUR englobants (dont les
+ * intervalles sont dans `env`) sont connues, les bornes des autres
+ * expressions valent -RANGE_INF et RANGE_INF.
+ *
+ * @param t
+ * @param env
+ * @param lo
+ * @param hi
+ */
+static void expr_range(ast *t, range *env, long long *lo, long long *hi)
+{
+    long long l1, h1, l2, h2, p[4];
+    range *r;
+    int i;
+
+    *lo = -RANGE_INF;
+    *hi = RANGE_INF;
+
+    switch (t->type)
+    {
+    case nb_type:
+        *lo = *hi = t->nb.val;
+        break;
+    case id_type:
+        for (r = env; r != NULL; r = r->next)
+        {
+            if (strcmp(r->id, t->id.name) == 0) break;
+        }
+        if (r == NULL) return;
+        *lo = r->lo;
+        *hi = r->hi;
+        break;
+    case u_op_type:
+        if (t->u_op.ope != '-') return;
+        expr_range(t->u_op.child, env, &l1, &h1);
+        *lo = -h1;
+        *hi = -l1;
+        break;
+    case b_op_type:
+        expr_range(t->b_op.l_memb, env, &l1, &h1);
+        expr_range(t->b_op.r_memb, env, &l2, &h2);
+
+        switch (t->b_op.ope)
+        {
+        case '+':
+            *lo = l1 + l2;
+            *hi = h1 + h2;
+            break;
+        case '-':
+            *lo = l1 - h2;
+            *hi = h1 - l2;
+            break;
+        case '*':
+            if (l1 == -RANGE_INF || l2 == -RANGE_INF || h1 == RANGE_INF
+                || h2 == RANGE_INF) return;
+
+            p[0] = l1 * l2;
+            p[1] = l1 * h2;
+            p[2] = h1 * l2;
+            p[3] = h1 * h2;
+            *lo = *hi = p[0];
+            for (i = 1; i < 4; i++)
+            {
+                if (p[i] < *lo) *lo = p[i];
+                if (p[i] > *hi) *hi = p[i];
+            }
+            break;
+        case '/':
+        case '%':
+            /* Seulement x / K et x % K, avec x >= 0 et K > 0 constant */
+            if (l2 != h2 || l2 <= 0 || l1 < 0) return;
+            *lo = t->b_op.ope == '/' ? l1 / l2 : 0;
+            *hi = t->b_op.ope == '/' ? h1 / l2 : (h1 < l2 ? h1 : l2 - 1);
+            break;
+        default:
+            return;
+        }
+        break;
+    default:
+        return;
+    }
+
+    range_clamp(lo, hi);
+}
+
+
+/**
+ * @brief Renvoie une copie des faits `l` dont les variables ne sont pas
+ * modifiées par le code ayant les effets `eff` (tous si eff vaut NULL).
+ *
+ * @param l
+ * @param eff
+ * @return size_fact*
+ */
+static size_fact *copy_facts(size_fact *l, effects *eff)
+{
+    size_fact *res = NULL, *f;
+
+    for (; l != NULL; l = l->next)
+    {
+        if (eff != NULL && (!var_is_invariant(l->ptr, eff)
+                            || !var_is_invariant(l->size, eff))) continue;
+
+        f = (size_fact *) malloc(sizeof(size_fact));
+        check_alloc(f);
+        *f = *l;
+        f->next = res;
+        res = f;
+    }
+
+    return res;
+}
+
+
+static void free_facts(size_fact *l)
+{
+    size_fact *aux;
+    while (l != NULL)
+    {
+        aux = l->next;
+        free(l);
+        l = aux;
+    }
+}
+
+
+/**
+ * @brief Renvoie 1 si l'indice `ind` de l'accès à `ptr` est toujours
+ * inférieur à la taille du bloc pointé: c'est la variable i d'un
+ * `POUR i DANS a...n` et le bloc a été alloué par ALLOUER(ptr, n).
+ *
+ * @param ind
+ * @param ptr
+ * @param env
+ * @param facts
+ * @return int
+ */
+static int below_size(ast *ind, const char *ptr, range *env, size_fact *facts)
+{
+    if (ind->type != id_type) return 0;
+
+    for (; env != NULL; env = env->next)
+    {
+        if (strcmp(env->id, ind->id.name) == 0) break;
+    }
+    if (env == NULL || env->end[0] == '\0') return 0;
+
+    for (; facts != NULL; facts = facts->next)
+    {
+        if (strcmp(facts->ptr, ptr) == 0 && strcmp(facts->size, env->end) == 0)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+static void bce_visit(ast *t, range *env, size_fact *facts);
+
+
+/**
+ * @brief Marque les accès de la liste d'instructions `t`. Après
+ * `ALLOUER(p, n)`, le bloc pointé par p est de taille >= n tant que p et n
+ * ne sont pas modifiés.
+ *
+ * @param t
+ * @param env
+ * @param facts Les faits vrais au début de la liste
+ */
+static void bce_list(ast *t, range *env, size_fact *facts)
+{
+    size_fact *l = copy_facts(facts, NULL), *aux;
+
+    for (; t != NULL; t = t->list_instr.next)
+    {
+        ast *instr = t->list_instr.instr;
+
+        /* Faits toujours vrais pendant l'instruction */
+        effects eff = {0};
+        collect_effects(instr, &eff);
+        aux = copy_facts(l, &eff);
+        free_facts(l);
+        l = aux;
+        free_names(eff.modified);
+
+        bce_visit(instr, env, l);
+
+        if (instr->type == alloc_type && instr->alloc.expr->type == id_type
+            && strcmp(instr->alloc.id->id.name,
+                      instr->alloc.expr->id.name) != 0)
+        {
+            aux = (size_fact *) malloc(sizeof(size_fact));
+            check_alloc(aux);
+            strcpy(aux->ptr, instr->alloc.id->id.name);
+            strcpy(aux->size, instr->alloc.expr->id.name);
+            aux->next = l;
+            l = aux;
+        }
+    }
+
+    free_facts(l);
+}
+
+
+/**
+ * @brief Marque les accès aux tableaux de `t` (instruction ou expression)
+ * dont l'indice est toujours dans les bornes.
+ *
+ * @param t
+ * @param env Les intervalles des variables des POUR englobants
+ * @param facts Les tailles des blocs alloués (voir bce_list)
+ */
+static void bce_visit(ast *t, range *env, size_fact *facts)
+{
+    long long lo, hi;
+    optim_var *v;
+    range r;
+
+    if (t == NULL) return;
+
+    switch (t->type)
+    {
+    case array_access_type:
+        v = lookup(t->arr_access.id->id.name);
+        expr_range(t->arr_access.ind_expr, env, &lo, &hi);
+        if (v != NULL && lo >= 0) t->arr_access.in_bounds |= BOUNDS_LOW;
+        if (v != NULL && ((v->type == array && hi < v->size)
+                          || below_size(t->arr_access.ind_expr, v->id, env,
+                                        facts)))
+        {
+            t->arr_access.in_bounds |= BOUNDS_HIGH;
+        }
+        bce_visit(t->arr_access.ind_expr, env, facts);
+        bce_visit(t->arr_access.affect_expr, env, facts);
+        break;
+    case for_type:
+        bce_visit(t->for_n.affect_init, env, facts);
+        bce_visit(t->for_n.end_exp, env, facts);
+
+        /*
+         * POUR i DANS a...b: si i n'est modifié que par le POUR, il est
+         * compris entre min(a) et max(b) - 1 dans le corps de la boucle.
+         */
+        effects eff = {0};
+        collect_effects(t->for_n.list_instr, &eff);
+        ast *end = t->for_n.end_exp->b_op.r_memb;
+        strcpy(r.id, t->for_n.id->id.name);
+        r.end[0] = '\0';
+        r.next = env;
+
+        if (lookup(r.id) != NULL && var_is_invariant(r.id, &eff))
+        {
+            expr_range(t->for_n.affect_init->affect.expr, env, &r.lo, &hi);
+            expr_range(end, env, &lo, &r.hi);
+            r.hi--;
+            range_clamp(&r.lo, &r.hi);
+
+            if (end->type == id_type && var_is_invariant(end->id.name, &eff))
+            {
+                strcpy(r.end, end->id.name);
+            }
+            env = &r;
+        }
+        free_names(eff.modified);
+
+        bce_list(t->for_n.list_instr, env, facts);
+        break;
+    case b_op_type:
+        bce_visit(t->b_op.l_memb, env, facts);
+        bce_visit(t->b_op.r_memb, env, facts);
+        break;
+    case u_op_type:
+        bce_visit(t->u_op.child, env, facts);
+        break;
+    case affect_type:
+        bce_visit(t->affect.expr, env, facts);
+        break;
+    case while_type:
+        bce_visit(t->while_n.expr, env, facts);
+        bce_list(t->while_n.list_instr, env, facts);
+        break;
+    case do_while_type:
+        bce_list(t->do_while.list_instr, env, facts);
+        bce_visit(t->do_while.expr, env, facts);
+        break;
+    case if_type:
+        bce_visit(t->if_n.expr, env, facts);
+        bce_list(t->if_n.list_instr1, env, facts);
+        bce_list(t->if_n.list_instr2, env, facts);
+        break;
+    case switch_type:
+        bce_visit(t->switch_n.expr, env, facts);
+        bce_visit(t->switch_n.cases, env, facts);
+        bce_list(t->switch_n.default_instr, env, facts);
+        break;
+    case case_type:
+        bce_list(t->case_n.list_instr, env, facts);
+        bce_visit(t->case_n.next, env, facts);
+        break;
+    case io_type:
+        bce_visit(t->io.expr, env, facts);
+        break;
+    case func_call_type:
+        bce_visit(t->func_call.params, env, facts);
+        break;
+    case exp_list_type:
+        bce_visit(t->exp_list.exp, env, facts);
+        bce_visit(t->exp_list.next, env, facts);
+        break;
+    case return_type:
+        bce_visit(t->return_n.expr, env, facts);
+        break;
+    case alloc_type:
+        bce_visit(t->alloc.expr, env, facts);
+        break;
+    case block_type:
+        bce_visit(t->block.src, env, facts);
+        bce_visit(t->block.size, env, facts);
+        break;
+    default:
+        break;
+    }
+}
+
+
+/**
+ * @brief Élimination des vérifications de bornes inutiles (--bounds-check).
+ *
+ * Analyse d'intervalles sur les variables des boucles `POUR i DANS a...b`:
+ * les bornes d'un accès T[e] sont marquées comme prouvées si l'intervalle de
+ * e (calculé à partir des constantes et des variables des POUR englobants)
+ * montre que 0 <= e, et e < taille de T. Seule la borne inférieure peut être
+ * prouvée pour les pointeurs, sauf pour p[i] dans `POUR i DANS a...n` après
+ * ALLOUER(p, n) (voir bce_list). Par exemple, aucune vérification n'est
+ * générée pour:
+ *
+ * VAR T[10]
+ * POUR i DANS 0...10 FAIRE T[i] <- T[9 - i] FPOUR
+ *
+ * Les passes suivantes conservent les marques (les copies de l'ASA aussi), et
+ * la réduction de force ne transforme que les accès marqués.
+ *
+ * @param t La racine de l'ASA
+ */
+void optim_bounds(ast *t)
+{
+    optim_func *f;
+
+    if (!bounds_check) return;
+
+    for (f = funcs; f != NULL; f = f->next)
+    {
+        cur_func = f;
+        bce_list(f->node->func_decla.list_instr, NULL, NULL);
+    }
+    cur_func = NULL;
+}
+
+
+
+/****************************** Pipeline ******************************/
+
+
+/* Passe d'optimisation: nom (dans --passes), option et fonction */
+typedef struct {
+    const char *name;
+    int flag;
+    void (*run)(ast *t);
+} optim_pass;
+
+
+/* Les passes, dans l'ordre où elles sont appliquées par défaut */
+static const optim_pass passes[] = {
+    {"bounds", OPTIM_BOUNDS, optim_bounds},
+    {"licm", OPTIM_LICM, optim_licm},
+    {"strength-reduction", OPTIM_SR, optim_strength_reduction},
+    {"unroll", OPTIM_UNROLL, optim_unroll_loops},
+    {"cse", OPTIM_CSE, optim_cse},
+    {"dce", OPTIM_DCE, optim_dce}
+};
+
+#define NB_PASSES (int) (sizeof(passes) / sizeof(optim_pass))
+
+
+/* Pipeline donné par --passes (indices dans `passes`), -1 si absent */
+static int pipeline[OPTIM_PIPELINE_MAX];
+static int pipeline_len = -1;
+
+/*
+ * Passes activées par le dernier -O, ajoutées à optim_flags par optimize()
+ * quel que soit l'ordre des options, et facteur de déroulage par défaut.
+ */
+static int level_flags = 0;
+static int level_unroll = 0;
+
+
+/**
+ * @brief Choisit les passes correspondant au niveau d'optimisation:
+ * - 0: aucune
+ * - 1: bounds, licm, cse, dce
+ * - 2: toutes (déroulage 4 fois si --unroll n'est pas donné)
+ * - s: bounds, cse et dce, qui ne font pas grossir le code
+ * Elles s'ajoutent à celles des autres options. Si plusieurs niveaux sont
+ * donnés, le dernier est utilisé.
+ *
+ * @param level Le niveau ("0", "1", "2" ou "s")
+ * @return int 0 si le niveau n'existe pas, 1 sinon
+ */
+int optim_set_level(const char *level)
+{
+    level_unroll = 0;
+    if (strcmp(level, "0") == 0) level_flags = 0;
+    else if (strcmp(level, "1") == 0)
+    {
+        level_flags = OPTIM_BOUNDS | OPTIM_LICM | OPTIM_CSE | OPTIM_DCE;
+    }
+    else if (strcmp(level, "2") == 0)
+    {
+        level_flags = OPTIM_BOUNDS | OPTIM_LICM | OPTIM_SR | OPTIM_UNROLL
+                      | OPTIM_CSE | OPTIM_DCE;
+        level_unroll = 4;
+    }
+    else if (strcmp(level, "s") == 0)
+    {
+        level_flags = OPTIM_BOUNDS | OPTIM_CSE | OPTIM_DCE;
+    }
+    else return 0;
+
+    return 1;
+}
+
+
+/**
+ * @brief Remplace le pipeline par la liste de passes `list` (noms séparés par
+ * des virgules, exécutées dans l'ordre donné, éventuellement plusieurs fois).
+ *
+ * @param list
+ * @return int 0 si une passe n'existe pas ou si la liste est trop longue
+ */
+int optim_set_passes(const char *list)
+{
+    const char *name = list;
+    size_t len;
+    int i;
+
+    pipeline_len = 0;
+    while (*name != '\0')
+    {
+        len = strcspn(name, ",");
+        for (i = 0; i < NB_PASSES; i++)
+        {
+            if (strlen(passes[i].name) == len
+                && strncmp(passes[i].name, name, len) == 0) break;
+        }
+
+        if (i == NB_PASSES || pipeline_len == OPTIM_PIPELINE_MAX) return 0;
+        pipeline[pipeline_len++] = i;
+
+        name += len;
+        if (*name == ',') name++;
+    }
+
+    return 1;
+}
+
+
+/**
+ * @brief Applique les optimisations demandées à l'ASA: le pipeline donné
+ * par --passes (quelle que soit sa position parmi les options), ou sinon les
+ * passes activées par les options et par -O.
+ *
+ * @param t La racine de l'ASA
+ */
+void optimize(ast *t)
+{
+    int list[OPTIM_PIPELINE_MAX];
+    int i, n = 0;
+    double start;
+
+    if (t == NULL) return;
+
+    /* --unroll=N l'emporte sur le facteur de -O2 */
+    if (optim_unroll == 0) optim_unroll = level_unroll;
+
+    if (pipeline_len >= 0)
+    {
+        for (n = 0; n < pipeline_len; n++) list[n] = pipeline[n];
+    }
+    else
+    {
+        for (i = 0; i < NB_PASSES; i++)
+        {
+            if ((optim_flags | level_flags) & passes[i].flag) list[n++] = i;
+        }
+    }
+
+    if (n == 0) return;
+
+    collect_program(t);
+
+    for (i = 0; i < n; i++)
+    {
+        start = get_time_ms();
+        passes[list[i]].run(t);
+        report_pass_time(passes[list[i]].name, start);
+    }
+
+    free_program_info();
+}
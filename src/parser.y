@@ -12,26 +12,38 @@
 #include "semantic.h"
 #include "preprocessor.h"
 #include "arc_options.h"
+#include "optim.h"
+#include "arc_stats.h"
+#include "arc_context.h"
+#include "arc_jobs.h"
+#include "arc_server.h"
+#include "arc_cache.h"
 
 
 extern int yylex();
-extern int yylex_destroy();
 void yyerror(const char *s);
 
-ast *abstract_tree = NULL;
-symb_table table = NULL;
 
-
-char *src = NULL;
-char *exename = NULL;
+char *output = NULL;
 char *include_path = NULL;
+char *cache_dir = NULL;
+char **input_files = NULL;
+int nb_input_files = 0;
+int nb_jobs = 1;
 
 int is_dbg_mode = 0;
 int print_tree = 0;
 int print_table = 0;
 
-int line_offset = 0;
 int mem_size = 0;
+int heap_size = -1;
+int recursion_depth = 0;
+int bounds_check = 0;
+int guard_mode = 0;
+int optim_flags = 0;
+int optim_unroll = 0;
+int time_passes = 0;
+int stats_format = STATS_NONE;
 
 char PROJECT_PATH[PATH_MAX];
 FILE *fp_out;
@@ -59,6 +71,8 @@ FILE *fp_out;
 %token DIFF "!="
 %token LIRE
 %token ECRIRE
+%token LIRE_TABLEAU
+%token ECRIRE_TABLEAU
 %token TQ
 %token FAIRE
 %token FTQ
@@ -66,12 +80,19 @@ FILE *fp_out;
 %token ALORS
 %token SINON
 %token FSI
+%token SELON
+%token CAS
+%token FSELON
 %token POUR
 %token DANS
 %token FPOUR
 %token RANGE_SYMB "..."
 %token RETOURNER
 %token ALLOUER
+%token ALLOUER_LOCAL
+%token LIBERER
+%token COPIER
+%token REMPLIR
 %token VRAI FAUX
 %token '\n'
 
@@ -100,6 +121,9 @@ FILE *fp_out;
 %type <tree> DECLARATION
 %type <tree> LIST_DECLA_VAR
 %type <tree> STRUCT_SI
+%type <tree> STRUCT_SELON
+%type <tree> LIST_CAS
+%type <nb> VAL_CAS
 %type <tree> STRUCT_TQ
 %type <tree> STRUCT_FAIRE_TQ
 %type <tree> STRUCT_POUR
@@ -110,10 +134,13 @@ FILE *fp_out;
 %type <tree> APPEL_FUNC
 %type <tree> LIRE_INSTR
 %type <tree> ECRIRE_INSTR
+%type <tree> IO_TAB_INSTR
 %type <tree> AFFECT_TAB
 %type <tree> ACCES_TAB
 %type <tree> DECLA_TAB
 %type <tree> ALLOC_INSTR
+%type <tree> FREE_INSTR
+%type <tree> BLOCK_INSTR
 %type <tree> PROTO_FONCTION
 
 %%
@@ -136,6 +163,9 @@ SEP_STRUCT: SEP
 DECLA_TAB: ID '[' NB ']'        {$$ = create_arr_decla_node($1, $3, NULL);}
 | ID '[' NB ']' "<-" '[' LIST_EXPR ']' 
                                 {$$ = create_arr_decla_node($1, $3, $7);}
+| ID '[' NB ']' '[' NB ']'      {$$ = create_md_arr_decla_node($1, $3, $6, NULL);}
+| ID '[' NB ']' '[' NB ']' "<-" '[' LIST_EXPR ']'
+                                {$$ = create_md_arr_decla_node($1, $3, $6, $10);}
 ;
 
 
@@ -167,7 +197,7 @@ AFFECTATION: ID "<-" EXP   {$$ = create_affect_node($1, $3, 0);}
 
 
 PROGRAMME_ALGO: SEP_STRUCT LIST_DECLA PROG_MAIN END_FILE
-                   {$$ = create_prog_root($2, $3); abstract_tree = $$;}
+                   {$$ = create_prog_root($2, $3); arc_ctx.tree = $$;}
 ;
 
 
@@ -218,10 +248,13 @@ APPEL_FUNC: ID '(' LIST_EXPR ')'    {$$ = create_function_call_node($1, $3);}
 
 
 ACCES_TAB: ID '[' EXP ']'           {$$ = create_arr_access_node($1, $3, NULL);}
+| ID '[' EXP ']' '[' EXP ']'        {$$ = create_md_arr_access_node($1, $3, $6, NULL);}
 ;
 
 
 AFFECT_TAB: ID '[' EXP ']' "<-" EXP {$$ = create_arr_access_node($1, $3, $6);}
+| ID '[' EXP ']' '[' EXP ']' "<-" EXP
+                                    {$$ = create_md_arr_access_node($1, $3, $6, $9);}
 ;
 
 
@@ -259,11 +292,15 @@ INSTR: EXP SEP          {$$ = $1;}
 | ECRIRE_INSTR SEP      {$$ = $1;}
 | STRUCT_TQ SEP         {$$ = $1;}
 | STRUCT_SI SEP         {$$ = $1;}
+| STRUCT_SELON SEP      {$$ = $1;}
 | STRUCT_FAIRE_TQ SEP   {$$ = $1;}
 | STRUCT_POUR SEP       {$$ = $1;}
 | RETOURNER EXP SEP     {$$ = create_return_node($2);}
 | RETOURNER SEP         {$$ = create_return_node(NULL);}
 | ALLOC_INSTR SEP       {$$ = $1;}
+| FREE_INSTR SEP        {$$ = $1;}
+| BLOCK_INSTR SEP       {$$ = $1;}
+| IO_TAB_INSTR SEP      {$$ = $1;}
 ;
 
 LISTE_INSTR: INSTR      {$$ = create_instr_node($1, NULL);}
@@ -273,6 +310,16 @@ LISTE_INSTR: INSTR      {$$ = create_instr_node($1, NULL);}
 
 // Autres structures
 ALLOC_INSTR: ALLOUER '(' ID ',' EXP ')' {$$ = create_alloc_node($3, $5);}
+| ALLOUER_LOCAL '(' ID ',' EXP ')'      {$$ = create_local_alloc_node($3, $5);}
+;
+
+/* Utiliser LIBERER active l'allocateur de ramOS (voir ram_os.h) */
+FREE_INSTR: LIBERER '(' ID ')'  {$$ = create_free_node($3); arc_ctx.uses_free = 1;}
+;
+
+/* Copie et remplissage de blocs mémoire (voir codegen_block) */
+BLOCK_INSTR: COPIER '(' ID ',' ID ',' EXP ')'  {$$ = create_block_node('c', $3, create_id_leaf($5), $7);}
+| REMPLIR '(' ID ',' EXP ',' EXP ')'           {$$ = create_block_node('f', $3, $5, $7);}
 ;
 
 
@@ -283,6 +330,11 @@ LIRE_INSTR: LIRE '(' ')'            {$$ = create_io_node(NULL, 'r');}
 ECRIRE_INSTR: ECRIRE '(' EXP ')'    {$$ = create_io_node($3, 'w');}
 ;
 
+/* Lecture et écriture des n premières cases d'un tableau (voir codegen_io) */
+IO_TAB_INSTR: LIRE_TABLEAU '(' ID ',' EXP ')'   {$$ = create_io_tab_node($3, $5, 'R');}
+| ECRIRE_TABLEAU '(' ID ',' EXP ')'             {$$ = create_io_tab_node($3, $5, 'W');}
+;
+
 STRUCT_TQ: TQ EXP FAIRE SEP_STRUCT LISTE_INSTR FTQ {$$ = create_while_node($2, $5);}
 ;
 
@@ -307,98 +359,215 @@ STRUCT_SI:
   FSI  {$$ = create_if_node($2, $5, NULL);}
 ;
 
+
+STRUCT_SELON: SELON EXP SEP LIST_CAS FSELON
+                                {$$ = create_switch_node($2, $4, NULL);}
+| SELON EXP SEP LIST_CAS SINON SEP_STRUCT LISTE_INSTR FSELON
+                                {$$ = create_switch_node($2, $4, $7);}
+;
+
+LIST_CAS: CAS VAL_CAS ':' SEP_STRUCT LISTE_INSTR
+                                {$$ = create_case_node($2, $5, NULL);}
+| LIST_CAS CAS VAL_CAS ':' SEP_STRUCT LISTE_INSTR
+                                {$$ = create_case_node($3, $6, $1);}
+;
+
+VAL_CAS: NB                     {$$ = $1;}
+| '-' NB                        {$$ = -$2;}
+;
+
 %%
 
 
-int main(int argc, char **argv)
+/**
+ * @brief Compile le fichier du contexte courant (voir init_context).
+ * 
+ */
+static void compile()
 {
     extern FILE *yyin;
-
-    /*
-     * Bricolage mais fonctionne:
-     * Permet d'obtenir le chemin vers le projet.
-     * Utilisé pour le chemin vers la librairie standard dans preprocessor.c
-     *
-     * __FILE__ contient le chemin du fichier passé en paramètre à gcc.
-     * C'est pour cette raison que l'on donne le chemin complet de parser.y
-     * dans le makefile.
-     * 
-     * La 2ème ligne permet de supprimer le bout de chemin en trop.
-     * 
-     * Ainsi, peu importe d'où l'exécutable est lancé, le chemin vers la
-     * librairie standard sera correct.
-     */
-    strcpy(PROJECT_PATH, __FILE__);
-    PROJECT_PATH[strlen(PROJECT_PATH) - strlen("/src/parser.y")] = '\0';
-    
-    /* Traitement des options de la ligne de commande */
-    handle_options(argc, argv);
+    double start_time = get_time_ms();
 
     /* Phase préprocesseur */
-    yyin = preprocessor(src, &line_offset);
-
-    /* Initialisation de la table des symboles */
-    table = init_symb_table("global");
-    abstract_tree = NULL;
+    phase_start(PHASE_PREPROCESSOR);
+    yyin = preprocessor(arc_ctx.src, &arc_ctx.line_offset);
+    phase_end(PHASE_PREPROCESSOR);
 
     /* Analyse lexicale / syntaxique */
+    phase_start(PHASE_PARSER);
     yyparse();
+    phase_end(PHASE_PARSER);
 
-    /* Supprime le fichier intermédiaire utilisé */
-    system("rm ./__arc_PP.algo_pp");
+    /* Utilisations des variables dans le source, pour les warnings */
+    collect_uses(arc_ctx.tree);
+
+    /* Optimisations sur l'ASA (avant le calcul des tailles de code) */
+    phase_start(PHASE_OPTIMIZE);
+    optimize(arc_ctx.tree);
+    phase_end(PHASE_OPTIMIZE);
 
     /* Analyse sémantique */
-    semantic(abstract_tree);
-    second_turn_semantic(abstract_tree, NULL);
+    phase_start(PHASE_SEMANTIC);
+    semantic(arc_ctx.tree);
+    phase_end(PHASE_SEMANTIC);
+
+    phase_start(PHASE_SECOND_SEMANTIC);
+    mark_src_uses();
+    second_turn_semantic(arc_ctx.tree, NULL);
+    phase_end(PHASE_SECOND_SEMANTIC);
+
+    /* Taille de la pile et du tas (--mem-size=auto) */
+    init_mem_layout();
+
+    /* Affichage des warnings des analyses, triés par position */
+    diag_flush(&arc_ctx.diags);
 
     /* Affichage si demandé par l'utilisateur */
-    if (print_tree) ast_to_img(abstract_tree, "ast", "png");
-    if (print_table) symb_to_img(table, "table", "png");
+    if (print_tree) ast_to_img(arc_ctx.tree, "ast", "png");
+    if (print_table) symb_to_img(arc_ctx.table, "table", "png");
 
     /* Ouverture du fichier de sortie */
-    fp_out = fopen(exename, "w");
+    fp_out = fopen(arc_ctx.exename, "w");
     if (fp_out == NULL)
     {
-        fatal_error("impossible d'ouvrir ~U%s~E", exename);
+        unset_error_info();
+        fatal_error("impossible d'ouvrir ~U%s~E", arc_ctx.exename);
         exit(F_INPUT_ERROR);
     }
     
     /* Génération du code */
+    phase_start(PHASE_CODEGEN);
     init_ram_os();
-    codegen(abstract_tree);
+    codegen(arc_ctx.tree);
+    phase_end(PHASE_CODEGEN);
 
     
     fclose(yyin);
-    free_table(table);
     fclose(fp_out);
+    report_pass_time("total", start_time);
 
     if (is_dbg_mode)
     {
-        /* Temporaire, pour vérifier que semantic marche bien */
-        char buff[256];
-        size_t codelen_total = abstract_tree->codelen + 7;  // + 7 pour ramOS
-        sprintf(buff, "echo \"Codelen total: %ld\nNombre de lignes "\
-        "dans le fichier produit: \" && wc -l %s", codelen_total, exename);
-        system(buff);
+        /* Pour vérifier que la taille calculée par semantic est la bonne */
+        size_t codelen_total = arc_ctx.tree->codelen + ram_os_size();
+        printf("Codelen total: %ld\n", codelen_total);
+        printf("Nombre de lignes dans le fichier produit: %d\n",
+               codegen_nb_instr());
+        print_mem_layout();
     }
 
-    /* Libération de la mémoire */
-    free(src);
+    if (stats_format != STATS_NONE)
+    {
+        print_stats(arc_ctx.tree, arc_ctx.table, codegen_nb_instr());
+    }
+}
+
+
+/**
+ * @brief Compile le i-ème fichier donné en entrée, dans un contexte remis à
+ * zéro ensuite (les fichiers inclus restent en mémoire, voir preprocessor.c).
+ * 
+ * @param i 
+ */
+static void compile_file(int i)
+{
+    char *exename = get_output_name(input_files[i]);
+    init_context(input_files[i], exename);
     free(exename);
-    free_ast(abstract_tree);
+
+    compile();
+    reset_context();
+}
+
+
+/**
+ * @brief Compile les fichiers donnés en entrée (en parallèle avec -j).
+ * 
+ * @return int Le code de retour d'arc
+ */
+static int compile_all()
+{
+    int i, ret = 0;
+    if (nb_jobs > 1 && nb_input_files > 1)
+    {
+        ret = run_jobs(nb_input_files, nb_jobs, compile_file);
+    }
+    else
+    {
+        for (i = 0; i < nb_input_files; i++) compile_file(i);
+    }
+
+    return ret;
+}
+
+
+/**
+ * @brief Traite une requête du mode serveur: compile comme arc lancé avec
+ * la ligne de commande (argc, argv).
+ * 
+ * @param argc 
+ * @param argv 
+ * @return int 
+ */
+static int compile_request(int argc, char **argv)
+{
+    handle_options(argc, argv);
+    return compile_all();
+}
+
+
+int main(int argc, char **argv)
+{
+    /*
+     * Bricolage mais fonctionne:
+     * Permet d'obtenir le chemin vers le projet.
+     * Utilisé pour le chemin vers la librairie standard dans preprocessor.c
+     *
+     * __FILE__ contient le chemin du fichier passé en paramètre à gcc.
+     * C'est pour cette raison que l'on donne le chemin complet de parser.y
+     * dans le makefile.
+     * 
+     * La 2ème ligne permet de supprimer le bout de chemin en trop.
+     * 
+     * Ainsi, peu importe d'où l'exécutable est lancé, le chemin vers la
+     * librairie standard sera correct.
+     */
+    strcpy(PROJECT_PATH, __FILE__);
+    PROJECT_PATH[strlen(PROJECT_PATH) - strlen("/src/parser.y")] = '\0';
+
+    /*
+     * Modes serveur et client (voir arc_server.h): --server et --client sont
+     * forcément la 1ère option, le client transmettant le reste de la ligne
+     * de commande tel quel.
+     */
+    if (argc == 3 && strcmp(argv[1], "--server") == 0)
+    {
+        return run_server(argv[2], compile_request);
+    }
+    if (argc >= 3 && strcmp(argv[1], "--client") == 0)
+    {
+        return run_client(argv[2], argc - 3, argv + 3);
+    }
     
-    if (include_path != NULL) free(include_path);
+    /* Traitement des options de la ligne de commande */
+    handle_options(argc, argv);
 
-    /* Libère la mémoire non-libérée par bison */
-    yylex_destroy();    
+    /* Compilation de chaque fichier (en parallèle avec -j) */
+    int ret = compile_all();
+
+    /* Libération de la mémoire */
+    free_include_cache();
+    if (output != NULL) free(output);
+    if (include_path != NULL) free(include_path);
+    if (cache_dir != NULL) free(cache_dir);
 
-    return 0;
+    return ret;
 }
 
 
 void yyerror(const char *s)
 {
-    set_error_info(yylloc);
+    set_error_info(diag_src_loc(yylloc));
     fatal_error("%s", s);
     exit(BISON_ERROR);
 }
\ No newline at end of file
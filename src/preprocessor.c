@@ -2,6 +2,7 @@
 #include "arc_utils.h"
 #include <sys/sendfile.h>
 #include <sys/stat.h>
+#include <dirent.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
@@ -12,6 +13,28 @@ extern char *include_path;
 extern char PROJECT_PATH[PATH_MAX];
 
 
+/*
+ * Fichier inclus (via $ INCLURE), gardé en mémoire: lors de la compilation de
+ * plusieurs fichiers, la librairie standard n'est lue qu'une fois.
+ * path: le chemin du fichier (le même nom peut désigner des fichiers
+ * différents selon l'option -I, voir le mode serveur)
+ * content: le contenu du fichier
+ * nb_lines: le nombre de lignes du fichier
+ */
+typedef struct _included_file {
+    char *path;
+    char *content;
+    int nb_lines;
+    struct _included_file *next;
+} included_file;
+
+
+static included_file *include_cache = NULL;
+
+/* 1 si l'existence de la librairie standard a déjà été vérifiée */
+static int is_std_checked = 0;
+
+
 /**
  * @brief Copie le fichier src dans un nouveau fichier de nom `dest_name`.
  * Évite de modifier le fichier source directement.
@@ -53,11 +76,12 @@ static char *search_file(char *fname)
     strcat(std_include, "/libstd/");
 
     /* On vérifie que la librairie standard existe */
-    if (access(std_include, R_OK) != 0)
+    if (!is_std_checked && access(std_include, R_OK) != 0)
     {
         fatal_error("impossible de trouver la librairie standard");
         exit(1);
     }
+    is_std_checked = 1;
 
     char *buff = (char *) malloc(sizeof(char) * PATH_MAX);
     check_alloc(buff);
@@ -82,6 +106,133 @@ static char *search_file(char *fname)
 
 
 
+/**
+ * @brief Renvoie le fichier inclus de chemin `f_path`, lu depuis le disque
+ * s'il n'a pas encore été inclus.
+ * 
+ * @param f_path Le chemin du fichier (libéré par la fonction)
+ * @return included_file* 
+ */
+static included_file *load_path(char *f_path)
+{
+    included_file *f;
+    for (f = include_cache; f != NULL; f = f->next)
+    {
+        if (strcmp(f->path, f_path) == 0)
+        {
+            free(f_path);
+            return f;
+        }
+    }
+
+    FILE *fp = fopen(f_path, "r");
+    check_alloc(fp);
+
+    f = (included_file *) malloc(sizeof(included_file));
+    check_alloc(f);
+    f->path = f_path;
+
+    /* Lecture du fichier (les lignes sont comptées comme à l'insertion) */
+    size_t size = 0, capacity = 4096;
+    f->content = (char *) malloc(sizeof(char) * capacity);
+    check_alloc(f->content);
+    f->nb_lines = 0;
+
+    char buff[4096];
+    while (fgets(buff, 4095, fp) != NULL)
+    {
+        size_t len = strlen(buff);
+        if (size + len + 1 > capacity)
+        {
+            capacity = (size + len + 1) * 2;
+            f->content = (char *) realloc(f->content, sizeof(char) * capacity);
+            check_alloc(f->content);
+        }
+
+        memcpy(f->content + size, buff, len);
+        size += len;
+        f->nb_lines++;
+    }
+    f->content[size] = '\0';
+    fclose(fp);
+
+    f->next = include_cache;
+    include_cache = f;
+
+    return f;
+}
+
+
+
+/**
+ * @brief Renvoie le fichier inclus `fname` (voir search_file).
+ * 
+ * @param fname 
+ * @return included_file* NULL si le fichier n'existe pas
+ */
+static included_file *load_file(char *fname)
+{
+    char *f_path;
+    if ((f_path = search_file(fname)) == NULL) return NULL;
+
+    return load_path(f_path);
+}
+
+
+
+/**
+ * @brief Lit à l'avance tous les fichiers de la librairie standard (utilisé
+ * par le mode serveur, pour que chaque compilation les trouve en mémoire).
+ * 
+ */
+void preload_includes()
+{
+    char std_include[PATH_MAX];
+    strcpy(std_include, PROJECT_PATH);
+    strcat(std_include, "/libstd/");
+
+    DIR *dir = opendir(std_include);
+    if (dir == NULL) return;
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (entry->d_name[0] == '.') continue;
+
+        if (strlen(std_include) + strlen(entry->d_name) >= PATH_MAX) continue;
+
+        /* Même chemin que celui construit par search_file */
+        char *f_path = (char *) malloc(sizeof(char) * PATH_MAX);
+        check_alloc(f_path);
+        strcpy(f_path, std_include);
+        strcat(f_path, entry->d_name);
+        load_path(f_path);
+    }
+
+    closedir(dir);
+}
+
+
+
+/**
+ * @brief Libère les fichiers inclus gardés en mémoire.
+ * 
+ */
+void free_include_cache()
+{
+    included_file *aux;
+    while (include_cache != NULL)
+    {
+        aux = include_cache->next;
+        free(include_cache->path);
+        free(include_cache->content);
+        free(include_cache);
+        include_cache = aux;
+    }
+}
+
+
+
 static void do_preproc_action(FILE *dest, char *line, size_t line_nb, int *nb)
 {
     /* On récupère le nom du fichier.algo */
@@ -103,29 +254,20 @@ static void do_preproc_action(FILE *dest, char *line, size_t line_nb, int *nb)
      * On vérifie que le fichier.algo est dans le chemin de la librairie
      * standard ou dans le chemin spécifié par l'option -I
      */
-    char *f_path;
-    if ((f_path = search_file(buff)) == NULL)
+    included_file *to_insert;
+    if ((to_insert = load_file(buff)) == NULL)
     {
         fatal_error("le fichier ~U%s~E n'a pas été trouvé", buff);
         exit(1);
     }
 
-    FILE *to_insert = fopen(f_path, "r");
-    check_alloc(to_insert);
-    free(f_path);
-
     /* -1 car on supprime la ligne contenant l'instruction préprocesseur */
     (*nb)--;
 
     /* On insère le fichier inclus */
-    while (fgets(buff, 4095, to_insert) != NULL)
-    {
-        fwrite(buff, sizeof(char), strlen(buff), dest);
-        (*nb)++;
-    }
+    fwrite(to_insert->content, sizeof(char), strlen(to_insert->content), dest);
+    (*nb) += to_insert->nb_lines;
     fputc('\n', dest);
-
-    fclose(to_insert);
 }
 
 
@@ -139,8 +281,12 @@ FILE *preprocessor(char *src, int *nb_inserted)
         exit(F_INPUT_ERROR);
     }
 
-    /* Fichier qui sera analysé etc. (écriture + lecture) */
-    FILE *pp_f = fopen("./__arc_PP.algo_pp", "w+");
+    /*
+     * Fichier qui sera analysé etc. (écriture + lecture).
+     * Fichier temporaire sans nom, supprimé à sa fermeture: plusieurs
+     * compilations peuvent avoir lieu en même temps (voir -j).
+     */
+    FILE *pp_f = tmpfile();
     check_alloc(pp_f);
 
     /* Parcours des lignes */
@@ -1,6 +1,8 @@
 #include "semantic.h"
 #include "arc_utils.h"
 #include "ram_os.h"
+#include "codegen.h"
+#include "arc_context.h"
 #include <string.h>
 #include <limits.h>
 
@@ -21,8 +23,116 @@ char current_ctx[32] = "global";
 /* Pour swap les contextes */
 static char old_context[32];
 
-/* Pour savoir si une fonction a un "RETOURNER" */
-static int has_return_instr = 0;
+/* Utilisé par second_turn_semantic */
+static size_t offset_cdln = 0;
+
+/* Sauvegarde de HEAP_REG de la fonction courante (voir ALLOUER_LOCAL) */
+static int heap_mark = 0;
+
+/* Valeurs temporaires empilées par la fonction courante (voir push_depth) */
+static int temps = 0;
+
+/*
+ * Graphe des appels (voir max_stack_size): un arc par appel, de la fonction
+ * appelante ("global" pour l'initialisation des variables globales) vers la
+ * fonction appelée.
+ */
+typedef struct _call_edge {
+    char caller[ID_MAX_SIZE];
+    char callee[ID_MAX_SIZE];
+    struct _call_edge *next;
+} call_edge;
+
+static call_edge *calls = NULL;
+
+/*
+ * Identificateurs utilisés ou initialisés par le programme source, relevés
+ * avant les optimisations (voir collect_uses): le déroulage, la propagation
+ * des constantes ou l'élimination du code mort peuvent en supprimer des
+ * utilisations, et les diagnostics ne doivent pas dépendre du niveau
+ * d'optimisation.
+ * pos_infos est la position de la première utilisation (pour l'erreur si
+ * l'identificateur n'est pas déclaré).
+ * decl vaut 1 si l'identificateur est une variable déclarée dans ce contexte,
+ * 2 si c'est un paramètre (0 sinon): les warnings sont levés à sa déclaration
+ * decl_pos (voir mark_src_uses).
+ */
+typedef struct _src_use {
+    char ctx[ID_MAX_SIZE];
+    char id[ID_MAX_SIZE];
+    int is_used;
+    int is_init;
+    YYLTYPE pos_infos;
+    int decl;
+    YYLTYPE decl_pos;
+    struct _src_use *next;
+} src_use;
+
+static src_use *src_uses = NULL;
+static int collect_params = 0;
+
+/*
+ * Tailles constantes de COPIER, REMPLIR, LIRE_TABLEAU et ECRIRE_TABLEAU dans
+ * le source, comparées à la taille des tableaux par mark_src_uses (src est
+ * vide sauf pour COPIER). Une taille devenue constante après les
+ * optimisations n'est pas vérifiée.
+ */
+typedef struct _size_check {
+    char ctx[ID_MAX_SIZE];
+    char dst[ID_MAX_SIZE];
+    char src[ID_MAX_SIZE];
+    int size;
+    YYLTYPE pos_infos;
+    struct _size_check *next;
+} size_check;
+
+static size_check *size_checks = NULL;
+static char use_ctx[ID_MAX_SIZE] = "global";
+
+/* Vérification des indices des tableaux (--bounds-check) */
+extern int bounds_check;
+
+/* Vérification des débordements de la pile et du tas (--guard) */
+extern int guard_mode;
+
+
+
+/**
+ * @brief Remet à zéro l'état de l'analyse sémantique (adresses, contexte
+ * courant) avant l'analyse d'un autre fichier.
+ * 
+ */
+void reset_semantic()
+{
+    static_rel_adr = 0;
+    stack_rel_adr = 0;
+    strcpy(current_ctx, "global");
+    offset_cdln = 0;
+    heap_mark = 0;
+    temps = 0;
+
+    while (calls != NULL)
+    {
+        call_edge *next = calls->next;
+        free(calls);
+        calls = next;
+    }
+
+    while (src_uses != NULL)
+    {
+        src_use *next = src_uses->next;
+        free(src_uses);
+        src_uses = next;
+    }
+
+    while (size_checks != NULL)
+    {
+        size_check *next = size_checks->next;
+        free(size_checks);
+        size_checks = next;
+    }
+    strcpy(use_ctx, "global");
+}
 
 
 
@@ -66,6 +176,9 @@ void semantic(ast *t)
     case if_type:
         semantic_if(t);
         break;
+    case switch_type:
+        semantic_switch(t);
+        break;
     case for_type:
         semantic_for(t);
         break;
@@ -110,12 +223,306 @@ void semantic(ast *t)
     case proto_type:
         semantic_proto(t);
         break;
+    case inc_type:
+        semantic_inc(t);
+        break;
+    case free_type:
+        semantic_free(t);
+        break;
+    case block_type:
+        semantic_block(t);
+        break;
     default:
         break;
     }
 }
 
 
+/* Ajoute (ou complète) l'utilisation de l'identificateur `id` */
+static src_use *add_src_use(ast *id, int is_used, int is_init)
+{
+    src_use *last = NULL;
+    src_use *u;
+    for (u = src_uses; u != NULL; last = u, u = u->next)
+    {
+        if (strcmp(u->ctx, use_ctx) == 0 && strcmp(u->id, id->id.name) == 0)
+        {
+            u->is_used |= is_used;
+            u->is_init |= is_init;
+            return u;
+        }
+    }
+
+    u = (src_use *) malloc(sizeof(src_use));
+    check_alloc(u);
+    strcpy(u->ctx, use_ctx);
+    strcpy(u->id, id->id.name);
+    u->is_used = is_used;
+    u->is_init = is_init;
+    u->pos_infos = id->pos_infos;
+    u->decl = 0;
+    u->next = NULL;
+
+    /* Dans l'ordre du source, pour signaler la même erreur qu'en -O0 */
+    if (last == NULL) src_uses = u;
+    else last->next = u;
+    return u;
+}
+
+
+/* Ajoute la déclaration de la variable (ou du paramètre) `id` */
+static void add_src_decl(ast *id, int is_init)
+{
+    src_use *u = add_src_use(id, 0, is_init);
+    u->decl = collect_params ? 2 : 1;
+    u->decl_pos = id->pos_infos;
+}
+
+
+/* Ajoute la vérification de la taille constante `size` (voir size_check) */
+static void add_size_check(ast *dst, ast *src, ast *size)
+{
+    if (size->type != nb_type) return;
+
+    size_check *c = (size_check *) malloc(sizeof(size_check));
+    check_alloc(c);
+    strcpy(c->ctx, use_ctx);
+    strcpy(c->dst, dst->id.name);
+    strcpy(c->src, src == NULL ? "" : src->id.name);
+    c->size = size->nb.val;
+    c->pos_infos = size->pos_infos;
+    c->next = size_checks;
+    size_checks = c;
+}
+
+
+/* Renvoie 1 si `k` dépasse la taille du tableau `id` (0 pour un pointeur) */
+static int exceeds_size(const char *ctx, const char *id, int k)
+{
+    if (id[0] == '\0') return 0;
+
+    symbol *tmp = get_symbol(arc_ctx.table, ctx, id);
+    return tmp->type == array && tmp->size > 0 && k > tmp->size;
+}
+
+
+/**
+ * @brief Relève les identificateurs utilisés et initialisés par l'arbre, comme
+ * le fait l'analyse sémantique (semantic_id, semantic_affect...), et vérifie
+ * la taille des constantes. À appeler avant les optimisations (voir
+ * mark_src_uses).
+ * 
+ * @param t 
+ */
+void collect_uses(ast *t)
+{
+    if (t == NULL) return;
+
+    switch (t->type)
+    {
+    case nb_type:
+        /* Vérifie que l'entier soit bien sur 16 bits */
+        if (t->nb.val > SHRT_MAX || t->nb.val < SHRT_MIN)
+        {
+            set_error_info(t->pos_infos);
+            warning("le nombre ~B%d~E dépasse la valeur maximale d'un entier",
+                    t->nb.val);
+        }
+        break;
+    case id_type:
+        add_src_use(t, 1, 0);
+        break;
+    case b_op_type:
+        collect_uses(t->b_op.l_memb);
+        collect_uses(t->b_op.r_memb);
+        break;
+    case u_op_type:
+        /* La variable peut être initialisée via son adresse */
+        if (t->u_op.ope == '@') add_src_use(t->u_op.child, 1, 1);
+        collect_uses(t->u_op.child);
+        break;
+    case affect_type:
+        collect_uses(t->affect.expr);
+        add_src_use(t->affect.id, 1, 1);
+        break;
+    case instr_type:
+        collect_uses(t->list_instr.instr);
+
+        /* Comme semantic_instr: les instructions suivantes sont ignorées */
+        if (t->list_instr.instr->type == return_type)
+        {
+            if (t->list_instr.next == NULL) break;
+            set_error_info(t->list_instr.instr->pos_infos);
+            warning("les instructions situées apprès le ~BRETOURNER~E ne "\
+                    "seront jamais exécutées");
+            break;
+        }
+        collect_uses(t->list_instr.next);
+        break;
+    case decla_type:
+        collect_uses(t->decla_list.decla);
+        collect_uses(t->decla_list.next);
+        break;
+    case var_decla_type:
+        collect_uses(t->var_decla.expr);
+        if (t->var_decla.var->type == array_decla_type)
+        {
+            collect_uses(t->var_decla.var);
+        }
+        else add_src_decl(t->var_decla.var, t->var_decla.expr != NULL);
+        collect_uses(t->var_decla.next);
+        break;
+    case array_decla_type:
+        collect_uses(t->arr_decla.list_expr);
+        add_src_decl(t->arr_decla.id, t->arr_decla.list_expr != NULL);
+        break;
+    case prog_type:
+        collect_uses(t->root.list_decl);
+        collect_uses(t->root.main_prog);
+        break;
+    case func_decla_type:
+        strcpy(use_ctx, t->func_decla.id->id.name);
+        collect_params = 1;
+        collect_uses(t->func_decla.params);
+        collect_params = 0;
+        collect_uses(t->func_decla.list_decl);
+        collect_uses(t->func_decla.list_instr);
+        strcpy(use_ctx, "global");
+        break;
+    case while_type:
+        collect_uses(t->while_n.expr);
+        collect_uses(t->while_n.list_instr);
+        break;
+    case do_while_type:
+        collect_uses(t->do_while.list_instr);
+        collect_uses(t->do_while.expr);
+        break;
+    case if_type:
+        collect_uses(t->if_n.expr);
+        collect_uses(t->if_n.list_instr1);
+        collect_uses(t->if_n.list_instr2);
+        break;
+    case switch_type:
+        collect_uses(t->switch_n.expr);
+        collect_uses(t->switch_n.cases);
+        collect_uses(t->switch_n.default_instr);
+        break;
+    case case_type:
+        collect_uses(t->case_n.list_instr);
+        collect_uses(t->case_n.next);
+        break;
+    case for_type:
+        collect_uses(t->for_n.affect_init);
+        collect_uses(t->for_n.end_exp);
+        collect_uses(t->for_n.list_instr);
+        break;
+    case io_type:
+        collect_uses(t->io.expr);
+        if (t->io.id == NULL) break;
+        add_src_use(t->io.id, 1, t->io.mode == 'R');
+        add_size_check(t->io.id, NULL, t->io.expr);
+        break;
+    case func_call_type:
+        collect_uses(t->func_call.params);
+        break;
+    case exp_list_type:
+        collect_uses(t->exp_list.exp);
+        collect_uses(t->exp_list.next);
+        break;
+    case return_type:
+        collect_uses(t->return_n.expr);
+        break;
+    case array_access_type:
+        add_src_use(t->arr_access.id, 1, t->arr_access.affect_expr != NULL);
+        collect_uses(t->arr_access.ind_expr);
+        collect_uses(t->arr_access.col_expr);
+        collect_uses(t->arr_access.affect_expr);
+        break;
+    case alloc_type:
+        add_src_use(t->alloc.id, 1, 1);
+        collect_uses(t->alloc.expr);
+        break;
+    case inc_type:
+        /* Seulement pour vérifier que la variable est déclarée */
+        add_src_use(t->inc.id, 0, 0);
+        break;
+    case free_type:
+        add_src_use(t->free_n.id, 1, 0);
+        break;
+    case block_type:
+        add_src_use(t->block.dst, 1, 1);
+        collect_uses(t->block.src);
+        collect_uses(t->block.size);
+        add_size_check(t->block.dst,
+                       t->block.op == 'c' ? t->block.src : NULL,
+                       t->block.size);
+        break;
+    default:
+        break;
+    }
+}
+
+
+/**
+ * @brief Reporte dans la table des symboles les utilisations relevées par
+ * collect_uses, après l'analyse sémantique de l'arbre optimisé, et lève les
+ * warnings des variables non utilisées ou non initialisées à leur
+ * déclaration. Les indicateurs des variables ne dépendent que du source: les
+ * utilisations créées ou supprimées par les optimisations sont ignorées, et
+ * les warnings sont les mêmes à tous les niveaux d'optimisation.
+ * 
+ */
+void mark_src_uses()
+{
+    src_use *u;
+    symbol *tmp;
+    for (u = src_uses; u != NULL; u = u->next)
+    {
+        set_error_info(u->pos_infos);
+        tmp = get_symbol(arc_ctx.table, u->ctx, u->id);
+        if (u->decl)
+        {
+            tmp->is_used = 0;
+            tmp->is_init = 0;
+        }
+    }
+
+    for (u = src_uses; u != NULL; u = u->next)
+    {
+        tmp = get_symbol(arc_ctx.table, u->ctx, u->id);
+        tmp->is_used |= u->is_used;
+        tmp->is_init |= u->is_init;
+    }
+
+    for (u = src_uses; u != NULL; u = u->next)
+    {
+        if (!u->decl) continue;
+
+        tmp = get_symbol(arc_ctx.table, u->ctx, u->id);
+        set_error_info(u->decl_pos);
+        if (!tmp->is_used)
+        {
+            warning("l'identificateur ‘~m%s~E‘ n'est pas utilisé", u->id);
+        }
+        else if (!tmp->is_init && u->decl != 2)
+        {
+            warning("l'identificateur ‘~m%s~E‘ n'est pas initialisé", u->id);
+        }
+    }
+
+    size_check *c;
+    for (c = size_checks; c != NULL; c = c->next)
+    {
+        if (exceeds_size(c->ctx, c->dst, c->size) ||
+            exceeds_size(c->ctx, c->src, c->size))
+        {
+            set_error_info(c->pos_infos);
+            warning("la taille ~B%d~E dépasse la taille du tableau", c->size);
+        }
+    }
+}
+
+
 
 /**
  * @brief 2ème parcourt de l'arbre, après l'analyse sémantique.
@@ -128,8 +535,6 @@ void semantic(ast *t)
  */
 void second_turn_semantic(ast *t, ast *parent)
 {
-    static int is_param_decl = 0;
-    static size_t offset_cdln = 0;
     symbol *tmp;
 
     char *id;
@@ -138,19 +543,6 @@ void second_turn_semantic(ast *t, ast *parent)
 
     switch (t->type)
     {
-    case id_type:
-        tmp = get_symbol(table, current_ctx, t->id.name);
-        set_error_info(t->pos_infos);
-        if (!tmp->is_used && !tmp->is_checked)
-        {
-            warning("l'identificateur ‘~m%s~E‘ n'est pas utilisé", t->id.name);
-        }
-        else if (!tmp->is_init && !tmp->is_checked && !is_param_decl)
-        {
-            warning("l'identificateur ‘~m%s~E‘ n'est pas initialisé", t->id.name);
-        }
-        tmp->is_checked = 1;
-        break;
     case b_op_type:
         second_turn_semantic(t->b_op.l_memb, t);
         second_turn_semantic(t->b_op.r_memb, t);
@@ -179,6 +571,15 @@ void second_turn_semantic(ast *t, ast *parent)
         second_turn_semantic(t->if_n.list_instr1, t);
         second_turn_semantic(t->if_n.list_instr2, t);
         break;
+    case switch_type:
+        second_turn_semantic(t->switch_n.expr, t);
+        second_turn_semantic(t->switch_n.cases, t);
+        second_turn_semantic(t->switch_n.default_instr, t);
+        break;
+    case case_type:
+        second_turn_semantic(t->case_n.list_instr, t);
+        second_turn_semantic(t->case_n.next, t);
+        break;
     case for_type:
         second_turn_semantic(t->for_n.affect_init, t);
         second_turn_semantic(t->for_n.end_exp, t);
@@ -207,25 +608,22 @@ void second_turn_semantic(ast *t, ast *parent)
         
         /*
          * Calcul de l'adresse de la fonction.
-         * 7 pour ramOs et 1 pour le JUMP avant la fonction
+         * Le code de ramOs et 1 pour le JUMP avant la fonction
          */
-        size_t adr = offset_cdln + 7 + 1;
+        size_t adr = offset_cdln + ram_os_size() + 1;
         adr -= t->codelen;
         if (parent->decla_list.next != NULL)
         {
             adr -= parent->decla_list.next->codelen;
         }
 
-        if (strcmp(id, "PROGRAMME") == 0) adr = offset_cdln + 7;
+        if (strcmp(id, "PROGRAMME") == 0) adr = offset_cdln + ram_os_size();
 
-        tmp = get_symbol(table, current_ctx, id);
+        tmp = get_symbol(arc_ctx.table, current_ctx, id);
         tmp->adr = adr;
         t->mem_adr = adr;
 
-        is_param_decl = 1;
         second_turn_semantic(t->func_decla.params, t);
-        is_param_decl = 0;
-
         second_turn_semantic(t->func_decla.id, t);
         second_turn_semantic(t->func_decla.list_decl, t);
         second_turn_semantic(t->func_decla.list_instr, t);
@@ -233,7 +631,7 @@ void second_turn_semantic(ast *t, ast *parent)
         break;
     case func_call_type:
         id = t->func_call.func_id->id.name;
-        tmp = get_symbol(table, current_ctx, id);
+        tmp = get_symbol(arc_ctx.table, current_ctx, id);
         set_error_info(t->proto.id->pos_infos);
         if (!tmp->is_init)
         {
@@ -253,6 +651,7 @@ void second_turn_semantic(ast *t, ast *parent)
         break;
     case io_type:
         second_turn_semantic(t->io.expr, t);
+        second_turn_semantic(t->io.id, t);
         break;
     case array_access_type:
         second_turn_semantic(t->arr_access.affect_expr, t);
@@ -263,9 +662,17 @@ void second_turn_semantic(ast *t, ast *parent)
         second_turn_semantic(t->alloc.expr, t);
         second_turn_semantic(t->alloc.id, t);
         break;
+    case free_type:
+        second_turn_semantic(t->free_n.id, t);
+        break;
+    case block_type:
+        second_turn_semantic(t->block.size, t);
+        second_turn_semantic(t->block.src, t);
+        second_turn_semantic(t->block.dst, t);
+        break;
     case proto_type:
         id = t->proto.id->id.name;
-        tmp = get_symbol(table, current_ctx, id);
+        tmp = get_symbol(arc_ctx.table, current_ctx, id);
         set_error_info(t->pos_infos);
         if (!tmp->is_init && !tmp->is_checked)
         {
@@ -282,20 +689,14 @@ void second_turn_semantic(ast *t, ast *parent)
 
 /**
  * @brief Réalise l'analyse sémantique pour les feuilles nombres.
- * Vérifie que l'entier soit bien sur 16 bits et afficher un warning
- * si ça n'est pas le cas.
+ * La taille de l'entier (16 bits) est vérifiée par collect_uses, sur les
+ * constantes du source: celles calculées par les optimisations ne lèvent pas
+ * de warning.
  * 
  * @param t 
  */
 void semantic_nb(ast *t)
 {
-    if (t->nb.val > SHRT_MAX || t->nb.val < SHRT_MIN)
-    {
-        set_error_info(t->pos_infos);
-        warning("le nombre ~B%d~E dépasse la valeur maximale d'un entier",
-                t->nb.val);
-    }
-
     /* 1 LOAD seulement */
     t->codelen = 1;
 }
@@ -306,7 +707,7 @@ void semantic_id(ast *t)
 {    
     /* On vérifie que l'identifiant existe */
     set_error_info(t->pos_infos);
-    symbol *tmp = get_symbol(table, current_ctx, t->id.name);
+    symbol *tmp = get_symbol(arc_ctx.table, current_ctx, t->id.name);
     tmp->is_used = 1;
 
 
@@ -330,12 +731,15 @@ void semantic_b_op(ast *t)
         t->codelen += 5; 
         break;
 
+    case OR_OP:
+        t->codelen += 6;
+        break;
+
     /* Tout ceux qui coûtent 8 instructions */
     case '<':
     case '>':
     case '=':
     case NE_OP:
-    case OR_OP: 
         t->codelen += 8; 
         break;
     
@@ -370,7 +774,10 @@ void semantic_u_op(ast *t)
         break;
     case '@':
         set_error_info(node.child->pos_infos);
-        tmp = get_symbol(table, current_ctx, node.child->id.name);
+        tmp = get_symbol(arc_ctx.table, current_ctx, node.child->id.name);
+
+        /* La variable peut être initialisée via son adresse */
+        tmp->is_init = 1;
 
         if (tmp->mem_zone == 's')
         {
@@ -380,7 +787,7 @@ void semantic_u_op(ast *t)
         break;
     case '*':
         set_error_info(node.child->pos_infos);
-        tmp = get_symbol(table, current_ctx, node.child->id.name);
+        tmp = get_symbol(arc_ctx.table, current_ctx, node.child->id.name);
 
         if (tmp->type != pointer)
         {
@@ -403,17 +810,8 @@ void semantic_instr(ast *t)
     semantic(node.instr);
     t->codelen = node.instr->codelen;
 
-    /* Si c'est un RETOURNER on s'arrête là */
-    if (node.instr->type == return_type)
-    {
-        if (node.next != NULL)
-        {
-            set_error_info(node.instr->pos_infos);
-            warning("les instructions situées apprès le ~BRETOURNER~E ne "\
-                    "seront jamais exécutées");
-        }
-        return;
-    }
+    /* Si c'est un RETOURNER on s'arrête là (warning dans collect_uses) */
+    if (node.instr->type == return_type) return;
 
     /* Sinon on continue normalement */
     semantic(node.next);
@@ -458,6 +856,42 @@ void semantic_if(ast *t)
 }
 
 
+void semantic_switch(ast *t)
+{
+    switch_node node = t->switch_n;
+    ast *aux, *prev;
+
+    semantic(node.expr);
+    t->codelen = node.expr->codelen + switch_dispatch_len(t);
+
+    for (aux = node.cases; aux != NULL; aux = aux->case_n.next)
+    {
+        for (prev = node.cases; prev != aux; prev = prev->case_n.next)
+        {
+            if (prev->case_n.val == aux->case_n.val)
+            {
+                set_error_info(aux->pos_infos);
+                fatal_error("le ~BCAS %d~E apparaît plusieurs fois dans le "\
+                            "~BSELON~E", aux->case_n.val);
+                exit(1);
+            }
+        }
+
+        semantic(aux->case_n.list_instr);
+
+        /* JUMP à la fin du SELON, sauf après le dernier CAS sans SINON */
+        t->codelen += aux->case_n.list_instr->codelen;
+        if (aux->case_n.next != NULL || node.default_instr != NULL)
+        {
+            t->codelen += 1;
+        }
+    }
+
+    semantic(node.default_instr);
+    if (node.default_instr != NULL) t->codelen += node.default_instr->codelen;
+}
+
+
 void semantic_for(ast *t)
 {
     for_node node = t->for_n;
@@ -468,7 +902,7 @@ void semantic_for(ast *t)
     semantic(node.list_instr);
 
     set_error_info(node.id->pos_infos);
-    symbol *tmp = get_symbol(table, current_ctx, node.id->id.name);
+    symbol *tmp = get_symbol(arc_ctx.table, current_ctx, node.id->id.name);
 
     int cost = tmp->mem_zone == 's' ? 6 : 3;
     t->codelen = node.affect_init->codelen + node.end_exp->codelen\
@@ -485,7 +919,7 @@ void semantic_affect(ast *t)
     semantic(node.id);
 
     set_error_info(node.id->pos_infos);
-    symbol *tmp = get_symbol(table, current_ctx, node.id->id.name);
+    symbol *tmp = get_symbol(arc_ctx.table, current_ctx, node.id->id.name);
 
     /* Si déjà init alors il est modifié */
     tmp->is_modified = tmp->is_init ? 1 : tmp->is_modified;
@@ -501,6 +935,11 @@ void semantic_affect(ast *t)
 void semantic_io(ast *t)
 {
     io_node node = t->io;
+    if (node.id != NULL)
+    {
+        semantic_io_tab(t);
+        return;
+    }
     semantic(node.expr);
 
     t->codelen = 1;                 /* READ ou WRITE */
@@ -532,7 +971,8 @@ static void semantic_int_decla(ast *t)
      */
     char zone = strcmp(current_ctx, "global") == 0 ? 'h' : 's';
 
-    t->codelen = 1;
+    /* DEC STACK_REG (la mémoire statique est réservée à la compilation) */
+    t->codelen = zone == 's' ? 1 : 0;
 
     int adr;
     int stack_instr = 0;
@@ -550,7 +990,7 @@ static void semantic_int_decla(ast *t)
 
     set_error_info(node.var->pos_infos);
     symbol *new_symb = init_symbol(id, adr, zone, integer);
-    add_symbol(table, current_ctx, new_symb);
+    add_symbol(arc_ctx.table, current_ctx, new_symb);
 
     semantic(node.expr);
     semantic(node.next);
@@ -585,7 +1025,7 @@ static void semantic_ptr_decla(ast *t)
     set_error_info(node.var->pos_infos);
 
     symbol *new_symb = init_symbol(id, adr, zone, pointer);
-    add_symbol(table, current_ctx, new_symb);
+    add_symbol(arc_ctx.table, current_ctx, new_symb);
 
     semantic(node.expr);
     semantic(node.next);
@@ -593,7 +1033,7 @@ static void semantic_ptr_decla(ast *t)
 
     new_symb->is_used = 0;
 
-    t->codelen = 1;
+    t->codelen = zone == 's' ? 1 : 0;
     if (node.next != NULL) t->codelen += node.next->codelen;
 }
 
@@ -605,22 +1045,42 @@ static void semantic_arr_decla(ast *t)
 
     char zone = strcmp(current_ctx, "global") == 0 ? 'h' : 's';
 
+    /*
+     * Avec --bounds-check, la taille du tableau est stockée dans la case qui
+     * précède tab[0] (comme l'en-tête des blocs d'ALLOUER): les accès via un
+     * pointeur vers le tableau peuvent aussi être vérifiés.
+     */
     int adr;
     if (zone == 'h')
     {
-        adr = node.var->mem_adr = STATIC_START + static_rel_adr;
-        static_rel_adr += arr_node.size > 1 ? arr_node.size : 1;
+        adr = node.var->mem_adr = STATIC_START + static_rel_adr + bounds_check;
+        static_rel_adr += (arr_node.size > 1 ? arr_node.size : 1)
+                          + bounds_check;
     }
     else if (zone == 's')
     {
-        stack_rel_adr += arr_node.size > 1 ? arr_node.size : 1;
-        adr = node.var->mem_adr = stack_rel_adr;
+        /*
+         * tab[x] est à l'adresse STACK_REL_START - adr + x: tab[0] est donc la
+         * case la plus éloignée de STACK_REL_START.
+         */
+        stack_rel_adr += (arr_node.size > 1 ? arr_node.size : 1)
+                         + bounds_check;
+        adr = node.var->mem_adr = stack_rel_adr - 1 - bounds_check;
     }
     
     char *id = arr_node.id->id.name;
+    if (arr_node.nb_cols < 0 || (arr_node.nb_cols > 0 && arr_node.size <= 0))
+    {
+        set_error_info(arr_node.id->pos_infos);
+        fatal_error("les dimensions du tableau ~U%s~E doivent être "\
+                    "strictement positives", arr_node.id->id.name);
+        exit(1);
+    }
+
     symbol *new_symb = init_symbol(id, adr, zone, node.type);
     new_symb->size = arr_node.size;
-    add_symbol(table, current_ctx, new_symb);
+    new_symb->nb_cols = arr_node.nb_cols;
+    add_symbol(arc_ctx.table, current_ctx, new_symb);
 
     semantic(arr_node.list_expr);
     semantic(arr_node.id);
@@ -629,12 +1089,21 @@ static void semantic_arr_decla(ast *t)
     new_symb->is_used = 0;
 
 
-    /* On compte le nombre d'éléments qui initialisent le tableau */
+    /*
+     * On compte le nombre d'éléments qui initialisent le tableau, et le coût
+     * de leur stockage dans la mémoire statique (voir codegen_arr_decla)
+     */
     int size = 0;
+    int static_cost = 0;
     ast *aux = arr_node.list_expr;
+    ast *prev = NULL;
     while (aux != NULL)
     {
         size++;
+        if (is_repeated_constant(prev, aux->exp_list.exp)) static_cost += 1;
+        else static_cost += aux->exp_list.exp->codelen + 1;
+
+        prev = aux->exp_list.exp;
         aux = aux->exp_list.next;
     }
 
@@ -650,12 +1119,16 @@ static void semantic_arr_decla(ast *t)
 
     t->codelen = 0;
     if (new_symb->mem_zone == 's') t->codelen += 3;
-    else if (arr_node.list_expr == NULL) t->codelen += 3;
+    if (bounds_check) t->codelen += new_symb->mem_zone == 's' ? 5 : 2;
 
     if (arr_node.list_expr != NULL)
     {
         new_symb->is_init = 1;
-        t->codelen += arr_node.list_expr->codelen + 2 * size;      // !
+        if (new_symb->mem_zone == 's')
+        {
+            t->codelen += arr_node.list_expr->codelen + 6 * size;
+        }
+        else t->codelen += static_cost;
     }
 
 
@@ -686,6 +1159,162 @@ void semantic_var_decla(ast *t)
 
 
 
+/**
+ * @brief Renvoie 1 si la dernière instruction de la liste est un RETOURNER.
+ *
+ * @param l
+ * @return int
+ */
+static int ends_with_return(ast *l)
+{
+    if (l == NULL) return 0;
+    while (l->list_instr.next != NULL) l = l->list_instr.next;
+    return l->list_instr.instr->type == return_type;
+}
+
+
+/**
+ * @brief Renvoie 1 si la liste d'instructions contient un ALLOUER_LOCAL (en
+ * dehors des fonctions appelées).
+ *
+ * @param t
+ * @return int
+ */
+static int has_local_alloc(ast *t)
+{
+    if (t == NULL) return 0;
+
+    switch (t->type)
+    {
+    case instr_type:
+        return has_local_alloc(t->list_instr.instr)
+            || has_local_alloc(t->list_instr.next);
+    case if_type:
+        return has_local_alloc(t->if_n.list_instr1)
+            || has_local_alloc(t->if_n.list_instr2);
+    case switch_type:
+        return has_local_alloc(t->switch_n.cases)
+            || has_local_alloc(t->switch_n.default_instr);
+    case case_type:
+        return has_local_alloc(t->case_n.list_instr)
+            || has_local_alloc(t->case_n.next);
+    case while_type:
+        return has_local_alloc(t->while_n.list_instr);
+    case do_while_type:
+        return has_local_alloc(t->do_while.list_instr);
+    case for_type:
+        return has_local_alloc(t->for_n.list_instr);
+    case alloc_type:
+        return t->alloc.is_local;
+    default:
+        return 0;
+    }
+}
+
+
+static int max_int(int a, int b)
+{
+    return a > b ? a : b;
+}
+
+
+/**
+ * @brief Renvoie le nombre maximal de valeurs temporaires que le code de `t`
+ * empile en même temps (voir les push() de codegen), sans compter celles des
+ * fonctions appelées. Surestimé pour les accès T[i][j], qui ne sont pas encore
+ * remplacés par T[i * nb_cols + j].
+ *
+ * @param t
+ * @return int
+ */
+static int push_depth(ast *t)
+{
+    if (t == NULL) return 0;
+
+    int d = 0, i = 0;
+    ast *aux;
+
+    switch (t->type)
+    {
+    case b_op_type:
+        d = 1 + push_depth(t->b_op.l_memb);
+        return max_int(d, push_depth(t->b_op.r_memb));
+    case u_op_type:
+        return push_depth(t->u_op.child);
+    case affect_type:
+        return push_depth(t->affect.expr);
+    case instr_type:
+        d = push_depth(t->list_instr.instr);
+        return max_int(d, push_depth(t->list_instr.next));
+    case decla_type:
+        d = push_depth(t->decla_list.decla);
+        return max_int(d, push_depth(t->decla_list.next));
+    case var_decla_type:
+        d = push_depth(t->var_decla.expr);
+        if (t->var_decla.type == array)
+        {
+            d = max_int(d, push_depth(t->var_decla.var->arr_decla.list_expr));
+        }
+        return max_int(d, push_depth(t->var_decla.next));
+    case exp_list_type:
+        d = push_depth(t->exp_list.exp);
+        return max_int(d, push_depth(t->exp_list.next));
+    case while_type:
+        d = push_depth(t->while_n.expr);
+        return max_int(d, push_depth(t->while_n.list_instr));
+    case do_while_type:
+        d = push_depth(t->do_while.expr);
+        return max_int(d, push_depth(t->do_while.list_instr));
+    case if_type:
+        d = max_int(push_depth(t->if_n.expr), push_depth(t->if_n.list_instr1));
+        return max_int(d, push_depth(t->if_n.list_instr2));
+    case for_type:
+        d = max_int(push_depth(t->for_n.affect_init),
+                    push_depth(t->for_n.end_exp));
+        return max_int(d, push_depth(t->for_n.list_instr));
+    case switch_type:
+        d = max_int(push_depth(t->switch_n.expr),
+                    push_depth(t->switch_n.cases));
+        return max_int(d, push_depth(t->switch_n.default_instr));
+    case case_type:
+        d = push_depth(t->case_n.list_instr);
+        return max_int(d, push_depth(t->case_n.next));
+    case io_type:
+        return push_depth(t->io.expr);
+    case return_type:
+        return push_depth(t->return_n.expr);
+    case alloc_type:
+        return push_depth(t->alloc.expr);
+    case func_call_type:
+        /* Sauvegardes, adresse de retour puis les paramètres un par un */
+        d = 3;
+        for (aux = t->func_call.params; aux != NULL; aux = aux->exp_list.next)
+        {
+            d = max_int(d, 3 + i + push_depth(aux->exp_list.exp));
+            i++;
+        }
+        return max_int(d, 3 + i);
+    case array_access_type:
+        d = push_depth(t->arr_access.ind_expr);
+        if (t->arr_access.col_expr != NULL)
+        {
+            d = 2 + max_int(d, push_depth(t->arr_access.col_expr));
+        }
+        if (t->arr_access.affect_expr != NULL)
+        {
+            d = max_int(d, 1 + push_depth(t->arr_access.affect_expr));
+        }
+        return d;
+    case block_type:
+        d = max_int(push_depth(t->block.size), push_depth(t->block.dst));
+        return max_int(d, 1 + push_depth(t->block.src));
+    default:
+        return 0;
+    }
+}
+
+
+
 /**
  * @brief 
  * 
@@ -707,13 +1336,13 @@ void semantic_func_decla(ast *t)
      * En effet, il est peut-être déjà dans la table des symboles si un 
      * prototype a été mit.
      */
-    symbol *tmp = search_symbol(table, current_ctx, node.id->id.name);
+    symbol *tmp = search_symbol(arc_ctx.table, current_ctx, node.id->id.name);
     if (tmp == NULL)
     {
         symbol *new_symb = init_symbol(node.id->id.name, 0, 'h', func);
         new_symb->size = n;
         new_symb->is_init = 1;
-        tmp = add_symbol(table, current_ctx, new_symb);
+        tmp = add_symbol(arc_ctx.table, current_ctx, new_symb);
     }
     tmp->is_init = 1;
 
@@ -722,7 +1351,7 @@ void semantic_func_decla(ast *t)
     /* On change le contexte qui devient le nom de la fonction */
     strcpy(old_context, current_ctx);
     strcpy(current_ctx, node.id->id.name);
-    add_context(table, current_ctx);
+    add_context(arc_ctx.table, current_ctx);
 
     /*
      * À la fin de son exécution, la fonction doit rendre la pile dans
@@ -736,14 +1365,32 @@ void semantic_func_decla(ast *t)
      */
     stack_rel_adr = strcmp(node.id->id.name, "PROGRAMME") == 0 ? 0 : 1;
 
-    has_return_instr = 0;
-    
     semantic(node.params);
     semantic(node.list_decl);
+
+    /*
+     * ALLOUER_LOCAL: HEAP_REG est empilé après les variables locales au début
+     * de la fonction, et remis à cette valeur par chaque RETOURNER. Inutile
+     * pour la fonction principale.
+     */
+    heap_mark = 0;
+    if (strcmp(node.id->id.name, "PROGRAMME") != 0
+        && has_local_alloc(node.list_instr))
+    {
+        heap_mark = stack_rel_adr++;
+    }
+    t->func_decla.heap_mark = heap_mark;
+
+    temps = t->func_decla.temps = push_depth(node.list_instr);
     semantic(node.list_instr);
 
-    /* Si pas de "RETOURNER" spécifié on créé un noeud vide qui renverra 0 */
-    if (!has_return_instr && strcmp(node.id->id.name, "PROGRAMME") != 0)
+    /*
+     * Si la fonction ne se termine pas par un "RETOURNER" on créé un noeud
+     * vide qui renverra 0 (même s'il y a des "RETOURNER" dans des SI ou des
+     * boucles, sinon l'exécution continuerait dans la fonction suivante)
+     */
+    if (!ends_with_return(node.list_instr)
+        && strcmp(node.id->id.name, "PROGRAMME") != 0)
     {
         ast *return_n = create_return_node(NULL);
 
@@ -756,14 +1403,27 @@ void semantic_func_decla(ast *t)
 
     if (node.list_decl != NULL) t->codelen += node.list_decl->codelen;
     if (node.list_instr != NULL) t->codelen += node.list_instr->codelen;
+    if (heap_mark != 0) t->codelen += 1 + PUSH_COST;
 
     /* Au cas où ça change + tard (STOP pour PROGRAMME, JUMP pour les autre) */
     if (strcmp(node.id->id.name, "PROGRAMME") == 0) t->codelen += 1;
     else t->codelen += 1;
 
+    /*
+     * --guard: taille de la pile utilisée par un appel, vérifiée avant l'appel
+     * (au début pour la fonction principale): variables locales, paramètres,
+     * adresse de retour, valeurs temporaires et les 2 sauvegardes empilées par
+     * l'appelant (voir codegen_func_call).
+     */
+    tmp->frame_size = stack_rel_adr + temps;
+    if (strcmp(node.id->id.name, "PROGRAMME") != 0) tmp->frame_size += 2;
+    else if (guard_mode) t->codelen += GUARD_STACK_COST;
+
     /* On revient au contexte précédent */
     strcpy(current_ctx, old_context);
     stack_rel_adr = old_stack_rel_adr;
+    heap_mark = 0;
+    temps = 0;
 }
 
 
@@ -774,7 +1434,7 @@ void semantic_func_call(ast *t)
     semantic(node.func_id);
 
     /* On vérifie que la fonction existe */
-    symbol *tmp = get_symbol(table, current_ctx, node.func_id->id.name);
+    symbol *tmp = get_symbol(arc_ctx.table, current_ctx, node.func_id->id.name);
 
     /* On compte le nombre de paramètres */
     int nb_params = 0;
@@ -798,6 +1458,14 @@ void semantic_func_call(ast *t)
     /* Analyse sémantique des paramètres passés */
     semantic(node.params);
 
+    /* Arc du graphe des appels (voir max_stack_size) */
+    call_edge *e = (call_edge *) malloc(sizeof(call_edge));
+    check_alloc(e);
+    strcpy(e->caller, current_ctx);
+    strcpy(e->callee, tmp->id);
+    e->next = calls;
+    calls = e;
+
     /*
      * Codelen: 1 mise à jour de STACK_REL_START, 1 JUMP vers le code
      * de la fonction, et re mise en l'état initial de STACK_REL_START.
@@ -807,13 +1475,15 @@ void semantic_func_call(ast *t)
      */
     t->codelen = 24 + 2 * nb_params;
     if (node.params != NULL) t->codelen += node.params->codelen;
+
+    /* Vérification de la place dans la pile (--guard) */
+    if (guard_mode) t->codelen += GUARD_STACK_COST;
 }
 
 
 void semantic_return(ast *t)
 {
     return_node node = t->return_n;
-    has_return_instr = 1;
 
     /*
      * On ne peut retourner que depuis une fonction autre que la
@@ -837,6 +1507,9 @@ void semantic_return(ast *t)
     
     if (strcmp(current_ctx, "PROGRAMME") == 0) t->codelen += 1;
     else t->codelen += 10 + PUSH_COST;
+
+    /* Restauration de HEAP_REG (ALLOUER_LOCAL) */
+    if (heap_mark != 0) t->codelen += 4;
 }
 
 
@@ -854,13 +1527,28 @@ void semantic_exp_list(ast *t)
 
 void semantic_arr_access(ast *t)
 {
+    /* T[i][j] (s'il n'a pas déjà été remplacé par les optimisations) */
+    if (t->arr_access.col_expr != NULL)
+    {
+        set_error_info(t->arr_access.id->pos_infos);
+        symbol *s = get_symbol(arc_ctx.table, current_ctx,
+                               t->arr_access.id->id.name);
+        if (s->type != array || s->nb_cols == 0)
+        {
+            fatal_error("~B%s~E n'est pas un tableau à 2 dimensions",
+                        s->id);
+            exit(1);
+        }
+        flatten_arr_access(t, s->nb_cols);
+    }
+
     array_access_node node = t->arr_access;
     semantic(node.id);
     semantic(node.ind_expr);
     semantic(node.affect_expr);
 
     set_error_info(node.id->pos_infos);
-    symbol *tmp = get_symbol(table, current_ctx, node.id->id.name);
+    symbol *tmp = get_symbol(arc_ctx.table, current_ctx, node.id->id.name);
     if (tmp->type != array && tmp->type != pointer)
     {
         fatal_error("Impossible d'utiliser l'opérateur ~B[]~E");
@@ -873,6 +1561,15 @@ void semantic_arr_access(ast *t)
     if (tmp->type == array) t->codelen += (tmp->mem_zone == 's') ? 4 : 1;
     else t->codelen += (tmp->mem_zone == 's') ? 5 : 3;
 
+    /* Vérification des bornes (voir codegen_check_array/pointer) */
+    int check = bounds_to_check(t);
+    if (check & BOUNDS_LOW) t->codelen += 1;
+    if (check && tmp->type == array)
+    {
+        t->codelen += tmp->mem_zone == 's' ? 4 : 3;
+    }
+    else if (check) t->codelen += 8;
+
     if (node.affect_expr != NULL) t->codelen += node.affect_expr->codelen + 8;
     else t->codelen += 1;
 }
@@ -885,20 +1582,173 @@ void semantic_alloc(ast *t)
     semantic(node.expr);
 
     set_error_info(node.id->pos_infos);
-    symbol *tmp = get_symbol(table, current_ctx, node.id->id.name);
+    symbol *tmp = get_symbol(arc_ctx.table, current_ctx, node.id->id.name);
     if (tmp->type != pointer)
     {
-        symb_to_img(table, "table", "png");
+        symb_to_img(arc_ctx.table, "table", "png");
         fatal_error("Impossible d'allouer de la mémoire à ~B%s~E "\
                     "car ça n'est pas un pointeur.", node.id->id.name);
         exit(1);
     }
 
+    /*
+     * Les blocs libérés par LIBERER peuvent être au-dessus de la sauvegarde de
+     * HEAP_REG: ils seraient réutilisés après le retour de la fonction.
+     */
+    if (node.is_local && arc_ctx.uses_free)
+    {
+        fatal_error("~BALLOUER_LOCAL~E ne peut pas être utilisé dans un "\
+                    "programme qui utilise ~BLIBERER~E");
+        exit(1);
+    }
+
     tmp->is_init = 1;
+    arc_ctx.uses_alloc = 1;
 
     t->codelen = node.expr->codelen + 4;
-    if (tmp->mem_zone == 's') t->codelen += 5;
+    if (arc_ctx.uses_free) t->codelen += tmp->mem_zone == 's' ? 5 : 1;
+    else if (tmp->mem_zone == 's') t->codelen += 5;
     else t->codelen += 2;
+
+    /* En-tête contenant la taille du bloc (--bounds-check) */
+    if (bounds_check && !arc_ctx.uses_free) t->codelen += 3;
+
+    /* Vérification de la place dans le tas (--guard, voir codegen_guard_heap) */
+    if (guard_mode) t->codelen += GUARD_HEAP_COST + (temps > 0);
+    if (guard_mode && arc_ctx.uses_free && tmp->mem_zone != 's')
+    {
+        t->codelen += 1;
+    }
+}
+
+
+void semantic_free(ast *t)
+{
+    free_node node = t->free_n;
+    semantic(node.id);
+
+    set_error_info(node.id->pos_infos);
+    symbol *tmp = get_symbol(arc_ctx.table, current_ctx, node.id->id.name);
+    if (tmp->type != pointer)
+    {
+        fatal_error("Impossible de libérer ~B%s~E car ça n'est pas un "\
+                    "pointeur.", node.id->id.name);
+        exit(1);
+    }
+
+    /* Chargement du pointeur puis appel de la routine de ramOS */
+    t->codelen = node.id->codelen + 4;
+}
+
+
+/**
+ * @brief Vérifie que `id` est un tableau ou un pointeur et renvoie son symbole.
+ * 
+ * @param id 
+ * @return symbol* 
+ */
+static symbol *block_symbol(ast *id)
+{
+    set_error_info(id->pos_infos);
+    symbol *tmp = get_symbol(arc_ctx.table, current_ctx, id->id.name);
+    if (tmp->type != array && tmp->type != pointer)
+    {
+        fatal_error("~B%s~E n'est ni un tableau ni un pointeur",
+                    id->id.name);
+        exit(1);
+    }
+
+    return tmp;
+}
+
+
+/* Nombre d'instructions de codegen_block_base */
+static int block_base_len(symbol *tmp)
+{
+    if (tmp->mem_zone != 's') return 1;
+    return tmp->type == pointer ? 3 : 2;
+}
+
+
+void semantic_block(ast *t)
+{
+    block_node node = t->block;
+    semantic(node.dst);
+    semantic(node.src);
+    semantic(node.size);
+
+    symbol *dst = block_symbol(node.dst);
+    symbol *src = node.op == 'c' ? block_symbol(node.src) : NULL;
+    dst->is_init = 1;
+
+    /* Tableaux de la mémoire statique: accès direct si la boucle est déroulée */
+    int dst_direct = dst->type == array && dst->mem_zone != 's';
+    int src_direct = src != NULL && src->type == array && src->mem_zone != 's';
+    int dst_len = block_base_len(dst);
+    int src_len = src == NULL ? 0 : block_base_len(src);
+    int val_len = src == NULL ? node.src->codelen : 0;
+
+    /* La taille est comparée à celle des tableaux par mark_src_uses */
+    if (node.size->type == nb_type)
+    {
+        int k = node.size->nb.val;
+        if (k <= BLOCK_UNROLL_MAX)
+        {
+            /* Voir codegen_block_unrolled */
+            t->codelen = val_len;
+            if (k <= 0) return;
+
+            if (src == NULL)
+            {
+                if (dst_direct) t->codelen += k;
+                else t->codelen += dst_len + 2 + 2 * k;
+                return;
+            }
+
+            t->codelen = 2 * k;
+            if (!src_direct) t->codelen += src_len + 1 + k - 1;
+            if (!dst_direct) t->codelen += dst_len + 1 + k - 1;
+            return;
+        }
+    }
+
+    /* Taille, tests de la taille, initialisation des registres et boucle */
+    t->codelen = node.size->codelen + 3 + dst_len + 1;
+    if (src != NULL) t->codelen += src_len + 1 + 7;
+    else
+    {
+        t->codelen += val_len + 1 + 6;
+        if (node.src->type != nb_type && node.src->type != id_type)
+        {
+            t->codelen += PUSH_COST + POP_COST;
+        }
+    }
+}
+
+
+/* Voir codegen_io_tab */
+void semantic_io_tab(ast *t)
+{
+    io_node node = t->io;
+    semantic(node.id);
+    semantic(node.expr);
+
+    symbol *tmp = block_symbol(node.id);
+    if (node.mode == 'R') tmp->is_init = 1;
+
+    int tests = 3;                  /* JUMZ, JUML et STORE BLOCK_REG_CNT */
+    if (node.expr->type == nb_type)
+    {
+        int k = node.expr->nb.val;
+
+        /* Taille constante: pas de code si k <= 0, pas de tests sinon */
+        t->codelen = 0;
+        if (k <= 0) return;
+        tests = 1;
+    }
+
+    /* Taille, tests de la taille, initialisation du pointeur et boucle */
+    t->codelen = node.expr->codelen + tests + block_base_len(tmp) + 1 + 6;
 }
 
 
@@ -909,14 +1759,200 @@ void semantic_proto(ast *t)
     set_error_info(node.id->pos_infos);
 
     /* Si déjà déclaré, on ignore */
-    symbol *tmp = search_symbol(table, current_ctx, node.id->id.name);
+    symbol *tmp = search_symbol(arc_ctx.table, current_ctx, node.id->id.name);
     if (tmp == NULL)
     {
         symbol *new_symb = init_symbol(node.id->id.name, 0, 'h', func);
         new_symb->size = node.nb_params;
 
         /* Ajout dans la table des symboles */
-        add_symbol(table, current_ctx, new_symb);
+        add_symbol(arc_ctx.table, current_ctx, new_symb);
     }
 }
 
+
+void semantic_inc(ast *t)
+{
+    set_error_info(t->inc.id->pos_infos);
+    symbol *tmp = get_symbol(arc_ctx.table, current_ctx, t->inc.id->id.name);
+    tmp->is_modified = 1;
+
+    /* Même code que l'incrément d'un POUR */
+    t->codelen = tmp->mem_zone == 's' ? 4 : 1;
+}
+
+
+
+/*
+ * Graphe des appels utilisé par max_stack_size. Le sommet i est la fonction
+ * funcs[i] (le dernier est "global", funcs vaut alors NULL), de pile frame[i].
+ * calls_to[i * n + j] vaut 1 si i appelle j, reach[i * n + j] si i peut
+ * appeler j (directement ou non). depth[i] est la pile maximale d'un appel de
+ * i, y compris les fonctions qu'il appelle (-1 si pas encore calculée).
+ */
+typedef struct {
+    int n;
+    symbol **funcs;
+    int *frame;
+    char *calls_to;
+    char *reach;
+    int *depth;
+    int rec_depth;
+} call_graph;
+
+
+static int call_graph_index(call_graph *g, const char *id)
+{
+    int i;
+    for (i = 0; i < g->n - 1; i++)
+    {
+        if (strcmp(g->funcs[i]->id, id) == 0) return i;
+    }
+    return g->n - 1;
+}
+
+
+/**
+ * @brief Renvoie 1 si i et j sont dans la même composante fortement connexe
+ * du graphe des appels (i == j ou appels récursifs entre eux).
+ */
+static int same_component(call_graph *g, int i, int j)
+{
+    return i == j || (g->reach[i * g->n + j] && g->reach[j * g->n + i]);
+}
+
+
+/**
+ * @brief Calcule la pile maximale d'un appel de i (voir call_graph): sa
+ * composante fortement connexe, puis la plus grande des fonctions appelées en
+ * dehors de celle-ci. Une composante récursive compte rec_depth fois la pile de
+ * chacune de ses fonctions.
+ * 
+ * @param g 
+ * @param i 
+ * @return int La taille, -1 si i est récursive et rec_depth vaut 0
+ */
+static int call_depth(call_graph *g, int i)
+{
+    int j, k, d, size = 0, callees = 0;
+    int n = g->n;
+
+    if (g->depth[i] >= 0) return g->depth[i];
+    if (g->reach[i * n + i] && g->rec_depth == 0) return -1;
+
+    for (j = 0; j < n; j++)
+    {
+        if (!same_component(g, i, j)) continue;
+        size += g->frame[j];
+
+        for (k = 0; k < n; k++)
+        {
+            if (!g->calls_to[j * n + k] || same_component(g, i, k)) continue;
+            d = call_depth(g, k);
+            if (d < 0) return -1;
+            callees = max_int(callees, d);
+        }
+    }
+
+    if (g->reach[i * n + i]) size *= g->rec_depth;
+
+    for (j = 0; j < n; j++)
+    {
+        if (same_component(g, i, j)) g->depth[j] = size + callees;
+    }
+
+    return size + callees;
+}
+
+
+/**
+ * @brief Renvoie le nombre maximal de cases de la pile utilisées par le
+ * programme t (pour --mem-size=auto), d'après le graphe des appels et la pile
+ * de chaque fonction (frame_size). Les fonctions récursives sont comptées
+ * rec_depth fois.
+ * 
+ * @param t L'ASA, après l'analyse sémantique
+ * @param rec_depth La profondeur maximale de la récursivité (0 si inconnue)
+ * @return int La taille, -1 si le programme est récursif et rec_depth vaut 0
+ */
+int max_stack_size(ast *t, int rec_depth)
+{
+    call_graph g;
+    call_edge *e;
+    symbol *s;
+    int i, j, k, size;
+
+    context *global = search_context(arc_ctx.table, "global");
+
+    g.n = 1;
+    for (s = global->symb_list; s != NULL; s = s->next)
+    {
+        if (s->type == func) g.n++;
+    }
+
+    g.funcs = (symbol **) malloc(sizeof(symbol *) * g.n);
+    g.frame = (int *) malloc(sizeof(int) * g.n);
+    g.depth = (int *) malloc(sizeof(int) * g.n);
+    g.calls_to = (char *) calloc(g.n * g.n, sizeof(char));
+    g.reach = (char *) calloc(g.n * g.n, sizeof(char));
+    check_alloc(g.funcs);
+    check_alloc(g.frame);
+    check_alloc(g.depth);
+    check_alloc(g.calls_to);
+    check_alloc(g.reach);
+    g.rec_depth = rec_depth;
+
+    i = 0;
+    for (s = global->symb_list; s != NULL; s = s->next)
+    {
+        if (s->type != func) continue;
+        g.funcs[i] = s;
+        g.frame[i++] = s->frame_size;
+    }
+
+    /* "global": valeurs temporaires des initialisations des variables */
+    g.funcs[i] = NULL;
+    g.frame[i] = push_depth(t->root.list_decl);
+
+    for (e = calls; e != NULL; e = e->next)
+    {
+        i = call_graph_index(&g, e->caller);
+        j = call_graph_index(&g, e->callee);
+        g.calls_to[i * g.n + j] = g.reach[i * g.n + j] = 1;
+    }
+
+    /* Fermeture transitive (Floyd-Warshall) */
+    for (k = 0; k < g.n; k++)
+    {
+        for (i = 0; i < g.n; i++)
+        {
+            if (!g.reach[i * g.n + k]) continue;
+            for (j = 0; j < g.n; j++)
+            {
+                if (g.reach[k * g.n + j]) g.reach[i * g.n + j] = 1;
+            }
+        }
+    }
+
+    for (i = 0; i < g.n; i++) g.depth[i] = -1;
+
+    /*
+     * Les variables globales sont initialisées avant la fonction principale,
+     * avec la même pile
+     */
+    size = call_depth(&g, g.n - 1);
+    i = call_graph_index(&g, "PROGRAMME");
+    if (size >= 0 && i < g.n - 1)
+    {
+        int main_size = call_depth(&g, i);
+        size = main_size < 0 ? -1 : max_int(size, main_size);
+    }
+
+    free(g.funcs);
+    free(g.frame);
+    free(g.depth);
+    free(g.calls_to);
+    free(g.reach);
+
+    return size;
+}
@@ -0,0 +1,736 @@
+/*
+ * Générateur de programmes .algo aléatoires (et valides) pour le test
+ * différentiel des optimisations (voir run_diff.sh et la cible check-diff du
+ * makefile).
+ *
+ * Utilisation: gen_fuzz graine fichier.algo
+ *
+ * Les programmes couvrent la grammaire de parser.y: variables globales et
+ * locales, tableaux (statiques, dans la pile et alloués, à 1 ou 2
+ * dimensions), pointeurs, fonctions
+ * (éventuellement récursives), SI/SINON, SELON, TQ, FAIRE TQ, POUR, LIRE,
+ * ECRIRE, COPIER, REMPLIR et RETOURNER. Ils s'arrêtent toujours (les boucles sont bornées et une fonction
+ * n'appelle que les fonctions précédentes, ou elle-même avec une profondeur
+ * décroissante), et les valeurs restent petites (les affectations sont faites
+ * modulo 1000 et les expressions contiennent au plus deux multiplications)
+ * pour ne pas dépendre de la taille des entiers.
+ * La bande d'entrée doit contenir des entiers (lus par LIRE).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/* Nombre maximal de fonctions, de variables locales et de boucles */
+#define MAX_FUNCS 4
+#define NB_LOCALS 3
+#define MAX_LOOPS 16
+
+/* Tailles des tableaux */
+#define GLOBAL_ARR_SIZE 10
+#define LOCAL_ARR_SIZE 4
+#define PTR_ARR_SIZE 10
+#define MD_ARR_SIZE 5       /* gm[MD_ARR_SIZE][MD_ARR_SIZE] */
+
+/* Profondeur maximale des structures de contrôle et des expressions */
+#define MAX_DEPTH 3
+#define MAX_EXPR_DEPTH 2
+#define MAX_COND_DEPTH 3
+
+
+static unsigned long seed;
+
+static FILE *out;
+
+/* Fonction en cours de génération (nb_funcs pour PROGRAMME) */
+static int cur_func;
+static int nb_funcs;
+
+/* Compteurs de boucle de la fonction courante (lX), et ceux lisibles */
+static int nb_loops;
+static int loop_visible[MAX_LOOPS];
+
+/* Nombre de multiplications et d'appels de l'expression en cours */
+static int nb_mul;
+static int nb_calls;
+
+
+
+/**
+ * @brief Renvoie un entier aléatoire dans [0, n[ (générateur congruentiel
+ * pour que les programmes ne dépendent que de la graine).
+ *
+ * @param n
+ * @return int
+ */
+static int rnd(int n)
+{
+    seed = (seed * 6364136223846793005UL + 1442695040888963407UL);
+    return (int) ((seed >> 33) % n);
+}
+
+
+static void indent(int depth)
+{
+    fprintf(out, "%*s", 4 * (depth + 1), "");
+}
+
+
+static int in_func()
+{
+    return cur_func < nb_funcs;
+}
+
+
+
+static void gen_expr(int depth);
+
+
+/**
+ * @brief Écrit un indice valide pour un tableau de taille `size`.
+ *
+ * @param size
+ */
+static void gen_index(int size)
+{
+    int i;
+
+    /*
+     * tab[lX + K] (lX < 5), le cas optimisé par la réduction de force, et
+     * tab[lX + lX] où K dépend de lX
+     */
+    for (i = 0; i < nb_loops && size >= 10; i++)
+    {
+        if (!loop_visible[i] || rnd(2) == 0) continue;
+
+        switch (rnd(3))
+        {
+        case 0:
+            fprintf(out, "l%d + %d", i, rnd(size - 5 + 1));
+            break;
+        case 1:
+            fprintf(out, "%d + l%d", rnd(size - 5 + 1), i);
+            break;
+        default:
+            fprintf(out, "l%d + l%d", i, i);
+            break;
+        }
+        return;
+    }
+
+    fprintf(out, "((");
+    gen_expr(MAX_EXPR_DEPTH);
+    fprintf(out, ") %% %d + %d) %% %d", size, size, size);
+}
+
+
+/**
+ * @brief Écrit un accès gm[i][j] au tableau à 2 dimensions. Les indices sont
+ * de préférence des compteurs de boucle (parcours ligne par ligne ou colonne
+ * par colonne).
+ */
+static void gen_md_access()
+{
+    int i, k;
+
+    fprintf(out, "gm[");
+    for (k = 0; k < 2; k++)
+    {
+        for (i = nb_loops - 1; i >= 0 && (!loop_visible[i] || rnd(2)); i--);
+        if (i >= 0) fprintf(out, "l%d", i);
+        else gen_index(MD_ARR_SIZE);
+        fprintf(out, k == 0 ? "][" : "]");
+    }
+}
+
+
+/**
+ * @brief Écrit un appel à une des fonctions précédentes (les appels récursifs
+ * sont écrits par gen_function).
+ */
+static void gen_call()
+{
+    nb_calls++;
+    fprintf(out, "f%d(%d, (", rnd(cur_func), rnd(3));
+    gen_expr(1);
+    fprintf(out, ") %% 1000, (");
+    gen_expr(1);
+    fprintf(out, ") %% 1000");
+
+    if (in_func()) fprintf(out, ", tab, r)");
+    else fprintf(out, ", p, @v%d)", rnd(NB_LOCALS));
+}
+
+
+static void gen_leaf()
+{
+    int i;
+
+    switch (rnd(in_func() ? 9 : 7))
+    {
+    case 0:
+    case 1:
+        fprintf(out, "%d", rnd(100));
+        break;
+    case 2:
+    case 3:
+        fprintf(out, "v%d", rnd(NB_LOCALS));
+        break;
+    case 4:
+        fprintf(out, "g%d", rnd(3));
+        break;
+    case 5:
+        if (rnd(3) == 0)
+        {
+            gen_md_access();
+            break;
+        }
+        fprintf(out, "gt[");
+        gen_index(GLOBAL_ARR_SIZE);
+        fprintf(out, "]");
+        break;
+    case 6:
+        /* Compteur d'une boucle englobante */
+        for (i = nb_loops - 1; i >= 0 && !loop_visible[i]; i--);
+        if (i >= 0) fprintf(out, "l%d", i);
+        else fprintf(out, "%d", rnd(10));
+        break;
+    case 7:
+        if (rnd(2) == 0) fprintf(out, "a");
+        else fprintf(out, "*r");
+        break;
+    default:
+        i = rnd(2);
+        fprintf(out, i == 0 ? "t[" : "tab[");
+        gen_index(i == 0 ? LOCAL_ARR_SIZE : PTR_ARR_SIZE);
+        fprintf(out, "]");
+        break;
+    }
+}
+
+
+/**
+ * @brief Écrit une expression arithmétique de profondeur au plus
+ * MAX_EXPR_DEPTH - depth.
+ *
+ * @param depth
+ */
+static void gen_expr(int depth)
+{
+    static const char ops[5] = {'+', '-', '*', '/', '%'};
+
+    if (depth >= MAX_EXPR_DEPTH || rnd(3) == 0)
+    {
+        if (cur_func > 0 && nb_calls < 2 && rnd(8) == 0) gen_call();
+        else if (rnd(6) == 0)
+        {
+            /* Indice constant */
+            fprintf(out, "%s[%d]", in_func() ? "tab" : "p", rnd(PTR_ARR_SIZE));
+        }
+        else gen_leaf();
+        return;
+    }
+
+    char op = ops[rnd(5)];
+    if (op == '*' && nb_mul == 2) op = '+';
+
+    if (rnd(8) == 0)
+    {
+        fprintf(out, "-(");
+        gen_expr(depth + 1);
+        fprintf(out, ")");
+        return;
+    }
+
+    fprintf(out, "(");
+    gen_expr(depth + 1);
+
+    /* Division et modulo par une constante non nulle */
+    if (op == '/' || op == '%') fprintf(out, " %c %d)", op, rnd(9) + 1);
+    else
+    {
+        if (op == '*') nb_mul++;
+        fprintf(out, " %c ", op);
+        gen_expr(depth + 1);
+        fprintf(out, ")");
+    }
+}
+
+
+/**
+ * @brief Écrit une expression (bornée, voir gen_expr), en remettant à zéro
+ * les compteurs de multiplications et d'appels.
+ */
+static void gen_value()
+{
+    nb_mul = 0;
+    nb_calls = 0;
+    gen_expr(0);
+}
+
+
+/**
+ * @brief Écrit une condition (NON, ET et OU imbriqués sur au plus
+ * MAX_COND_DEPTH - depth niveaux, puis des comparaisons).
+ *
+ * @param depth
+ */
+static void gen_cond_rec(int depth)
+{
+    static const char *cmp[6] = {"<", ">", "=", "<=", ">=", "!="};
+
+    switch (depth >= MAX_COND_DEPTH ? 3 : rnd(6))
+    {
+    case 0:
+        fprintf(out, "NON (");
+        gen_cond_rec(depth + 1);
+        fprintf(out, ")");
+        break;
+    case 1:
+    case 2:
+        fprintf(out, "(");
+        gen_cond_rec(depth + 1);
+        fprintf(out, rnd(2) == 0 ? ") ET (" : ") OU (");
+        gen_cond_rec(depth + 1);
+        fprintf(out, ")");
+        break;
+    default:
+        gen_value();
+        fprintf(out, " %s ", cmp[rnd(6)]);
+        gen_value();
+        break;
+    }
+}
+
+
+static void gen_cond()
+{
+    gen_cond_rec(0);
+}
+
+
+
+static void gen_list(int depth, int nb);
+
+
+/**
+ * @brief Écrit la cible d'une affectation (variable, case de tableau ou *r).
+ */
+static void gen_target()
+{
+    switch (rnd(in_func() ? 7 : 5))
+    {
+    case 0:
+    case 1:
+        fprintf(out, "v%d", rnd(NB_LOCALS));
+        break;
+    case 2:
+        fprintf(out, "g%d", rnd(3));
+        break;
+    case 3:
+        if (rnd(3) == 0)
+        {
+            gen_md_access();
+            break;
+        }
+        fprintf(out, "gt[");
+        gen_index(GLOBAL_ARR_SIZE);
+        fprintf(out, "]");
+        break;
+    case 4:
+        fprintf(out, "%s[", in_func() ? "tab" : "p");
+        gen_index(PTR_ARR_SIZE);
+        fprintf(out, "]");
+        break;
+    case 5:
+        fprintf(out, "*r");
+        break;
+    default:
+        fprintf(out, "t[");
+        gen_index(LOCAL_ARR_SIZE);
+        fprintf(out, "]");
+        break;
+    }
+}
+
+
+/**
+ * @brief Écrit une boucle POUR, TQ ou FAIRE TQ d'au plus 5 itérations, dont
+ * le compteur lX n'est modifié que par la boucle.
+ *
+ * @param depth
+ */
+static void gen_loop(int depth)
+{
+    int l = nb_loops++;
+
+    switch (rnd(3))
+    {
+    case 0:
+        fprintf(out, "POUR l%d DANS %d...", l, rnd(2));
+        if (rnd(2) == 0) fprintf(out, "%d", rnd(5) + 1);
+        else
+        {
+            fprintf(out, "(");
+            gen_value();
+            fprintf(out, ") %% 3 + 3");
+        }
+        fprintf(out, " FAIRE\n");
+        loop_visible[l] = 1;
+        gen_list(depth + 1, rnd(3) + 1);
+        indent(depth);
+        fprintf(out, "FPOUR\n");
+        break;
+    case 1:
+        fprintf(out, "l%d <- 0\n", l);
+        indent(depth);
+        fprintf(out, "TQ l%d < %d ET (", l, rnd(5) + 1);
+        gen_cond();
+        fprintf(out, ") FAIRE\n");
+        loop_visible[l] = 1;
+        gen_list(depth + 1, rnd(3) + 1);
+        indent(depth + 1);
+        fprintf(out, "l%d <- l%d + 1\n", l, l);
+        indent(depth);
+        fprintf(out, "FTQ\n");
+        break;
+    default:
+        fprintf(out, "l%d <- 0\n", l);
+        indent(depth);
+        fprintf(out, "FAIRE\n");
+        loop_visible[l] = 1;
+        gen_list(depth + 1, rnd(3) + 1);
+        indent(depth + 1);
+        fprintf(out, "l%d <- l%d + 1\n", l, l);
+        indent(depth);
+        fprintf(out, "TQ l%d < %d\n", l, rnd(5) + 1);
+        break;
+    }
+
+    loop_visible[l] = 0;
+}
+
+
+/**
+ * @brief Génère un SELON dont les CAS sont rapprochés (table de sauts) ou
+ * espacés (recherche dichotomique), avec ou sans SINON.
+ *
+ * @param depth
+ */
+static void gen_switch(int depth)
+{
+    int used[12] = {0};
+    int i, v, nb = rnd(5) + 1;
+    int step = rnd(3) == 0 ? 5 : 1;
+
+    fprintf(out, "SELON (");
+    gen_value();
+    fprintf(out, ") %% %d\n", 10 * step);
+
+    for (i = 0; i < nb; i++)
+    {
+        do v = rnd(12) - 2; while (used[v + 2]);
+        used[v + 2] = 1;
+
+        indent(depth);
+        fprintf(out, "CAS %d:\n", v * step);
+        gen_list(depth + 1, rnd(2) + 1);
+    }
+
+    if (rnd(2) == 0)
+    {
+        indent(depth);
+        fprintf(out, "SINON\n");
+        gen_list(depth + 1, rnd(2) + 1);
+    }
+    indent(depth);
+    fprintf(out, "FSELON\n");
+}
+
+
+/**
+ * @brief Écrit un COPIER ou un REMPLIR entre les tableaux gt, p (tab dans une
+ * fonction) et t, de taille constante ou calculée (éventuellement <= 0), sans
+ * dépasser la taille des tableaux.
+ */
+static void gen_block()
+{
+    const char *names[3] = {"gt", in_func() ? "tab" : "p", "t"};
+    int sizes[3] = {GLOBAL_ARR_SIZE, PTR_ARR_SIZE, LOCAL_ARR_SIZE};
+    int dst = rnd(in_func() ? 3 : 2), src = rnd(in_func() ? 3 : 2);
+    int size = sizes[dst];
+
+    if (rnd(2) == 0)
+    {
+        fprintf(out, "REMPLIR(%s, (", names[dst]);
+        gen_value();
+        fprintf(out, ") %% 1000, ");
+    }
+    else
+    {
+        fprintf(out, "COPIER(%s, %s, ", names[dst], names[src]);
+        if (sizes[src] < size) size = sizes[src];
+    }
+
+    if (rnd(2) == 0) fprintf(out, "%d)\n", rnd(size + 1));
+    else
+    {
+        fprintf(out, "(");
+        gen_value();
+        fprintf(out, ") %% %d)\n", size + 1);
+    }
+}
+
+
+static void gen_instr(int depth)
+{
+    int kind = rnd(10);
+
+    /* Pas de structure trop imbriquée, ni de boucle en trop */
+    if (kind >= 6 && (depth >= MAX_DEPTH || nb_loops == MAX_LOOPS)) kind = 0;
+
+    indent(depth);
+    switch (kind)
+    {
+    case 0:
+    case 1:
+    case 2:
+        gen_target();
+        fprintf(out, " <- (");
+        gen_value();
+        fprintf(out, ") %% 1000\n");
+        break;
+    case 3:
+        fprintf(out, "ECRIRE(");
+        gen_value();
+        fprintf(out, ")\n");
+        break;
+    case 4:
+        if (rnd(2) == 0) fprintf(out, "v%d <- LIRE()\n", rnd(NB_LOCALS));
+        else if (cur_func > 0)
+        {
+            nb_calls = 0;
+            nb_mul = 0;
+            gen_call();
+            fprintf(out, "\n");
+        }
+        else fprintf(out, "ECRIRE(v%d)\n", rnd(NB_LOCALS));
+        break;
+    case 5:
+        /* Retour anticipé */
+        if (in_func() && depth > 0 && rnd(3) == 0)
+        {
+            fprintf(out, "RETOURNER (");
+            gen_value();
+            fprintf(out, ") %% 1000\n");
+        }
+        else if (rnd(3) == 0) gen_block();
+        else
+        {
+            fprintf(out, "v%d <- (v%d + 1) %% 1000\n", rnd(NB_LOCALS),
+                    rnd(NB_LOCALS));
+        }
+        break;
+    case 6:
+        if (rnd(2) == 0)
+        {
+            gen_switch(depth);
+            break;
+        }
+        /* fall through */
+    case 7:
+        fprintf(out, "SI ");
+        gen_cond();
+        fprintf(out, " ALORS\n");
+        gen_list(depth + 1, rnd(3) + 1);
+        if (rnd(2) == 0)
+        {
+            indent(depth);
+            fprintf(out, "SINON\n");
+            gen_list(depth + 1, rnd(3) + 1);
+        }
+        indent(depth);
+        fprintf(out, "FSI\n");
+        break;
+    default:
+        gen_loop(depth);
+        break;
+    }
+}
+
+
+static void gen_list(int depth, int nb)
+{
+    int i;
+    for (i = 0; i < nb; i++) gen_instr(depth);
+}
+
+
+/**
+ * @brief Écrit les déclarations des compteurs de boucle l0, l1... utilisés
+ * dans le corps de la fonction.
+ *
+ * @param fp
+ */
+static void gen_loop_decla(FILE *fp)
+{
+    int i;
+    if (nb_loops == 0) return;
+
+    fprintf(fp, "VAR ");
+    for (i = 0; i < nb_loops; i++) fprintf(fp, "%sl%d <- 0", i ? ", " : "", i);
+    fprintf(fp, "\n");
+}
+
+
+/**
+ * @brief Écrit le corps de la fonction courante dans un fichier temporaire,
+ * pour connaître le nombre de compteurs de boucle avant de les déclarer.
+ *
+ * @param nb Nombre d'instructions
+ * @return FILE*
+ */
+static FILE *gen_body(int nb)
+{
+    FILE *fp = out;
+    FILE *body = tmpfile();
+    if (body == NULL)
+    {
+        perror("tmpfile");
+        exit(1);
+    }
+
+    out = body;
+    nb_loops = 0;
+    gen_list(0, nb);
+    out = fp;
+
+    rewind(body);
+    return body;
+}
+
+
+static void copy_body(FILE *body)
+{
+    int c;
+    while ((c = fgetc(body)) != EOF) fputc(c, out);
+    fclose(body);
+}
+
+
+static void gen_function(int k)
+{
+    int i;
+    cur_func = k;
+
+    FILE *body = gen_body(rnd(6) + 2);
+
+    fprintf(out, "ALGO f%d(d, a, b, @tab, @r)\n", k);
+    fprintf(out, "VAR v0 <- a, v1 <- b, v2 <- %d, t[%d] <- [", rnd(100),
+            LOCAL_ARR_SIZE);
+    for (i = 0; i < LOCAL_ARR_SIZE; i++)
+    {
+        fprintf(out, "%s%d", i ? ", " : "", rnd(100));
+    }
+    fprintf(out, "]\n");
+    gen_loop_decla(out);
+    fprintf(out, "DEBUT\n");
+
+    /* Appel récursif à profondeur bornée */
+    if (rnd(3) == 0)
+    {
+        fprintf(out, "    SI d > 0 ALORS\n");
+        fprintf(out, "        v2 <- (v2 + f%d(d - 1, v0 + 1, v1, tab, r)) "\
+                "%% 1000\n", k);
+        fprintf(out, "    FSI\n");
+    }
+
+    copy_body(body);
+
+    fprintf(out, "    RETOURNER (");
+    gen_value();
+    fprintf(out, ") %% 1000\n");
+    fprintf(out, "FIN\n\n");
+}
+
+
+static void gen_program()
+{
+    int i;
+
+    nb_funcs = rnd(MAX_FUNCS + 1);
+
+    fprintf(out, "VAR g0 <- %d, g1 <- %d, g2\n", rnd(100), rnd(100));
+    fprintf(out, "VAR gt[%d] <- [", GLOBAL_ARR_SIZE);
+    for (i = 0; i < GLOBAL_ARR_SIZE; i++)
+    {
+        fprintf(out, "%s%d", i ? ", " : "", rnd(100));
+    }
+    fprintf(out, "]\n");
+    fprintf(out, "VAR gm[%d][%d] <- [", MD_ARR_SIZE, MD_ARR_SIZE);
+    for (i = 0; i < MD_ARR_SIZE * MD_ARR_SIZE; i++)
+    {
+        fprintf(out, "%s%d", i ? ", " : "", rnd(100));
+    }
+    fprintf(out, "]\n\n");
+
+    for (i = 0; i < nb_funcs; i++) gen_function(i);
+
+    cur_func = nb_funcs;
+    FILE *body = gen_body(rnd(10) + 4);
+
+    fprintf(out, "PROGRAMME()\n");
+    fprintf(out, "VAR @p, i, v0 <- %d, v1 <- LIRE(), v2 <- 0\n", rnd(100));
+    gen_loop_decla(out);
+    fprintf(out, "DEBUT\n");
+    fprintf(out, "    g2 <- 0\n");
+    fprintf(out, "    ALLOUER(p, %d)\n", PTR_ARR_SIZE);
+    fprintf(out, "    POUR i DANS 0...%d FAIRE\n", PTR_ARR_SIZE);
+    fprintf(out, "        p[i] <- LIRE()\n");
+    fprintf(out, "    FPOUR\n");
+
+    copy_body(body);
+
+    /* État final */
+    fprintf(out, "    ECRIRE(g0)\n    ECRIRE(g1)\n    ECRIRE(g2)\n");
+    for (i = 0; i < NB_LOCALS; i++) fprintf(out, "    ECRIRE(v%d)\n", i);
+    fprintf(out, "    POUR i DANS 0...%d FAIRE\n", GLOBAL_ARR_SIZE);
+    fprintf(out, "        ECRIRE(gt[i])\n");
+    fprintf(out, "        ECRIRE(p[i])\n");
+    fprintf(out, "    FPOUR\n");
+    fprintf(out, "    POUR i DANS 0...%d FAIRE\n", MD_ARR_SIZE);
+    fprintf(out, "        POUR v0 DANS 0...%d FAIRE\n", MD_ARR_SIZE);
+    fprintf(out, "            ECRIRE(gm[i][v0])\n");
+    fprintf(out, "        FPOUR\n");
+    fprintf(out, "    FPOUR\n");
+    fprintf(out, "FIN\n");
+}
+
+
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "Utilisation: %s graine fichier.algo\n", argv[0]);
+        return 1;
+    }
+
+    seed = strtoul(argv[1], NULL, 10);
+    rnd(1);
+
+    out = fopen(argv[2], "w");
+    if (out == NULL)
+    {
+        perror(argv[2]);
+        return 1;
+    }
+
+    fprintf(out, "/* Programme généré par gen_fuzz (graine %s) */\n\n",
+            argv[1]);
+    gen_program();
+
+    fclose(out);
+    return 0;
+}
@@ -0,0 +1,200 @@
+#!/bin/bash
+#
+# Test différentiel des optimisations: chaque programme est compilé sans
+# optimisation (-O0) puis avec chacune des options de DIFF_FLAGS, et exécuté
+# par le simulateur (voir sim/ramsim.c) sur des bandes d'entrée aléatoires.
+# Les bandes de sortie doivent être identiques.
+#
+# Utilisation: run_diff.sh arc ramsim [gen_fuzz nb]
+#
+# Les programmes testés sont ceux de tests/, les fonctions de libstd/ (chacune
+# appelée depuis un programme généré, avec des paramètres lus sur la bande),
+# puis nb programmes aléatoires générés par gen_fuzz (graines DIFF_SEED,
+# DIFF_SEED + 1...). Chaque programme de tests/ et libstd/ est exécuté sur
+# DIFF_TAPES bandes (3 par défaut).
+#
+# Pour chaque programme, le rapport entre le nombre d'instructions exécutées
+# avec chaque option et sans optimisation est affiché. Un programme qui ne
+# compile pas ou ne s'arrête pas (au bout de DIFF_STEPS instructions) en -O0
+# est ignoré. Les programmes (et bandes) pour lesquels une option change la
+# sortie ou les diagnostics du compilateur (warnings), ou empêche la
+# compilation ou l'exécution, sont copiés dans DIFF_FAILS (diff_echecs par
+# défaut) et le script échoue.
+
+ARC=$1
+SIM=$2
+GEN=$3
+NB_FUZZ=${4:-0}
+
+FLAGS=${DIFF_FLAGS:-"-O1 -O2 -Os --licm --strength-reduction --unroll=4 --cse --dce"}
+TAPES=${DIFF_TAPES:-3}
+STEPS=${DIFF_STEPS:-10000000}
+SEED=${DIFF_SEED:-1}
+FAILS=${DIFF_FAILS:-diff_echecs}
+
+if [ -z "$ARC" ] || [ -z "$SIM" ] || { [ -n "$GEN" ] && [ -z "$4" ]; }; then
+    echo "Utilisation: $0 arc ramsim [gen_fuzz nb]" >&2
+    exit 1
+fi
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+
+nb_ok=0
+nb_skipped=0
+nb_failed=0
+
+
+# Bande d'entrée de graine $1: un entier dans [1, $2] (taille d'un tableau,
+# nombre d'éléments...) puis 5000 entiers dans [0, $3[
+gen_tape() {
+    awk -v x="$1" -v first="$2" -v max="$3" 'BEGIN {
+        for (i = 0; i < 10; i++) x = (x * 16807) % 2147483647
+        print x % first + 1
+        for (i = 0; i < 5000; i++) {
+            x = (x * 16807) % 2147483647
+            print x % max
+        }
+    }'
+}
+
+
+# Programme appelant la fonction $2 de la librairie $1 avec les paramètres
+# $3 lus sur la bande
+gen_lib_test() {
+    echo "\$ INCLURE $(basename "$1")"
+    echo
+    echo "PROGRAMME()"
+    echo "VAR i"
+    echo "DEBUT"
+    echo "    POUR i DANS 0...5 FAIRE"
+    echo "        ECRIRE($2($(echo "$3" | sed 's/[a-z_0-9]\+/LIRE()/g')))"
+    echo "    FPOUR"
+    echo "FIN"
+}
+
+
+# Enregistre l'échec du programme $1 (bande $2): $3
+fail() {
+    echo "ÉCHEC $(basename "$1") $3" >&2
+    mkdir -p "$FAILS"
+    cp "$1" "$2" "$FAILS/" 2> /dev/null
+    nb_failed=$((nb_failed + 1))
+}
+
+
+# Nombre d'instructions exécutées (sortie de ramsim -s)
+nb_steps() {
+    sed -n 's/^Instructions exécutées: \([0-9]*\)/\1/p' "$1"
+}
+
+
+# Teste le programme $1 sur les bandes $DIR/bande_*.txt
+check_program() {
+    local src=$1 name tape ref steps ratios="" failed=""
+    name=$(basename "$src" .algo)
+
+    if ! "$ARC" -O0 -I "$(dirname "$src")" -o "$DIR/ref.ram" "$src" \
+            > /dev/null 2> "$DIR/arc_ref.txt"; then
+        echo "$name: ignoré (ne compile pas)"
+        nb_skipped=$((nb_skipped + 1))
+        return
+    fi
+
+    # Exécutions de référence (les bandes qui font échouer -O0 sont ignorées)
+    local tapes=() ref_steps=0
+    for tape in "$DIR"/bande_*.txt; do
+        if "$SIM" -s -l "$STEPS" "$DIR/ref.ram" "$tape" \
+                > "$tape.ref" 2> "$DIR/stats.txt"; then
+            tapes+=("$tape")
+            ref_steps=$((ref_steps + $(nb_steps "$DIR/stats.txt")))
+        fi
+    done
+
+    if [ ${#tapes[@]} -eq 0 ]; then
+        echo "$name: ignoré (erreur à l'exécution en -O0)"
+        nb_skipped=$((nb_skipped + 1))
+        return
+    fi
+
+    for flag in $FLAGS; do
+        if ! "$ARC" $flag -I "$(dirname "$src")" -o "$DIR/opt.ram" "$src" \
+                > /dev/null 2> "$DIR/arc.txt"; then
+            fail "$src" "" "($flag): erreur de compilation"
+            failed=1
+            continue
+        fi
+        if ! cmp -s "$DIR/arc_ref.txt" "$DIR/arc.txt"; then
+            fail "$src" "" "($flag): les diagnostics ont changé"
+            failed=1
+            continue
+        fi
+
+        steps=0
+        for tape in "${tapes[@]}"; do
+            if ! "$SIM" -s -l "$STEPS" "$DIR/opt.ram" "$tape" \
+                    > "$DIR/sortie.txt" 2> "$DIR/stats.txt"; then
+                fail "$src" "$tape" "($flag, $(basename "$tape")):"\
+" $(grep -m1 erreur "$DIR/stats.txt")"
+                failed=1
+                continue 2
+            fi
+            if ! cmp -s "$tape.ref" "$DIR/sortie.txt"; then
+                fail "$src" "$tape" "($flag, $(basename "$tape")):"\
+" la bande de sortie a changé"
+                failed=1
+                continue 2
+            fi
+            steps=$((steps + $(nb_steps "$DIR/stats.txt")))
+        done
+
+        ratios="$ratios $flag $(awk "BEGIN {printf \"%.2f\", \
+$steps / $ref_steps}")"
+    done
+
+    [ -z "$failed" ] && nb_ok=$((nb_ok + 1))
+    echo "$name:$ratios"
+}
+
+
+# Programmes de tests/ et fonctions de libstd/
+for ((k = 0; k < TAPES; k++)); do
+    gen_tape $((SEED + k)) 20 100 > "$DIR/bande_$k.txt"
+done
+
+for src in "$ROOT"/tests/*.algo; do
+    check_program "$src"
+done
+
+for ((k = 0; k < TAPES; k++)); do
+    gen_tape $((SEED + k)) 9 9 | sed 's/^0$/1/' > "$DIR/bande_$k.txt"
+done
+
+# Une fonction par programme (sauf celles qui prennent des pointeurs)
+mkdir -p "$DIR/lib"
+for lib in "$ROOT"/libstd/*.algo; do
+    cp "$lib" "$DIR/lib/"
+    sed -n 's/^ALGO \([a-z_0-9]*\)(\([^@]*\)).*/\1 \2/p' "$lib" |
+    while read -r func params; do
+        gen_lib_test "$lib" "$func" "$params" > "$DIR/lib/$func.algo"
+        echo "$func"
+    done > "$DIR/lib/liste.txt"
+
+    while read -r func; do
+        check_program "$DIR/lib/$func.algo"
+    done < "$DIR/lib/liste.txt"
+done
+
+# Programmes aléatoires (une bande chacun)
+rm -f "$DIR"/bande_*
+for ((k = 0; k < NB_FUZZ; k++)); do
+    src="$DIR/fuzz_$((SEED + k)).algo"
+    "$GEN" $((SEED + k)) "$src" || exit 1
+    gen_tape $((SEED + k)) 20 100 > "$DIR/bande_fuzz_$((SEED + k)).txt"
+    check_program "$src"
+    rm "$DIR/bande_fuzz_$((SEED + k)).txt"*
+done
+
+echo "$nb_ok programmes corrects, $nb_skipped ignorés, $nb_failed échecs"
+[ "$nb_failed" -eq 0 ]